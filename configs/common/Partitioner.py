@@ -0,0 +1,174 @@
+# -*- coding: utf-8 -*-
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+"""Split a configuration over several event queues.
+
+Every partition root given to partition() gets its own event queue,
+shared with all its descendants, and each port connection that ends
+up crossing two queues is cut with a MailboxBridge. The bridges only
+exchange packets at the quantum barriers, so the simulation quantum
+must not be longer than the shortest link latency, which is what
+partition() returns.
+
+Cutting a link changes timing: the bridge delays every packet in
+each direction on top of what the rest of the system already models.
+By default a link cut at a crossbar gets the latency a request spends
+in that crossbar (frontend plus forward latency), so a crossing costs
+about twice the crossbar latency. Links to other objects, such as the
+port a core starts an accelerator with, get the shortest of those.
+
+The bridges do not forward snoops, so the partition roots should be
+objects that reach the rest of the system through non-coherent ports
+(e.g., accelerators). Cores with caches stay in the partition of the
+coherent crossbar they are attached to. Accelerators that translate
+addresses with the MMU of a core post the translation to the queue of
+that core (see rtlObject::startTranslate).
+"""
+
+import m5
+from m5.objects import BaseXBar, DerivedClockDomain, MailboxBridge
+from m5.params import PortRef, VectorPortRef
+from m5.proxy import isproxy
+
+def eventq_of(obj):
+    """Event queue an object runs on once its proxies are resolved"""
+
+    while obj is not None:
+        if not isproxy(obj.eventq_index):
+            return obj.eventq_index
+        obj = obj.get_parent()
+
+    return 0
+
+def _clock_period(obj):
+    """Clock period in ticks of an object once its proxies are resolved"""
+
+    while isproxy(obj.clk_domain):
+        obj = obj.get_parent()
+    domain = obj.clk_domain
+    divider = 1
+    while isinstance(domain, DerivedClockDomain):
+        divider *= int(domain.clk_divider)
+        domain = domain.clk_domain
+    return domain.clock[0].getValue() * divider
+
+def _xbar_latency(xbar):
+    """Ticks a request spends in a crossbar before it is forwarded"""
+
+    cycles = int(xbar.frontend_latency) + int(xbar.forward_latency)
+    return max(cycles, 1) * _clock_period(xbar)
+
+def _port_refs(obj):
+    for ref in list(obj._port_refs.values()):
+        if isinstance(ref, VectorPortRef):
+            for el in ref.elements:
+                yield el
+        else:
+            yield ref
+
+def _connected(ref):
+    return isinstance(ref, PortRef) and isinstance(ref.peer, PortRef) and \
+        not isproxy(ref.peer)
+
+def partition(root, partitions, link_latency=None, max_queues=0,
+              port_eventq=None):
+    """Give each object in partitions its own event queue and add
+    bridges where the port connections cross queues.
+
+    link_latency is the delay of every bridge, None to derive it from
+    the crossbars being cut (see above).
+
+    Queues are allocated after the ones already in use (e.g., by KVM
+    CPUs). With max_queues the partitions are spread round robin over
+    at most that many new queues. port_eventq maps objects whose ports
+    are driven from another queue than their own, such as KVM CPUs
+    that migrate to the VM queue to talk to devices, to that queue.
+
+    Returns the shortest link latency in ticks, or None if no bridge
+    was needed.
+    """
+
+    used = [ eventq_of(obj) for obj in root.descendants() ]
+    first_eq = max(used + [ 0 ]) + 1
+
+    for i, part in enumerate(partitions):
+        eq = first_eq + (i % max_queues if max_queues else i)
+        for obj in part.descendants():
+            obj.eventq_index = eq
+
+    if port_eventq is None:
+        port_eventq = {}
+
+    def sender_eventq(obj):
+        return port_eventq.get(obj, eventq_of(obj))
+
+    cuts = []
+    for part in partitions:
+        for obj in list(part.descendants()):
+            for ref in _port_refs(obj):
+                if not _connected(ref) or isinstance(obj, MailboxBridge):
+                    continue
+
+                peer = ref.peer
+                local_eq = sender_eventq(obj)
+                peer_eq = sender_eventq(peer.simobj)
+                if local_eq == peer_eq:
+                    continue
+
+                if ref.role == 'GEM5 REQUESTOR':
+                    cuts.append((obj, ref, local_eq, peer_eq))
+                else:
+                    cuts.append((obj, ref, peer_eq, local_eq))
+
+    if link_latency is not None:
+        fixed = m5.ticks.fromSeconds(
+            m5.util.convert.anyToLatency(link_latency))
+        delays = [ fixed for cut in cuts ]
+    else:
+        delays = [ _xbar_latency(ref.peer.simobj)
+                   if isinstance(ref.peer.simobj, BaseXBar) else None
+                   for obj, ref, cpu_eq, mem_eq in cuts ]
+        known = [ d for d in delays if d is not None ]
+        if known:
+            other = min(known)
+        elif cuts:
+            other = min(_clock_period(ref.peer.simobj)
+                        for obj, ref, cpu_eq, mem_eq in cuts)
+        delays = [ other if d is None else d for d in delays ]
+
+    for (obj, ref, cpu_eq, mem_eq), delay in zip(cuts, delays):
+        bridge = MailboxBridge(delay="%dt" % delay,
+                               eventq_index=cpu_eq,
+                               mem_side_eventq_index=mem_eq)
+        name = "%s_bridge" % ref.name
+        if ref.index >= 0:
+            name += str(ref.index)
+        setattr(obj, name, bridge)
+        ref.splice(bridge.cpu_side_port, bridge.mem_side_port)
+
+    return min(delays) if delays else None
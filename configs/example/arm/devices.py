@@ -106,7 +106,8 @@ class MemBus(SystemXBar):
 
 class CpuCluster(SubSystem):
     def __init__(self, system,  num_cpus, cpu_clock, cpu_voltage,
-                 cpu_type, l1i_type, l1d_type, wcache_type, l2_type):
+                 cpu_type, l1i_type, l1d_type, wcache_type, l2_type,
+                 switch_from=None):
         super(CpuCluster, self).__init__()
         self._cpu_type = cpu_type
         self._l1i_type = l1i_type
@@ -120,6 +121,20 @@ class CpuCluster(SubSystem):
         self.clk_domain = SrcClockDomain(clock=cpu_clock,
                                          voltage_domain=self.voltage_domain)
 
+        # A cluster switched in later on takes over the CPU ids, ports
+        # and accelerators of the one it replaces, it is not a cluster
+        # of the system on its own
+        if switch_from is not None:
+            assert len(switch_from.cpus) == num_cpus
+            self.cpus = [ self._cpu_type(cpu_id=cpu.cpu_id,
+                                         socket_id=cpu.socket_id,
+                                         clk_domain=self.clk_domain,
+                                         switched_out=True)
+                          for cpu in switch_from.cpus ]
+            for cpu in self.cpus:
+                cpu.createThreads()
+            return
+
         self.cpus = [ self._cpu_type(cpu_id=system.numCpus() + idx,
                                      clk_domain=self.clk_domain)
                       for idx in range(num_cpus) ]
@@ -136,6 +151,18 @@ class CpuCluster(SubSystem):
     def memoryMode(self):
         return self._cpu_type.memory_mode()
 
+    def useCachesOf(self, cluster):
+        """
+        Build the cache hierarchy of another cluster around the CPUs of
+        this one. Used when fast-forwarding, the caches are connected to
+        the CPUs we boot with and are handed over to the detailed ones
+        when switching.
+        """
+        self._l1i_type = cluster._l1i_type
+        self._l1d_type = cluster._l1d_type
+        self._wcache_type = cluster._wcache_type
+        self._l2_type = cluster._l2_type
+
     def addL1(self):
         for cpu in self.cpus:
             l1i = None if self._l1i_type is None else self._l1i_type()
@@ -151,9 +178,9 @@ class CpuCluster(SubSystem):
         self.l2 = self._l2_type()
         for cpu in self.cpus:
             cpu.connectAllPorts(self.toL2Bus)
-            for i in range(4):
+            for accel in cpu.accels:
                 # mem_side is for loading NVDLA traces, not for runtime memory accesses
-                exec("cpu.accel_%d.mem_side = self.toL2Bus.cpu_side_ports" % i)
+                accel.mem_side = self.toL2Bus.cpu_side_ports
 
         self.toL2Bus.mem_side_ports = self.l2.cpu_side
 
@@ -163,24 +190,70 @@ class CpuCluster(SubSystem):
             #CpuConfig.print_cpu_list()
 
             cpu.num_accels = options.numNVDLA
-
-            sft_pft_ctrl_str = "prefetch_enable=1" if options.sft_pft_enable else "prefetch_enable=0"
+            cpu.accel_wait_quiesce = options.accel_wait_quiesce
+
+            # parameters shared by every accelerator of the cluster
+            accel_params = {}
+            if options.sft_pft_stream:
+                accel_params.update(
+                    prefetch_enable=2,
+                    stream_pft_entries=options.sft_pft_stream_entries,
+                    stream_pft_degree=options.sft_pft_stream_degree,
+                    stream_pft_distance=options.sft_pft_stream_distance,
+                    stream_pft_confidence=options.sft_pft_stream_confidence)
+            elif options.sft_pft_enable:
+                accel_params["prefetch_enable"] = 1
+            else:
+                accel_params["prefetch_enable"] = 0
+            if options.skip_idle:
+                accel_params["skip_idle"] = True
+            if options.parallel_nvdla:
+                accel_params["parallel_eval"] = True
+            if options.backdoor_trace_load:
+                accel_params["backdoor_trace_load"] = True
+            accel_params["trace_ingest"] = options.trace_ingest
+
+            # bit i for the address class 0x8 + i
+            spm_classes = ['ro', 'wo', 'rw']
+            spm_write_allocate = 0
+            for c in filter(None, options.spm_write_allocate.split(',')):
+                spm_write_allocate |= 1 << spm_classes.index(c)
 
             # in the current phase, we only use one NVDLA accelerator, and spm cannot be used with caches
             if options.dma_enable:
                 assert not options.add_accel_private_cache and not options.add_accel_shared_cache
-                dma_ctrl_str = "dma_enable=1, dma_try_get_fraction=1, spm_latency=options.spm_lat, spm_line_size=1024"
+                accel_params.update(
+                    dma_enable=1, dma_try_get_fraction=1,
+                    dma_channels=options.dma_channels,
+                    spm_latency=options.spm_lat, spm_line_size=1024,
+                    spm_line_num=options.spm_line_num,
+                    spm_assoc=options.spm_assoc,
+                    spm_repl_policy=['lru', 'fifo', 'random'].index(options.spm_repl),
+                    spm_write_allocate=spm_write_allocate,
+                    spm_eager_writeback=not options.spm_lazy_writeback)
             else:
-                dma_ctrl_str = "dma_enable=0"
-
-            for i in range(4):
-                exec("cpu.accel_%d = rtlNVDLA(%s, %s)" % (i, dma_ctrl_str, sft_pft_ctrl_str))
-
-            for i in range(4):
-                exec("cpu.accel_port_%d = cpu.accel_%d.cpu_side" % (i, i))
-                # e.g. cpu.accel_port_0 = cpu.accel_0.cpu_side
+                accel_params["dma_enable"] = 0
+
+            # at least the four accelerators the old fixed ports provided
+            num_accels = max(options.numNVDLA, 4)
+            model = tlmNVDLA if options.nvdla_tlm else rtlNVDLA
+            cpu.accels = [model(**accel_params) for i in range(num_accels)]
+
+            if options.accel_job_queue:
+                # jobs are started by the command processor, which the
+                # guest reaches through its registers
+                cpu.accel_job_queue = AccelJobQueue(
+                    pio_addr=options.accel_job_queue_addr + 0x10000 * cpu.cpu_id,
+                    ring_size=options.accel_job_queue_size,
+                    work_stealing=not options.no_work_stealing)
+                for accel in cpu.accels:
+                    cpu.accel_job_queue.accel_ports = accel.cpu_side
+                cpu.num_accels = 0
+            else:
+                for accel in cpu.accels:
+                    cpu.accel_ports = accel.cpu_side
 
-            outside_ports = ["cpu.accel_%d.dram_port" % i for i in range(4)]
+            outside_ports = ["cpu.accels[%d].dram_port" % i for i in range(num_accels)]
 
             if options.add_accel_private_cache:
                 for i in range(options.numNVDLA):
@@ -219,32 +292,49 @@ class CpuCluster(SubSystem):
             for port in outside_ports:
                 exec("%s = membus" % port)
 
-            for i in range(4):
+            for i, accel in enumerate(cpu.accels):
                 # still keep dma_port for cached config to avoid disconnection errors
-                exec("cpu.accel_%d.dma_port = membus" % i)
+                accel.dma_port = membus
 
                 # max num inflight requests
-                exec("cpu.accel_%d.maxReq = options.maxReqNVDLA" % i)
+                accel.maxReq = options.maxReqNVDLA
 
                 # enable Tracing
-                exec("cpu.accel_%d.enableWaveform = options.enableWaveform" % i)
+                accel.enableWaveform = options.enableWaveform
+                accel.waveform_format = options.waveform_format
+                accel.waveform_start = options.waveform_start
+                accel.waveform_cycles = options.waveform_cycles
+                accel.waveform_trigger = options.waveform_trigger
 
                 # enable Timing
-                exec("cpu.accel_%d.enableTimingAXI = options.enableTimingAXI" % i)
+                accel.enableTimingAXI = options.enableTimingAXI
+
+                # write the checked output tensors to disk
+                accel.dump_mem = options.nvdla_dump_mem
+
+                # per layer breakdown of the NVDLA time
+                accel.layer_stats = options.nvdla_layer_stats
+                accel.bw_window = options.nvdla_bw_window
+
+                # packet trace of the AXI traffic
+                accel.record_axi = options.nvdla_record_axi
 
                 # ids
-                exec("cpu.accel_%d.id_nvdla = %d" % (i, i))
-
-            # DRAM base addr
-            cpu.accel_0.base_addr_dram = 0xA0000000
-            cpu.accel_1.base_addr_dram = 0xA0000000
-            cpu.accel_2.base_addr_dram = 0xA0000000
-            cpu.accel_3.base_addr_dram = 0xA0000000
-            # SRAM base addr
-            cpu.accel_0.base_addr_sram = 0xA5000000
-            cpu.accel_1.base_addr_sram = 0xB5000000
-            cpu.accel_2.base_addr_sram = 0xC5000000
-            cpu.accel_3.base_addr_sram = 0xD5000000
+                accel.id_nvdla = i
+
+                # DRAM base addr
+                accel.base_addr_dram = 0xA0000000
+                # SRAM base addr, 0xA5000000 for accel 0
+                accel.base_addr_sram = 0xA5000000 + i * options.accel_sram_stride
+
+                if options.nvdla_tlm:
+                    accel.sample_layers = options.tlm_sample_layers
+                    accel.sample_cycles = options.tlm_sample_cycles
+                    accel.rtl_uncalibrated = not options.tlm_no_rtl_uncalibrated
+                    accel.calibration_in = options.tlm_calibration_in
+                    if options.tlm_calibration_out:
+                        accel.calibration_out = "%s.%d.%d" % (
+                            options.tlm_calibration_out, cpu.cpu_id, i)
 
     def addPMUs(self, ints, events=[]):
         """
@@ -281,22 +371,29 @@ class CpuCluster(SubSystem):
 
 
 class AtomicCluster(CpuCluster):
-    def __init__(self, system, num_cpus, cpu_clock, cpu_voltage="1.0V"):
+    def __init__(self, system, num_cpus, cpu_clock, cpu_voltage="1.0V",
+                 **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("AtomicSimpleCPU"), None,
                        None, None, None ]
         super(AtomicCluster, self).__init__(system, num_cpus, cpu_clock,
-                                            cpu_voltage, *cpu_config)
+                                            cpu_voltage, *cpu_config,
+                                            **kwargs)
     def addL1(self):
-        pass
+        # only the caches of the cluster we switch to, if any
+        if self._l1i_type is not None:
+            super(AtomicCluster, self).addL1()
 
 class KvmCluster(CpuCluster):
-    def __init__(self, system, num_cpus, cpu_clock, cpu_voltage="1.0V"):
+    def __init__(self, system, num_cpus, cpu_clock, cpu_voltage="1.0V",
+                 **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("ArmV8KvmCPU"), None, None,
             None, None ]
         super(KvmCluster, self).__init__(system, num_cpus, cpu_clock,
-                                         cpu_voltage, *cpu_config)
+                                         cpu_voltage, *cpu_config, **kwargs)
     def addL1(self):
-        pass
+        # only the caches of the cluster we switch to, if any
+        if self._l1i_type is not None:
+            super(KvmCluster, self).addL1()
 
 class FastmodelCluster(SubSystem):
     def __init__(self, system,  num_cpus, cpu_clock, cpu_voltage="1.0V"):
@@ -506,6 +603,9 @@ class SimpleSystem(BaseSimpleSystem):
                 cluster.addPrivateAccelerator(cluster.clk_domain,
                                               self.membus.cpu_side_ports,
                                               options)
+                if options.accel_job_queue:
+                    for cpu in cluster.cpus:
+                        cpu.accel_job_queue.pio = self.membus.mem_side_ports
 
     def attach_pci(self, dev):
         self.realview.attachPciDevice(dev, self.iobus)
@@ -49,6 +49,7 @@ from common import FSConfig
 from common import SysPaths
 from common import ObjectList
 from common import Options
+from common import Partitioner
 from common.cores.arm import ex5_LITTLE
 
 import devices
@@ -79,36 +80,36 @@ def _using_pdes(root):
 
 class BigCluster(devices.CpuCluster):
     def __init__(self, system, num_cpus, cpu_clock,
-                 cpu_voltage="1.0V"):
+                 cpu_voltage="1.0V", **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("O3_ARM_v7a_3"),
             devices.L1I, devices.L1D, devices.WalkCache, devices.L2 ]
         super(BigCluster, self).__init__(system, num_cpus, cpu_clock,
-                                         cpu_voltage, *cpu_config)
+                                         cpu_voltage, *cpu_config, **kwargs)
 
 class LittleCluster(devices.CpuCluster):
     def __init__(self, system, num_cpus, cpu_clock,
-                 cpu_voltage="1.0V"):
+                 cpu_voltage="1.0V", **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("MinorCPU"), devices.L1I,
             devices.L1D, devices.WalkCache, devices.L2 ]
         super(LittleCluster, self).__init__(system, num_cpus, cpu_clock,
-                                         cpu_voltage, *cpu_config)
+                                         cpu_voltage, *cpu_config, **kwargs)
 
 class Ex5BigCluster(devices.CpuCluster):
     def __init__(self, system, num_cpus, cpu_clock,
-                 cpu_voltage="1.0V"):
+                 cpu_voltage="1.0V", **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("ex5_big"), ex5_big.L1I,
             ex5_big.L1D, ex5_big.WalkCache, ex5_big.L2 ]
         super(Ex5BigCluster, self).__init__(system, num_cpus, cpu_clock,
-                                         cpu_voltage, *cpu_config)
+                                         cpu_voltage, *cpu_config, **kwargs)
 
 class Ex5LittleCluster(devices.CpuCluster):
     def __init__(self, system, num_cpus, cpu_clock,
-                 cpu_voltage="1.0V"):
+                 cpu_voltage="1.0V", **kwargs):
         cpu_config = [ ObjectList.cpu_list.get("ex5_LITTLE"),
             ex5_LITTLE.L1I, ex5_LITTLE.L1D, ex5_LITTLE.WalkCache,
             ex5_LITTLE.L2 ]
         super(Ex5LittleCluster, self).__init__(system, num_cpus, cpu_clock,
-                                         cpu_voltage, *cpu_config)
+                                         cpu_voltage, *cpu_config, **kwargs)
 
 def createSystem(caches, kernel, accelerators, ddr_type, bootscript,
                  machine_type="VExpress_GEM5",disks=[],
@@ -179,6 +180,11 @@ def addOptions(parser):
     parser.add_argument("--cpu-type", type=str, choices=list(cpu_types.keys()),
                         default="timing",
                         help="CPU simulation mode. Default: %(default)s")
+    parser.add_argument("--switch-cpu-type", type=str, default=None,
+                        choices=[t for t in cpu_types if t != "fastmodel"],
+                        help="CPU model switched in when the guest runs "
+                        "'m5 switchcpu', e.g. boot with --cpu-type=kvm "
+                        "and run the inference on detailed cores")
     parser.add_argument("--kernel-init", type=str, default="/sbin/init",
                         help="Override init")
     parser.add_argument("--big-cpus", type=int, default=1,
@@ -196,6 +202,22 @@ def addOptions(parser):
     parser.add_argument("--sim-quantum", type=str, default="1ms",
                         help="Simulation quantum for parallel simulation. " \
                         "Default: %(default)s")
+    # options.pdes_accels
+    parser.add_argument("--pdes-accels", action="store_true", default=False,
+                        help="Simulate each NVDLA on its own event queue "
+                        "and thread, the quantum is lowered to the link "
+                        "latency")
+    # options.pdes_link_latency
+    parser.add_argument("--pdes-link-latency", type=str, default=None,
+                        help="Latency of the links cut between event "
+                        "queues. By default the latency of the crossbar "
+                        "each link is cut at, which the link adds on top "
+                        "of the crossbar's own, so results differ from a "
+                        "single queue run")
+    # options.pdes_max_queues
+    parser.add_argument("--pdes-max-queues", type=int, default=0,
+                        help="Spread the NVDLAs over at most this many "
+                        "event queues, 0 for one each")
     parser.add_argument("--mem-size", type=str, default=default_mem_size,
                         help="System memory size")
     parser.add_argument("--kernel-cmd", type=str, default=None,
@@ -213,6 +235,16 @@ def addOptions(parser):
     # options.enableWaveform
     parser.add_argument("--enableWaveform", action="store_true", default=False,
                         help="Enable tracing waveform of NVDLA")
+    parser.add_argument("--waveform-format", type=str, default="vcd",
+                        choices=["vcd", "fst"],
+                        help="NVDLA waveform format, one nvdla<id> file per instance")
+    parser.add_argument("--waveform-start", type=int, default=0,
+                        help="First NVDLA cycle in the waveform")
+    parser.add_argument("--waveform-cycles", type=int, default=0,
+                        help="NVDLA cycles in the waveform, 0 for no limit")
+    parser.add_argument("--waveform-trigger", type=lambda x: int(x, 0),
+                        default=0,
+                        help="CSB register whose first write starts the waveform window")
     # options.enableTiming
     parser.add_argument("--enableTimingAXI", action="store_true",
                         default=False,
@@ -224,6 +256,43 @@ def addOptions(parser):
 
     # options.numNVDLA
     parser.add_argument("--numNVDLA", type=int, default=1, help="number of NVDLAs")
+    # options.accel_wait_quiesce
+    parser.add_argument("--accel-wait-quiesce", action="store_true", default=False, help="Suspend threads waiting on a busy NVDLA instead of polling")
+    # options.accel_job_queue
+    parser.add_argument("--accel-job-queue", action="store_true", default=False, help="Start NVDLA jobs from a memory-mapped job queue instead of the CPU accelerator ports")
+    # options.accel_job_queue_addr
+    parser.add_argument("--accel-job-queue-addr", type=lambda x: int(x, 0), default=0x10100000, help="address of the job queue of the first CPU, the one of CPU n is n * 64KiB above")
+    # options.accel_job_queue_size
+    parser.add_argument("--accel-job-queue-size", type=int, default=64, help="slots in the job submission and completion rings")
+    # options.no_work_stealing
+    parser.add_argument("--no-work-stealing", action="store_true", default=False, help="Run each job on the NVDLA it was queued on")
+    # options.accel_sram_stride
+    parser.add_argument("--accel-sram-stride", type=lambda x: int(x, 0), default=0x10000000, help="distance between the SRAM base addresses of consecutive NVDLAs")
+
+    # options.nvdla_tlm
+    parser.add_argument("--nvdla-tlm", action="store_true", default=False, help="Use the transaction-level NVDLA, running on the RTL only the sampled layers")
+    # options.tlm_sample_layers
+    parser.add_argument("--tlm-sample-layers", type=int, default=0, help="Run one layer in every N on the RTL, 0 to disable")
+    # options.tlm_sample_cycles
+    parser.add_argument("--tlm-sample-cycles", type=int, default=0, help="Run the next layer on the RTL after N TLM cycles, 0 to disable")
+    # options.tlm_no_rtl_uncalibrated
+    parser.add_argument("--tlm-no-rtl-uncalibrated", action="store_true", default=False, help="Run the layers with no recorded traffic on the TLM too")
+    # options.tlm_calibration_in
+    parser.add_argument("--tlm-calibration-in", type=str, default="", help="Layer traffic recorded by a previous run")
+    # options.tlm_calibration_out
+    parser.add_argument("--tlm-calibration-out", type=str, default="", help="Write the recorded layer traffic to this file in the output directory, suffixed with the CPU and NVDLA ids")
+
+    # options.nvdla_dump_mem
+    parser.add_argument("--nvdla-dump-mem", action="store_true", default=False, help="Also write the NVDLA output tensors checked by the trace to disk")
+
+    # options.nvdla_layer_stats
+    parser.add_argument("--nvdla-layer-stats", action="store_true", default=False, help="Dump the stats at every NVDLA layer boundary, without resetting them")
+
+    # options.nvdla_bw_window
+    parser.add_argument("--nvdla-bw-window", type=int, default=1000, help="NVDLA cycles in each sample of the per-port bandwidth histograms, 0 to disable them")
+
+    # options.nvdla_record_axi
+    parser.add_argument("--nvdla-record-axi", action="store_true", default=False, help="Record the NVDLA AXI requests as packet traces in the output directory, see configs/example/nvdla_replay.py")
 
     # options.dma_enable
     parser.add_argument("--dma-enable", action="store_true", default=False, help="Use scratchpad in NVDLA aided with DMA")
@@ -231,6 +300,36 @@ def addOptions(parser):
     # options.spm_lat
     parser.add_argument("--spm-lat", type=int, default=12, help="NVDLA private scratchpad memory latency")
 
+    # options.skip_idle
+    parser.add_argument("--skip-idle", action="store_true", default=False, help="Stop ticking NVDLA while it only waits for memory")
+
+    # options.parallel_nvdla
+    parser.add_argument("--parallel-nvdla", action="store_true", default=False, help="Evaluate each NVDLA on a host thread of its own")
+
+    # options.backdoor_trace_load
+    parser.add_argument("--backdoor-trace-load", action="store_true", default=False, help="Load the NVDLA trace data straight into physical memory")
+
+    # options.trace_ingest
+    parser.add_argument("--trace-ingest", type=str, default="timing", choices=["timing", "functional", "backdoor"], help="How NVDLA reads its trace from the guest")
+
+    # options.dma_channels
+    parser.add_argument("--dma-channels", type=int, default=8, help="Number of concurrent NVDLA DMA transfers")
+
+    # options.spm_line_num
+    parser.add_argument("--spm-line-num", type=int, default=64, help="NVDLA scratchpad capacity in 1KB lines (65536 for 64MB)")
+
+    # options.spm_assoc
+    parser.add_argument("--spm-assoc", type=int, default=8, help="NVDLA scratchpad associativity, 0 for fully associative")
+
+    # options.spm_repl
+    parser.add_argument("--spm-repl", type=str, default="lru", choices=["lru", "fifo", "random"], help="NVDLA scratchpad replacement policy")
+
+    # options.spm_write_allocate
+    parser.add_argument("--spm-write-allocate", type=str, default="ro,wo,rw", help="Comma separated address classes in which a scratchpad write miss allocates the line: ro (0x8), wo (0x9), rw (0xa); the others write around it")
+
+    # options.spm_lazy_writeback
+    parser.add_argument("--spm-lazy-writeback", action="store_true", default=False, help="Only write scratchpad lines back on eviction or at the end of the trace")
+
 
 
     # options.add_accel_private_cache
@@ -270,6 +369,12 @@ def addOptions(parser):
 
     # options.sft_pft_enable
     parser.add_argument("--sft-pft-enable", action="store_true", default=False, help="issue software prefetching when inflight request queue is underrun")
+    # options.sft_pft_stream
+    parser.add_argument("--sft-pft-stream", action="store_true", default=False, help="software prefetching of the streams learnt from the NVDLA reads, no compiler log needed")
+    parser.add_argument("--sft-pft-stream-entries", type=int, default=16, help="streams tracked at once by the stream prefetcher")
+    parser.add_argument("--sft-pft-stream-degree", type=int, default=4, help="strides the stream prefetcher runs ahead of the demand reads")
+    parser.add_argument("--sft-pft-stream-distance", type=int, default=64, help="largest distance in blocks between two reads of one stream")
+    parser.add_argument("--sft-pft-stream-confidence", type=int, default=2, help="stride repeats before a stream is prefetched")
 
     parser.add_argument("--prefetcher", type=str, default=None, help="Hardware prefetcher class name prefix")
 
@@ -348,6 +453,25 @@ def build(options):
        system.bigCluster.memoryMode() != system.littleCluster.memoryMode():
         m5.util.panic("Memory mode missmatch among CPU clusters")
 
+    # CPUs switched in by 'm5 switchcpu', the caches are the ones of the
+    # CPUs switched in
+    system._switch_cpus = []
+    if options.switch_cpu_type:
+        switch_big, switch_little = cpu_types[options.switch_cpu_type]
+        if options.big_cpus > 0:
+            system.bigSwitchCluster = switch_big(system, options.big_cpus,
+                options.big_cpu_clock, switch_from=system.bigCluster)
+            system.bigCluster.useCachesOf(system.bigSwitchCluster)
+            system._switch_cpus += list(zip(system.bigCluster.cpus,
+                                            system.bigSwitchCluster.cpus))
+        if options.little_cpus > 0:
+            system.littleSwitchCluster = switch_little(system,
+                options.little_cpus, options.little_cpu_clock,
+                switch_from=system.littleCluster)
+            system.littleCluster.useCachesOf(system.littleSwitchCluster)
+            system._switch_cpus += list(zip(system.littleCluster.cpus,
+                                            system.littleSwitchCluster.cpus))
+
 
     # TODO: Maybe add the option to be global or shared
     if options.accelerators:
@@ -360,11 +484,32 @@ def build(options):
             m5.util.panic("Big CPU model requires caches")
         if options.little_cpus > 0 and system.littleCluster.requireCaches():
             m5.util.panic("Little CPU model requires caches")
+        for old_cpu, new_cpu in system._switch_cpus:
+            if new_cpu.require_caches():
+                m5.util.panic("Switch CPU model requires caches")
 
     # Create a KVM VM and do KVM-specific configuration
     if issubclass(big_model, KvmCluster):
         _build_kvm(options, system, all_cpus)
 
+    # Give the NVDLAs their own threads. The CPUs stay where they are,
+    # their caches can't be split from the coherent crossbars.
+    root._link_quantum = None
+    if options.pdes_accels and options.accelerators:
+        # the backdoor touches the memory from the NVDLA thread
+        if options.trace_ingest == "backdoor" or options.backdoor_trace_load:
+            m5.util.fatal("--pdes-accels can't be used with "
+                          "--trace-ingest=backdoor or --backdoor-trace-load")
+        accels = [ accel for cpu in all_cpus
+                   for accel in cpu.accels[:options.numNVDLA] ]
+        # KVM CPUs talk to their devices from the VM queue
+        port_eventq = {}
+        if issubclass(big_model, KvmCluster):
+            port_eventq = { cpu : system.kvm_vm.eventq_index
+                            for cpu in all_cpus }
+        root._link_quantum = Partitioner.partition(root, accels,
+            options.pdes_link_latency, options.pdes_max_queues, port_eventq)
+
     # Linux device tree
     if options.dtb is not None:
         system.workload.dtb_filename = SysPaths.binary(options.dtb)
@@ -420,9 +565,14 @@ def instantiate(options, checkpoint_dir=None):
     # (e.g., when using KVM)
     root = Root.getInstance()
     if root and _using_pdes(root):
-        m5.util.inform("Running in PDES mode with a %s simulation quantum.",
-                       options.sim_quantum)
-        root.sim_quantum = _to_ticks(options.sim_quantum)
+        quantum = _to_ticks(options.sim_quantum)
+        # the links between queues must be at least a quantum long
+        link_quantum = getattr(root, "_link_quantum", None)
+        if link_quantum is not None and link_quantum < quantum:
+            quantum = link_quantum
+        m5.util.inform("Running in PDES mode with a %d ticks simulation "
+                       "quantum.", quantum)
+        root.sim_quantum = quantum
 
     # Get and load from the chkpt or simpoint checkpoint
     if options.restore_from:
@@ -437,7 +587,7 @@ def instantiate(options, checkpoint_dir=None):
         m5.instantiate()
 
 
-def run(checkpoint_dir=m5.options.outdir):
+def run(checkpoint_dir=m5.options.outdir, switch_cpus=[]):
     # start simulation (and drop checkpoints when requested)
     while True:
         event = m5.simulate()
@@ -447,6 +597,11 @@ def run(checkpoint_dir=m5.options.outdir):
             cpt_dir = os.path.join(checkpoint_dir, "cpt.%d" % m5.curTick())
             m5.checkpoint(cpt_dir)
             print("Checkpoint done.")
+        elif exit_msg == "switchcpu" and switch_cpus:
+            # accelerator jobs in flight complete on the new CPUs
+            print("Switching CPUs at tick %d" % m5.curTick())
+            m5.switchCpus(Root.getInstance().system, switch_cpus)
+            switch_cpus = [ (new, old) for old, new in switch_cpus ]
         else:
             print(exit_msg, " @ ", m5.curTick())
             break
@@ -469,7 +624,7 @@ def main():
     if options.dtb_gen:
       generateDtb(root)
     else:
-      run()
+      run(switch_cpus=root.system._switch_cpus)
 
 
 if __name__ == "__m5_main__":
@@ -0,0 +1,116 @@
+# -*- coding: utf-8 -*-
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+# Replay the packet traces recorded by rtlNVDLA with record_axi on
+# TrafficGens, one per trace, without simulating the RTL. The NVDLA
+# never has more than maxReq requests waiting for memory, the
+# generators are held to the same window. A request that has to wait
+# for a free slot delays the rest of its trace, as it would have
+# delayed the NVDLA.
+#
+# Example:
+#   build/ARM/gem5.opt configs/example/nvdla_replay.py \
+#       m5out/system.cpu_cluster.cpus.accels0.axi.trc.gz
+
+import argparse
+
+import m5
+from m5.objects import *
+from m5.util import addToPath, fatal
+
+addToPath('../')
+
+from common import ObjectList
+from common import MemConfig
+
+parser = argparse.ArgumentParser()
+
+parser.add_argument("traces", nargs="+",
+                    help="Packet traces recorded by rtlNVDLA")
+
+parser.add_argument("--mem-type", default="DDR3_1600_8x8",
+                    choices=ObjectList.mem_list.get_names(),
+                    help="type of memory to use")
+
+parser.add_argument("--mem-channels", type=int, default=1,
+                    help="number of memory channels")
+
+parser.add_argument("--mem-size", default="2GB",
+                    help="memory size, mapped at 0x80000000 like the "
+                         "NVDLA DRAM")
+
+# same default as --maxReqNVDLA in fs_bigLITTLE_RTL.py
+parser.add_argument("--max-outstanding", type=int, default=128,
+                    help="requests waiting for a response per trace, "
+                         "the maxReq of the recorded NVDLA")
+
+parser.add_argument("--no-elastic", action="store_true", default=False,
+                    help="keep the recorded times when a request has to "
+                         "wait instead of delaying the rest of the trace")
+
+args = parser.parse_args()
+
+system = System(membus = SystemXBar())
+system.clk_domain = SrcClockDomain(clock = '1GHz',
+                                   voltage_domain =
+                                   VoltageDomain(voltage = '1V'))
+
+system.mem_ranges = [AddrRange(0x80000000, size = args.mem_size)]
+system.mmap_using_noreserve = True
+
+args.external_memory_system = 0
+args.tlm_memory = 0
+args.elastic_trace_en = 0
+MemConfig.config_mem(args, system)
+
+system.tgens = [PyTrafficGen(max_outstanding_reqs = args.max_outstanding,
+                             elastic_req = not args.no_elastic)
+                for _ in args.traces]
+for tgen in system.tgens:
+    tgen.port = system.membus.cpu_side_ports
+
+system.system_port = system.membus.cpu_side_ports
+
+root = Root(full_system = False, system = system)
+root.system.mem_mode = 'timing'
+
+m5.instantiate()
+
+def replay(tgen, trace):
+    yield tgen.createTrace(0, trace)
+    yield tgen.createExit(0)
+
+for tgen, trace in zip(system.tgens, args.traces):
+    tgen.start(replay(tgen, trace))
+
+# every generator exits the simulation loop once its trace is done
+for i in range(len(args.traces)):
+    exit_event = m5.simulate()
+    if "exit state" not in exit_event.getCause():
+        fatal("Replay stopped: %s" % exit_event.getCause())
+    print("Trace done @ tick %d" % m5.curTick())
@@ -0,0 +1,280 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "axiPrefetcher.hh"
+#include "checkpoint.hh"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+
+AXIPrefetcher *
+AXIPrefetcher::create(int type, uint32_t block_size,
+                      const StreamPrefetchConfig &stream_cfg) {
+    switch (type) {
+    case PFT_NONE:
+        return nullptr;
+    case PFT_VAR_LOG:
+        return new VarLogPrefetcher(block_size);
+    case PFT_STREAM:
+        return new StreamPrefetcher(block_size, stream_cfg);
+    default:
+        printf("unknown prefetcher type %d\n", type);
+        abort();
+    }
+}
+
+AXIPrefetcher::AXIPrefetcher(uint32_t _block_size) :
+        block_size(_block_size),
+        pf_issued(0),
+        pf_useful(0),
+        pf_late(0),
+        pf_unused(0),
+        demand_misses(0),
+        last_block(UINT64_MAX) {
+}
+
+void
+AXIPrefetcher::demand(uint32_t addr, bool miss, bool in_flight) {
+    uint64_t block = addr / block_size;
+    // the other beats of a block tell nothing new
+    if (block != last_block) {
+        last_block = block;
+        auto it = live.find(block);
+        if (it != live.end()) {
+            pf_useful++;
+            if (in_flight)
+                pf_late++;
+            live.erase(it);
+        } else if (miss) {
+            demand_misses++;
+        }
+    }
+    observe(addr);
+}
+
+void
+AXIPrefetcher::issued(uint32_t addr, uint32_t len, bool sent) {
+    if (sent) {
+        uint64_t last = ((uint64_t)addr + len - 1) / block_size;
+        for (uint64_t b = addr / block_size; b <= last; b++) {
+            pf_issued++;
+            if (live.emplace(b, 1).second)
+                live_order.push_back(b);
+        }
+        // forget the oldest, the ones already read are just skipped
+        while (live_order.size() > track_size) {
+            if (live.erase(live_order.front()))
+                pf_unused++;
+            live_order.pop_front();
+        }
+    }
+    advance(addr, len);
+}
+
+void
+AXIPrefetcher::save(VerilatedSerialize &os) const {
+    ckpt_save(os, pf_issued);
+    ckpt_save(os, pf_useful);
+    ckpt_save(os, pf_late);
+    ckpt_save(os, pf_unused);
+    ckpt_save(os, demand_misses);
+    ckpt_save(os, live);
+    ckpt_save(os, live_order);
+    ckpt_save(os, last_block);
+}
+
+void
+AXIPrefetcher::restore(VerilatedDeserialize &is) {
+    ckpt_restore(is, pf_issued);
+    ckpt_restore(is, pf_useful);
+    ckpt_restore(is, pf_late);
+    ckpt_restore(is, pf_unused);
+    ckpt_restore(is, demand_misses);
+    ckpt_restore(is, live);
+    ckpt_restore(is, live_order);
+    ckpt_restore(is, last_block);
+}
+
+bool
+VarLogPrefetcher::next(uint32_t &addr) {
+    if (read_var_log.empty())
+        return false;
+    // assume the front of the list is a legal entry to prefetch
+    addr = std::get<0>(read_var_log.front()) + std::get<2>(read_var_log.front());
+    return true;
+}
+
+void
+VarLogPrefetcher::hint(uint32_t addr, uint32_t size) {
+    read_var_log.push_back(std::make_tuple(addr, size, 0));
+}
+
+void
+VarLogPrefetcher::observe(uint32_t addr) {
+    for (auto it = read_var_log.begin(); it != read_var_log.end(); it++) {
+        uint32_t& log_entry_length = std::get<1>(*it);
+        uint32_t& log_entry_addr = std::get<0>(*it);
+
+        if (log_entry_addr <= addr && addr < log_entry_addr + log_entry_length) {
+            uint32_t& log_entry_issued_len = std::get<2>(*it);
+            if (addr > log_entry_addr + log_entry_issued_len) {
+                printf("addr issued is beyond the log.\n");
+                abort();
+            } else if (addr == log_entry_addr + log_entry_issued_len) {
+                // that's the normal case, a demand read of an AXI beat
+                log_entry_issued_len += beat_size;
+
+                if (log_entry_issued_len == log_entry_length)
+                    read_var_log.erase(it);
+            }
+            // else covered by a previous prefetch / fetch
+            break;
+        }
+    }
+    // a mem req might also be covered by a popped entry, so no assert for logged
+}
+
+void
+VarLogPrefetcher::advance(uint32_t addr, uint32_t len) {
+    uint32_t& log_entry_length = std::get<1>(read_var_log.front());
+    uint32_t& log_entry_issued_len = std::get<2>(read_var_log.front());
+    log_entry_issued_len += len;
+    if (log_entry_issued_len >= log_entry_length)   // this prefetch is the end of the variable
+        read_var_log.pop_front();
+}
+
+void
+VarLogPrefetcher::save(VerilatedSerialize &os) const {
+    AXIPrefetcher::save(os);
+    ckpt_save(os, read_var_log);
+}
+
+void
+VarLogPrefetcher::restore(VerilatedDeserialize &is) {
+    AXIPrefetcher::restore(is);
+    ckpt_restore(is, read_var_log);
+}
+
+StreamPrefetcher::StreamPrefetcher(uint32_t block_size,
+                                   const StreamPrefetchConfig &cfg) :
+        AXIPrefetcher(block_size),
+        degree(cfg.degree),
+        max_delta(cfg.max_delta),
+        conf_threshold(cfg.conf_threshold),
+        conf_max(std::max(cfg.conf_max, cfg.conf_threshold)),
+        table(std::max(cfg.entries, 1u)),
+        clock(0) {
+    for (auto &s : table)
+        s.valid = 0;
+}
+
+void
+StreamPrefetcher::observe(uint32_t addr) {
+    uint64_t block = addr / block_size;
+    clock++;
+
+    // the closest stream, and the entry to replace if there is none
+    Stream *match = nullptr;
+    Stream *victim = &table[0];
+    for (auto &s : table) {
+        if (s.valid) {
+            int64_t delta = block - s.last;
+            if (std::abs(delta) <= (int64_t)max_delta &&
+                (!match || std::abs(delta) < std::abs((int64_t)(block - match->last))))
+                match = &s;
+            if (victim->valid && s.stamp < victim->stamp)
+                victim = &s;
+        } else if (victim->valid) {
+            victim = &s;
+        }
+    }
+
+    if (!match) {
+        *victim = {block, 0, block, clock, 0, 1};
+        return;
+    }
+
+    match->stamp = clock;
+    int64_t delta = block - match->last;
+    if (delta == 0)
+        return;
+    if (delta == match->stride) {
+        if (match->conf < conf_max)
+            match->conf++;
+    } else if (match->conf > 0) {
+        match->conf--;
+    } else {
+        match->stride = delta;
+        match->frontier = block;
+    }
+    match->last = block;
+
+    if (match->conf < conf_threshold)
+        return;
+
+    // keep degree strides ahead of the demand reads
+    int64_t stride = match->stride;
+    if ((int64_t)(match->frontier - block) * stride <= 0)
+        match->frontier = block;
+    const uint64_t max_block = UINT32_MAX / block_size;
+    while ((int64_t)(match->frontier - block) / stride < (int64_t)degree) {
+        if ((stride < 0 && match->frontier < (uint64_t)-stride) ||
+            (stride > 0 && match->frontier + stride > max_block))
+            break;
+        match->frontier += stride;
+        if (candidates.size() == max_candidates)
+            candidates.pop_front();
+        candidates.push_back(match->frontier);
+    }
+}
+
+bool
+StreamPrefetcher::next(uint32_t &addr) {
+    if (candidates.empty())
+        return false;
+    addr = candidates.front() * block_size;
+    candidates.pop_front();
+    return true;
+}
+
+void
+StreamPrefetcher::save(VerilatedSerialize &os) const {
+    AXIPrefetcher::save(os);
+    ckpt_save(os, table);
+    ckpt_save(os, candidates);
+    ckpt_save(os, clock);
+}
+
+void
+StreamPrefetcher::restore(VerilatedDeserialize &is) {
+    AXIPrefetcher::restore(is);
+    ckpt_restore(is, table);
+    ckpt_restore(is, candidates);
+    ckpt_restore(is, clock);
+}
@@ -0,0 +1,192 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __AXI_PREFETCHER_HH__
+#define __AXI_PREFETCHER_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <tuple>
+#include <unordered_map>
+#include <vector>
+
+class VerilatedSerialize;
+class VerilatedDeserialize;
+
+// Tuning of StreamPrefetcher, see there.
+struct StreamPrefetchConfig {
+    unsigned entries = 16;          // streams tracked at once
+    unsigned degree = 4;            // strides run ahead of the demand
+    unsigned max_delta = 64;        // blocks between reads of a stream
+    unsigned conf_threshold = 2;    // repeats before prefetching
+    unsigned conf_max = 3;          // saturation of the confidence
+};
+
+// Prefetch engines of the AXI responders.
+//
+// The responder reports every demand read to the engine with demand()
+// and, when it has room for more requests, asks it for an address to
+// prefetch with next(). Once the prefetch is sent, or found to be
+// covered already, it calls issued(). Engines work on blocks of
+// block_size bytes: an AXI beat, or an spm line when the scratchpad
+// is filled by DMA.
+//
+// The base class keeps the usefulness stats shared by every engine.
+// A prefetched block is useful when a demand read reaches it, late
+// if the prefetch was still in flight then, and unused when it is
+// forgotten before any demand read. Only the last track_size
+// prefetched blocks are remembered.
+class AXIPrefetcher {
+public:
+    enum Type {
+        PFT_NONE = 0,
+        PFT_VAR_LOG = 1,    // regions listed by the compiler (read_var_log)
+        PFT_STREAM = 2      // streams learnt from the demand reads
+    };
+
+    // nullptr for PFT_NONE, stream_cfg is only used by PFT_STREAM
+    static AXIPrefetcher *create(int type, uint32_t block_size,
+                                 const StreamPrefetchConfig &stream_cfg);
+
+    explicit AXIPrefetcher(uint32_t block_size);
+    virtual ~AXIPrefetcher() {}
+
+    // A demand read of addr. miss: it has to be fetched from memory,
+    // in_flight: a fetch of its block is already on its way
+    void demand(uint32_t addr, bool miss, bool in_flight);
+
+    // Next address to prefetch, false if there is none
+    virtual bool next(uint32_t &addr) = 0;
+
+    // The prefetch of len bytes at addr given by next() is sent, or
+    // not (sent = false) because the data is already there or coming
+    void issued(uint32_t addr, uint32_t len, bool sent);
+
+    // A read-only region announced by the compiler
+    virtual void hint(uint32_t addr, uint32_t size) {}
+
+    // There are addresses left to prefetch
+    virtual bool pending() const = 0;
+
+    // engine state and stats, for checkpoints
+    virtual void save(VerilatedSerialize &os) const;
+    virtual void restore(VerilatedDeserialize &is);
+
+    const uint32_t block_size;
+
+    // stats
+    uint64_t pf_issued;
+    uint64_t pf_useful;
+    uint64_t pf_late;
+    uint64_t pf_unused;
+    uint64_t demand_misses;     // reads that went to memory, not prefetched
+
+protected:
+    // train on a demand read, called for every beat
+    virtual void observe(uint32_t addr) {}
+    // move past the blocks of a prefetch given by next()
+    virtual void advance(uint32_t addr, uint32_t len) {}
+
+private:
+    static const size_t track_size = 4096;
+
+    // prefetched blocks not read yet, in prefetch order
+    std::unordered_map<uint64_t, uint8_t> live;
+    std::deque<uint64_t> live_order;
+    // last block a demand read was seen for
+    uint64_t last_block;
+};
+
+// Prefetches the read-only variables logged by the compiler, in
+// order, as the old software prefetch did.
+class VarLogPrefetcher : public AXIPrefetcher {
+public:
+    explicit VarLogPrefetcher(uint32_t block_size) : AXIPrefetcher(block_size) {}
+
+    bool next(uint32_t &addr) override;
+    void hint(uint32_t addr, uint32_t size) override;
+    bool pending() const override { return !read_var_log.empty(); }
+
+    void save(VerilatedSerialize &os) const override;
+    void restore(VerilatedDeserialize &is) override;
+
+protected:
+    void observe(uint32_t addr) override;
+    void advance(uint32_t addr, uint32_t len) override;
+
+private:
+    // demand reads come in AXI beats (AXI_WIDTH / 8)
+    static const uint32_t beat_size = 64;
+
+    // each tuple is (addr, length, issued_len) of a read-only variable
+    std::list<std::tuple<uint32_t, uint32_t, uint32_t>> read_var_log;
+};
+
+// Online stream prefetcher. There is no PC on the AXI interface, so
+// a stream is any run of demand blocks that stay within max_delta
+// blocks of each other. Each of the entries of the table learns the
+// stride of its stream; after conf_threshold repeats it runs degree
+// strides ahead of the last demand block.
+class StreamPrefetcher : public AXIPrefetcher {
+public:
+    StreamPrefetcher(uint32_t block_size, const StreamPrefetchConfig &cfg);
+
+    bool next(uint32_t &addr) override;
+    bool pending() const override { return !candidates.empty(); }
+
+    void save(VerilatedSerialize &os) const override;
+    void restore(VerilatedDeserialize &is) override;
+
+protected:
+    void observe(uint32_t addr) override;
+
+private:
+    struct Stream {
+        uint64_t last;      // last demand block
+        int64_t stride;     // in blocks
+        uint64_t frontier;  // last block handed out for prefetch
+        uint64_t stamp;     // for LRU replacement
+        uint32_t conf;
+        uint8_t valid;
+    };
+
+    const unsigned degree;
+    const unsigned max_delta;
+    const unsigned conf_threshold;
+    const unsigned conf_max;
+    // blocks to prefetch, oldest first. Bounded, the oldest are dropped
+    static const size_t max_candidates = 64;
+
+    std::vector<Stream> table;
+    std::deque<uint64_t> candidates;
+    uint64_t clock;
+};
+
+#endif // __AXI_PREFETCHER_HH__
@@ -13,7 +13,9 @@
 
 
 #include <assert.h>
+#include <string.h>
 #include "axiResponder.hh"
+#include "checkpoint.hh"
 
 AXIResponder::AXIResponder(struct connections _dla,
                                    Wrapper_nvdla *_wrapper,
@@ -35,12 +37,18 @@ AXIResponder::AXIResponder(struct connections _dla,
     sram = sram_;
 
     max_req_inflight = (maxReq<240) ? maxReq:240;
+    // a burst accepted at the limit can add up to 256 more
+    inflight_req = InflightTable<axi_r_txn>(max_req_inflight + 256);
 
     AXI_R_LATENCY = wrapper->dma_enable ? wrapper->spm_latency : 0;
     // for non-spm configuration, this fixed latency is modeled by gem5 memory system
 
     pft_threshold = 16;
     dma_pft_threshold = 32;
+    // with the scratchpad, prefetches fill whole spm lines
+    prefetcher.reset(AXIPrefetcher::create(wrapper->prefetch_enable,
+        wrapper->dma_enable ? wrapper->spm_line_size : AXI_WIDTH / 8,
+        wrapper->stream_pft_cfg));
 
     // add some latency...
     for (int i = 0; i < AXI_R_LATENCY; i++) {
@@ -76,6 +84,11 @@ AXIResponder::write(uint32_t addr, uint8_t data, bool timing) {
     wrapper->addWriteReq(sram,timing,addr,data);
 }
 
+void
+AXIResponder::write_block(uint32_t addr, const uint8_t* data, uint32_t len) {
+    wrapper->addBulkWriteReq(sram, addr, len, data);
+}
+
 void
 AXIResponder::eval_ram() {
     /* write request */
@@ -513,29 +526,29 @@ AXIResponder::eval_timing() {
                 txn.rid = *dla.ar_arid;
                 txn.is_prefetch = 0;
 
-                if(wrapper->prefetch_enable)
-                    log_req_issue(start_addr);
-
                 // check spm and write queue
                 bool data_get_in_spm_or_queue = get_txn_data_from_spm_and_wr_queue(start_addr, txn.rdata);
+                uint64_t spm_line_addr = start_addr & ~((uint64_t)(wrapper->spm_line_size - 1));
+                bool in_flight = !data_get_in_spm_or_queue &&
+                    inflight_dma_addr_size.find(spm_line_addr) != inflight_dma_addr_size.end();
+                if (prefetcher)
+                    prefetcher->demand(start_addr, !data_get_in_spm_or_queue && !in_flight, in_flight);
+
                 if (data_get_in_spm_or_queue) {
                     // need to maintain the order of issuing requests
                     // printf("this spm_line_addr exists in spm, 0x%08lx\n", spm_line_addr);
                     txn.rvalid = 1;
                 } else {
                     // first check whether this addr has been covered by an inflight DMA request or not
-                    uint64_t spm_line_addr = start_addr & ~((uint64_t)(wrapper->spm_line_size - 1));
-                    if (inflight_dma_addr_size.find(spm_line_addr) == inflight_dma_addr_size.end()) {
+                    if (!in_flight) {
                         // not covered, need to initiate a new DMA
                         inflight_dma_addr_size[spm_line_addr] = wrapper->spm_line_size;
-                        inflight_dma_addr_queue.push(spm_line_addr);
                         wrapper->addDMAReadReq(spm_line_addr, wrapper->spm_line_size);
                         issued_req_this_cycle = true;
                     }
                     txn.rvalid = 0;
                 }
-                inflight_req_order.push_back(start_addr);
-                inflight_req[start_addr].push_back(txn);
+                inflight_req.push(start_addr, txn, !txn.rvalid, false);
             }
         } else {
             issued_req_this_cycle = true;
@@ -548,13 +561,14 @@ AXIResponder::eval_timing() {
                 txn.rid = *dla.ar_arid;
                 txn.is_prefetch = 0;
 
-                if(wrapper->prefetch_enable)
-                    log_req_issue(addr);
+                if (prefetcher) {
+                    // a prefetch of this beat may still be on its way
+                    int32_t pf_slot = inflight_req.find_pending(addr);
+                    prefetcher->demand(addr, true, pf_slot >= 0 && inflight_req.txn(pf_slot).is_prefetch);
+                }
 
-                // put txn to the map
-                inflight_req[addr].push_back(txn);
-                // put in req the txn
-                inflight_req_order.push_back(addr);
+                // put txn in the table
+                inflight_req.push(addr, txn, true, false);
 
                 read_variable(addr, true, AXI_WIDTH / 8);
 
@@ -565,58 +579,56 @@ AXIResponder::eval_timing() {
         // next cycle we are not ready
         *dla.ar_arready = 0;
     } else {
-        *dla.ar_arready = (inflight_req_order.size() <= max_req_inflight);
+        *dla.ar_arready = (inflight_req.size() <= max_req_inflight);
     }
 
 #ifdef PRINT_DEBUG
-    if (inflight_req_order.size() > 0) {
+    if (inflight_req.size() > 0) {
         printf("(%lu) nvdla#%d %s: Remaining %d\n",
                 wrapper->tickcount, wrapper->id_nvdla, name,
-                inflight_req_order.size());
+                inflight_req.size());
     }
 #endif
 
     //! generate prefetch request
     // todo: handle pft_threshold in spm settings properly
-    if (wrapper->prefetch_enable && inflight_req_order.size() < pft_threshold &&
-        inflight_dma_addr_queue.size() < dma_pft_threshold && !issued_req_this_cycle) {
+    if (prefetcher && inflight_req.size() < pft_threshold &&
+        inflight_dma_addr_size.size() < dma_pft_threshold && !issued_req_this_cycle) {
         generate_prefetch_request();
     }
 
     //! handle read return
-    auto it_addr = inflight_req_order.begin();
-    if (!inflight_req_order.empty()) {
-        // find the first non-prefetch inflight_req addr
-        // assume all inflight_req for prefetches will be removed in inflight_resp and inflight_resp_dma
-        while (inflight_req[*it_addr].front().is_prefetch && it_addr != inflight_req_order.end()) {
-            it_addr++;
-        }
-    }
-    if (it_addr != inflight_req_order.end()) {  // that's a non-prefetch txn. we'll check valid or not inside the branch
-        uint32_t addr_front = *it_addr;
+    // find the first non-prefetch inflight_req
+    // assume all inflight_req for prefetches will be removed in inflight_resp and inflight_resp_dma
+    int32_t slot = inflight_req.first_demand();
+    if (slot >= 0) {  // that's a non-prefetch txn. we'll check valid or not inside the branch
+        uint32_t addr_front = inflight_req.addr(slot);
 
-        axi_r_txn &txn = inflight_req[addr_front].front();
+        axi_r_txn &txn = inflight_req.txn(slot);
         // data just arrived in spm via DMA will not update its corresponding txn.rvalid
         if (wrapper->dma_enable && txn.rvalid == 0) {
-            bool got = get_txn_data_from_spm_and_wr_queue(addr_front, txn.rdata);
-            if (got)
+            bool got = get_txn_data_from_spm_and_wr_queue(addr_front, txn.rdata, false);
+            if (got) {
                 txn.rvalid = 1;
+            } else {
+                // the line may have been evicted before we got here, fetch it again
+                uint64_t spm_line_addr = addr_front & ~((uint64_t)(wrapper->spm_line_size - 1));
+                if (inflight_dma_addr_size.find(spm_line_addr) == inflight_dma_addr_size.end()) {
+                    inflight_dma_addr_size[spm_line_addr] = wrapper->spm_line_size;
+                    wrapper->addDMAReadReq(spm_line_addr, wrapper->spm_line_size);
+                }
+            }
         }
         if (txn.rvalid) {  // ensures the order of response
             printf("(%lu) nvdla#%d read data returned by gem5 (or already in spm), addr 0x%08x\n",
                    wrapper->tickcount, wrapper->id_nvdla, addr_front);
 
             // push the front one
-            r_fifo.push(inflight_req[addr_front].front());
+            r_fifo.push(txn);
             // todo: add some AXI_R_DELAY txns. currently we are setting AXI_R_DELAY = 0 so it is also correct
 
-            // remove the front
-            inflight_req[addr_front].pop_front();
-            // check if empty to remove entry from map
-            if (inflight_req[addr_front].empty())
-                inflight_req.erase(addr_front);
-            // delete in the queue order
-            inflight_req_order.erase(it_addr);
+            // remove it, no matter if its addr was still waiting for data
+            inflight_req.retire(slot);
         }
     }
 
@@ -634,13 +646,10 @@ AXIResponder::eval_timing() {
 
         if(wrapper->dma_enable) {
             // intermediate variables and outputs should be written to spm (actually, all writes belong to this type)
-            Wrapper_nvdla::spm_wr_txn spm_txn;
-            spm_txn.addr = awtxn.awaddr;
-            spm_txn.mask = wtxn.wstrb;
-            spm_txn.countdown = wrapper->spm_latency;
+            uint8_t tmp_buf[AXI_WIDTH / 8];
             for (int i = 0; i < AXI_WIDTH / 8; i++)
-                spm_txn.data[i] = (wtxn.wdata[i / 4] >> ((i % 4) * 8)) & 0xFF;
-            wrapper->spm_write_queue.push_back(spm_txn);
+                tmp_buf[i] = (wtxn.wdata[i / 4] >> ((i % 4) * 8)) & 0xFF;
+            wrapper->push_spm_write(awtxn.awaddr, tmp_buf, wtxn.wstrb);
         } else {
             uint8_t tmp_buf[AXI_WIDTH / 8];
             for (int ii = 0; ii < AXI_WIDTH / 8; ii++)
@@ -673,23 +682,8 @@ AXIResponder::eval_timing() {
     }
 
     // process spm write queue countdown
-    if (wrapper->dma_enable && !wrapper->spm_write_queue.empty()) {
-        while (wrapper->spm_write_queue.front().countdown == 0) {
-            // write to spm
-            auto& spm_txn = wrapper->spm_write_queue.front();
-            for (int i = 0; i < AXI_WIDTH / 8; i++) {
-                if (!((spm_txn.mask >> i) & 1))
-                    continue;
-                wrapper->write_spm(spm_txn.addr + i, spm_txn.data[i]);
-            }
-
-            wrapper->spm_write_queue.pop_front();
-            if(wrapper->spm_write_queue.empty())
-                break;
-        }
-        for (auto it = wrapper->spm_write_queue.begin(); it != wrapper->spm_write_queue.end(); it++)
-            it->countdown--;
-    }
+    if (wrapper->dma_enable)
+        wrapper->drain_spm_write_queue(false);
 
     /* read response */
     if (!r_fifo.empty()) {
@@ -749,48 +743,24 @@ AXIResponder::inflight_resp(uint32_t addr, const uint8_t* data) {
                 wrapper->tickcount, wrapper->id_nvdla, name, addr);
     #endif
     uint32_t * ptr = (uint32_t*) data;
-    std::list<axi_r_txn>::iterator it = inflight_req[addr].begin();
-    // Get the correct ptr
-    int count_pos = 0;
-    while (it != inflight_req[addr].end() and it->rvalid) {
-       it++;
-       count_pos++;
-    }
-    assert(it != inflight_req[addr].end());
+    // Get the oldest txn still waiting for this addr
+    int32_t slot = inflight_req.find_pending(addr);
+    assert(slot >= 0);
+    axi_r_txn &txn = inflight_req.txn(slot);
     for (int i = 0; i < AXI_WIDTH / 32; i++) {
-        it->rdata[i] = ptr[i];
+        txn.rdata[i] = ptr[i];
     }
-    it->rvalid = 1;
-    if (it->is_prefetch) {
+    txn.rvalid = 1;
+    if (txn.is_prefetch) {
         printf("(%lu) nvdla#%d read data returned by gem5 PREFETCH, addr 0x%08x\n", wrapper->tickcount, wrapper->id_nvdla, addr);
-        //! delete this txn in inflight_req_order and inflight_req
-        // first delete in inflight_req_order
-        bool deleted = false;
-        for (auto addr_it = inflight_req_order.begin(); addr_it != inflight_req_order.end(); addr_it++) {
-            if ((*addr_it) == addr) {
-                if (count_pos == 0) {
-                    // that's the exact addr_it that should be deleted
-                    inflight_req_order.erase(addr_it);
-                    deleted = true;
-                    break;
-                } else {
-                    count_pos--;
-                }
-            }
-        }
-        assert(deleted);
-
-        // then delete in inflight_req
-        inflight_req[addr].erase(it);
-        if (inflight_req[addr].empty()) {
-            inflight_req.erase(addr);
-        }
-
+        // nobody waits for it, delete this txn
+        inflight_req.retire(slot);
     } else {
         printf("(%lu) nvdla#%d read data returned by gem5, addr 0x%08x\n", wrapper->tickcount, wrapper->id_nvdla, addr);
+        inflight_req.fill(slot);
     }
     #ifdef PRINT_DEBUG
-    printf("Remaining %d\n", inflight_req_order.size());
+    printf("Remaining %d\n", inflight_req.size());
     printf("(%lu) nvdla#%d %s: Inflight Resp Timing Finished: addr %08lx \n",
             wrapper->tickcount, wrapper->id_nvdla, name, addr);
     #endif
@@ -810,9 +780,8 @@ AXIResponder::inflight_resp_atomic(uint32_t addr,
 }
 
 void
-AXIResponder::inflight_dma_resp(const uint8_t* data, uint32_t len) {
-    //! we HAVE TO assume dma is in-order. If it is out-of-order due to bus arbitration, even DMAFifo can't handle it
-    uint32_t addr = inflight_dma_addr_queue.front();
+AXIResponder::inflight_dma_resp(uint32_t addr, const uint8_t* data, uint32_t len) {
+    // transfers of different lines can complete in any order, but the data of a line comes in order
     printf("(%lu) nvdla#%d AXIResponder handling DMA return data @0x%08x with length %d.\n",
            wrapper->tickcount, wrapper->id_nvdla, addr, len);
 
@@ -820,14 +789,10 @@ AXIResponder::inflight_dma_resp(const uint8_t* data, uint32_t len) {
     uint32_t size_remaining = old_size_remaining - len;
     inflight_dma_addr_size[addr] = size_remaining;
 
-    std::vector<uint8_t>& entry_vector = wrapper->spm[addr];
-    entry_vector.resize(wrapper->spm_line_size - size_remaining, 0);
-    for (int i = 0; i < len; i++)
-        entry_vector[wrapper->spm_line_size - old_size_remaining + i] = data[i];
+    wrapper->spm.fill(addr, wrapper->spm_line_size - old_size_remaining, data, len);
 
     if (size_remaining == 0) {  // all data for this DMA transfer has been got
         inflight_dma_addr_size.erase(addr);
-        inflight_dma_addr_queue.pop();
     }
 }
 
@@ -863,6 +828,7 @@ AXIResponder::read_for_traceLoaderGem5(uint32_t start_addr, uint32_t length) {
         txn.rvalid = 0;
         txn.burst = true;
         txn.rlast = (txn_start_addr + delta_addr + (AXI_WIDTH / 8) >= start_addr + length);
+        txn.is_prefetch = 0;
         if(wrapper->dma_enable) {
             bool got = get_txn_data_from_spm_and_wr_queue(txn_addr, txn.rdata);
             if(got) {
@@ -872,10 +838,8 @@ AXIResponder::read_for_traceLoaderGem5(uint32_t start_addr, uint32_t length) {
         } else
             read_variable(txn_addr, true, AXI_WIDTH / 8);
 
-        // put txn to the map
-        inflight_req[txn_addr].push_back(txn);
-        // put in req the txn
-        inflight_req_order.push_back(txn_addr);
+        // put txn in the table
+        inflight_req.push(txn_addr, txn, !txn.rvalid, false);
     }
 }
 
@@ -883,8 +847,9 @@ AXIResponder::read_for_traceLoaderGem5(uint32_t start_addr, uint32_t length) {
 uint32_t
 AXIResponder::read_response_for_traceLoaderGem5(uint32_t start_addr, uint8_t* data_buffer) {
     // check status of memory reading request
-    assert(!inflight_req_order.empty());
-    uint32_t addr_front = inflight_req_order.front();
+    assert(!inflight_req.empty());
+    uint32_t slot = inflight_req.front();
+    uint32_t addr_front = inflight_req.addr(slot);
 
     if (addr_front != start_addr) {
         // this should not happen
@@ -893,15 +858,10 @@ AXIResponder::read_response_for_traceLoaderGem5(uint32_t start_addr, uint8_t* da
         abort();
     }
 
-    assert(!inflight_req[addr_front].empty());
-    axi_r_txn txn = inflight_req[addr_front].front();
+    axi_r_txn txn = inflight_req.txn(slot);
     if (txn.rvalid) {
         printf("(%lu) nvdla#%d memory request at 0x%08x has arrived.\n", wrapper->tickcount, wrapper->id_nvdla, start_addr);
-        inflight_req[addr_front].pop_front();
-        if (inflight_req[addr_front].empty())
-            inflight_req.erase(addr_front);
-
-        inflight_req_order.pop_front();
+        inflight_req.retire(slot);
 
         // get the value
         for (uint32_t byte_id = 0; byte_id < AXI_WIDTH / 8; byte_id++)
@@ -916,132 +876,151 @@ AXIResponder::read_response_for_traceLoaderGem5(uint32_t start_addr, uint8_t* da
 
 bool
 AXIResponder::check_txn_data_in_spm_and_wr_queue(uint32_t addr) {
-    // search spm_write_queue first
-    for (auto it = wrapper->spm_write_queue.begin(); it != wrapper->spm_write_queue.end(); it++) {
-        if ((uint32_t)(it->addr) == addr)
-            return true;
-    }
+    // the queued writes must cover the whole beat unless spm has the rest
+    uint8_t line[AXI_WIDTH / 8];
+    return wrapper->merge_spm_writes(addr, line) == ~(uint64_t)0 ||
+           wrapper->spm.contains(addr, AXI_WIDTH / 8);
+}
+
+bool
+AXIResponder::get_txn_data_from_spm_and_wr_queue(uint32_t addr, uint32_t* to_be_filled_data, bool count) {
+    uint8_t line[AXI_WIDTH / 8];
 
-    // then search spm
-    uint64_t spm_line_addr = addr & ~((uint64_t)(wrapper->spm_line_size - 1));
-    if (wrapper->spm.find(spm_line_addr) == wrapper->spm.end()) {
+    // spm first, then every queued write to the beat on top of it
+    bool pending = wrapper->spm_write_index.count(addr);
+    bool in_spm = wrapper->read_spm(addr, line, AXI_WIDTH / 8, count && !pending);
+    uint64_t covered = wrapper->merge_spm_writes(addr, line);
+
+    // bytes neither in spm nor written have to come from memory
+    if (!in_spm && covered != ~(uint64_t)0)
         return false;
-    }
+
+    for (int k = 0; k < AXI_WIDTH / 8; k += 4)
+        to_be_filled_data[k / 4] = line[k] + (line[k + 1] << 8) + (line[k + 2] << 16) + (line[k + 3] << 24);
     return true;
 }
 
+uint32_t
+AXIResponder::getRequestsOnFlight() {
+    return inflight_req.size();
+}
+
 bool
-AXIResponder::get_txn_data_from_spm_and_wr_queue(uint32_t addr, uint32_t* to_be_filled_data) {
-    uint8_t* spm_write_queue_data = nullptr;
-    // search spm_write_queue first
-    for (auto it = wrapper->spm_write_queue.begin(); it != wrapper->spm_write_queue.end(); it++) {
-        if ((uint32_t)it->addr == addr) {
-            spm_write_queue_data = it->data;
-            break;
-        }
-    }
-    if (spm_write_queue_data != nullptr) {
-        for (int k = 0; k < AXI_WIDTH / 8; k += 4) {
-            uint32_t da = spm_write_queue_data[k] + (spm_write_queue_data[k + 1] << 8) +
-                          (spm_write_queue_data[k + 2] << 16) + (spm_write_queue_data[k + 3] << 24);
-            to_be_filled_data[k / 4] = da;
-        }
-        return true;
-    }
-    // then search spm
-    uint64_t spm_line_addr = addr & ~((uint64_t)(wrapper->spm_line_size - 1));
-    if (wrapper->spm.find(spm_line_addr) == wrapper->spm.end())
+AXIResponder::idle() {
+    // no handshake started by nvdla or pending on our side
+    if (*dla.ar_arvalid || *dla.aw_awvalid || *dla.w_wvalid ||
+        *dla.r_rvalid || *dla.b_bvalid)
         return false;
+    if (!aw_fifo.empty() || !w_fifo.empty() || !b_fifo.empty() || !r_fifo.empty())
+        return false;
+    for (size_t i = 0; i < r0_fifo.size(); i++) {
+        // r0_fifo is only a delay line, rotate it to look at every entry
+        axi_r_txn txn = r0_fifo.front();
+        r0_fifo.pop();
+        r0_fifo.push(txn);
+        if (txn.rvalid)
+            return false;
+    }
 
-    for (int k = 0; k < AXI_WIDTH / 32; k++) {
-        uint32_t da = wrapper->read_spm(addr + k * 4) +
-                (wrapper->read_spm(addr + k * 4 + 1) << 8) +
-                (wrapper->read_spm(addr + k * 4 + 2) << 16) +
-                (wrapper->read_spm(addr + k * 4 + 3) << 24);
-        to_be_filled_data[k] = da;
+    // the oldest reads must still be waiting for their data
+    if (!inflight_req.empty() && inflight_req.txn(inflight_req.front()).rvalid)
+        return false;
+    int32_t slot = inflight_req.first_demand();
+    if (slot >= 0) {
+        if (inflight_req.txn(slot).rvalid)
+            return false;
+        if (wrapper->dma_enable && check_txn_data_in_spm_and_wr_queue(inflight_req.addr(slot)))
+            return false;
     }
+
+    if (wrapper->dma_enable && !wrapper->spm_write_queue.empty())
+        return false;
+    if (prefetcher && prefetcher->pending())
+        return false;
     return true;
 }
 
-uint32_t
-AXIResponder::getRequestsOnFlight() {
-    return inflight_req_order.size();
-}
+bool
+AXIResponder::stalled() {
+    if (*dla.ar_arvalid && !*dla.ar_arready)
+        return true;
 
-void
-AXIResponder::add_rd_var_log_entry(uint32_t addr, uint32_t size) {
-    read_var_log.push_back(std::make_tuple(addr, size, 0));
+    int32_t slot = inflight_req.first_demand();
+    if (slot < 0 || inflight_req.txn(slot).rvalid)
+        return false;
+    // with DMA the line may be in the spm already, it is sent next cycle
+    return !(wrapper->dma_enable &&
+             check_txn_data_in_spm_and_wr_queue(inflight_req.addr(slot)));
 }
 
 void
-AXIResponder::log_req_issue(uint32_t addr) {
-    for (auto it = read_var_log.begin(); it != read_var_log.end(); it++) {
-        uint32_t& log_entry_length = std::get<1>(*it);
-        uint32_t& log_entry_addr = std::get<0>(*it);
-
-        if (log_entry_addr <= addr && addr < log_entry_addr + log_entry_length) {
-            uint32_t& log_entry_issued_len = std::get<2>(*it);
-            if (addr > log_entry_addr + log_entry_issued_len) {
-                printf("nvdla#%d addr issued is beyond the log.\n", wrapper->id_nvdla);
-                abort();
-            } else if (addr == log_entry_addr + log_entry_issued_len) {
-                // that's the normal case
-                log_entry_issued_len += (AXI_WIDTH / 8);
-
-                if (log_entry_issued_len == log_entry_length)
-                    read_var_log.erase(it);
-            } else {
-                // printf("read req for %d has been covered by a previous pft / fetch.\n", addr);
-            }
-            break;
-        }
-    }
-    // a mem req might also be covered by a popped entry, so no assert for logged
+AXIResponder::add_rd_var_log_entry(uint32_t addr, uint32_t size) {
+    if (prefetcher)
+        prefetcher->hint(addr, size);
 }
 
 void
 AXIResponder::generate_prefetch_request() {
-    if (read_var_log.empty())
+    uint32_t to_issue_addr;
+    if (!prefetcher->next(to_issue_addr))
         return;
-    // assume the front of the list is a legal entry to prefetch
-    uint32_t& log_entry_addr = std::get<0>(read_var_log.front());
-    uint32_t& log_entry_length = std::get<1>(read_var_log.front());
-    uint32_t& log_entry_issued_len = std::get<2>(read_var_log.front());
-
-    uint32_t to_issue_addr = log_entry_addr + log_entry_issued_len;
-
-    // generate the corresponding txn
-    axi_r_txn txn;
-
-    // write to the txn
-    txn.rvalid = 0;     // since read addresses are streaming, we don't think this is present in spm (if dma_enable)
-    txn.is_prefetch = 1;
-    // if to_issue_addr is covered by a previous dma, it's useless to issue such prefetch request
-
-    printf("(%lu) nvdla#%d PREFETCH request addr %08x issued.\n", wrapper->tickcount, wrapper->id_nvdla, to_issue_addr);
 
     if (wrapper->dma_enable) {
-        assert(!check_txn_data_in_spm_and_wr_queue(to_issue_addr)); // weights are unique, shouldn't have been prefetched
-        // first check whether this addr has been covered by an inflight DMA request or not
+        // useless if the line is already in spm or a previous dma covers it
         uint64_t spm_line_addr = to_issue_addr & ~((uint64_t)(wrapper->spm_line_size - 1));
-        if (inflight_dma_addr_size.find(spm_line_addr) == inflight_dma_addr_size.end()) {
-            // not covered, need to initiate a new DMA
+        bool covered = check_txn_data_in_spm_and_wr_queue(to_issue_addr) ||
+            inflight_dma_addr_size.find(spm_line_addr) != inflight_dma_addr_size.end();
+        if (!covered) {
+            printf("(%lu) nvdla#%d PREFETCH request addr %08x issued.\n", wrapper->tickcount, wrapper->id_nvdla, to_issue_addr);
             inflight_dma_addr_size[spm_line_addr] = wrapper->spm_line_size;
-            inflight_dma_addr_queue.push(spm_line_addr);
             wrapper->addDMAReadReq(spm_line_addr, wrapper->spm_line_size);
-
-            log_entry_issued_len += wrapper->spm_line_size;
             // here we don't add dma prefetch to inflight_req and inflight_order
             // because as long as spm can get the prefetched data, we don't bother axi responder to check it
-
-        }   // else we don't need a new dma request. it is covered by a previous one
+        }
+        prefetcher->issued(to_issue_addr, wrapper->spm_line_size, !covered);
     } else {
-        inflight_req[to_issue_addr].push_back(txn);
-        inflight_req_order.push_back(to_issue_addr);
-        read_variable(to_issue_addr, true, AXI_WIDTH / 8);
-        log_entry_issued_len += AXI_WIDTH / 8;  // here the gap of issuing should be cache line size
+        bool covered = inflight_req.find_pending(to_issue_addr) >= 0;
+        if (!covered) {
+            printf("(%lu) nvdla#%d PREFETCH request addr %08x issued.\n", wrapper->tickcount, wrapper->id_nvdla, to_issue_addr);
+            // generate the corresponding txn, nobody waits for its data
+            axi_r_txn txn;
+            txn.rvalid = 0;
+            txn.is_prefetch = 1;
+            inflight_req.push(to_issue_addr, txn, true, true);
+            read_variable(to_issue_addr, true, AXI_WIDTH / 8);
+        }
+        prefetcher->issued(to_issue_addr, AXI_WIDTH / 8, !covered);
     }
+}
 
-    if (log_entry_issued_len >= log_entry_length)       // this prefetch is the end of the variable
-        read_var_log.pop_front();
+void
+AXIResponder::save(VerilatedSerialize &os) const {
+    ckpt_save(os, r_fifo);
+    ckpt_save(os, r0_fifo);
+    ckpt_save(os, aw_fifo);
+    ckpt_save(os, w_fifo);
+    ckpt_save(os, b_fifo);
+    ckpt_save(os, ram);
+    inflight_req.save(os);
+    ckpt_save(os, inflight_dma_addr_size);
+    ckpt_save(os, pft_threshold);
+    ckpt_save(os, dma_pft_threshold);
+    if (prefetcher)
+        prefetcher->save(os);
+}
+
+void
+AXIResponder::restore(VerilatedDeserialize &is) {
+    ckpt_restore(is, r_fifo);
+    ckpt_restore(is, r0_fifo);
+    ckpt_restore(is, aw_fifo);
+    ckpt_restore(is, w_fifo);
+    ckpt_restore(is, b_fifo);
+    ckpt_restore(is, ram);
+    inflight_req.restore(is);
+    ckpt_restore(is, inflight_dma_addr_size);
+    ckpt_restore(is, pft_threshold);
+    ckpt_restore(is, dma_pft_threshold);
+    if (prefetcher)
+        prefetcher->restore(is);
 }
@@ -10,8 +10,10 @@
 #ifndef __AXI_RESPONDER__
 #define __AXI_RESPONDER__
 
-#include <list>
+#include <memory>
 
+#include "axiPrefetcher.hh"
+#include "inflightTable.hh"
 #include "wrapper_nvdla.hh"
 
 class Wrapper_nvdla;
@@ -93,19 +95,16 @@ private:
     Wrapper_nvdla *wrapper;
 
     // gem5 memory
-    // map key:addr, data:txn
-    std::map<uint32_t, std::list<axi_r_txn>> inflight_req;
-    std::list<uint32_t> inflight_req_order;
+    // read txns in issue order, indexed by addr while waiting for data
+    InflightTable<axi_r_txn> inflight_req;
     unsigned int max_req_inflight;
 
     // dma & spm
-    std::map<uint64_t, uint32_t> inflight_dma_addr_size;    // record the inflight dma request sizes
-    std::queue<uint32_t> inflight_dma_addr_queue;           // keep dma request order
+    std::map<uint64_t, uint32_t> inflight_dma_addr_size;    // record the inflight dma request sizes, by line addr
 
     // prefetch
     uint32_t pft_threshold;
     uint32_t dma_pft_threshold;
-    std::list<std::tuple<uint32_t, uint32_t, uint32_t>> read_var_log;  // each tuple is (addr, length, issued_len) of a read-only variable
 
     bool sram;
 
@@ -116,6 +115,16 @@ public:
 
     uint32_t getRequestsOnFlight();
 
+    // engine chosen by Wrapper_nvdla::prefetch_enable, nullptr if none
+    std::unique_ptr<AXIPrefetcher> prefetcher;
+
+    // nothing to do until a read comes back from memory
+    bool idle();
+
+    // nvdla is held up by memory: the oldest read it waits for has no
+    // data yet, or a new read is refused because too many are in flight
+    bool stalled();
+
     // In this function we read from memory
     uint8_t read_ram(uint32_t addr);
 
@@ -133,10 +142,12 @@ public:
 
     // In this function we write to memory
     void write(uint32_t addr, uint8_t data, bool timing);
+    // functional write of len bytes, data is referenced until sent
+    void write_block(uint32_t addr, const uint8_t* data, uint32_t len);
     void write_ram(uint32_t addr, uint8_t data);
 
     bool check_txn_data_in_spm_and_wr_queue(uint32_t addr);
-    bool get_txn_data_from_spm_and_wr_queue(uint32_t addr, uint32_t* to_be_filled_data);
+    bool get_txn_data_from_spm_and_wr_queue(uint32_t addr, uint32_t* to_be_filled_data, bool count = true);
 
     void insertPacket(uint8_t* data, axi_r_txn* txn);
 
@@ -149,11 +160,19 @@ public:
                               const uint8_t* data,
                               axi_r_txn *txn);
 
-    void inflight_dma_resp(const uint8_t* data, uint32_t len);
+    void inflight_dma_resp(uint32_t addr, const uint8_t* data, uint32_t len);
+
+    // a DMA read of the spm line is on its way
+    bool dma_in_flight(uint64_t line_addr) const {
+        return inflight_dma_addr_size.count(line_addr) != 0;
+    }
 
     // prefetching-related
     void add_rd_var_log_entry(uint32_t addr, uint32_t size);
-    void log_req_issue(uint32_t addr);
     void generate_prefetch_request();
+
+    // FIFOs, in-flight reads and the prefetcher, for checkpoints
+    void save(VerilatedSerialize &os) const;
+    void restore(VerilatedDeserialize &is);
 };
 #endif
@@ -0,0 +1,238 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __NVDLA_CHECKPOINT_HH__
+#define __NVDLA_CHECKPOINT_HH__
+
+#include <cstdint>
+#include <deque>
+#include <list>
+#include <map>
+#include <queue>
+#include <string>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "verilated_save.h"
+
+// Helpers to write the C++ side of the model (AXI queues, CSB
+// operations, scratchpad) next to the Verilated state in the same
+// VerilatedSave file. Plain structs are stored as raw bytes, so a
+// checkpoint can only be restored by the same build of the model.
+
+template <class T> void ckpt_save(VerilatedSerialize &os, const T &v);
+template <class T> void ckpt_restore(VerilatedDeserialize &is, T &v);
+
+template <class A, class B>
+void ckpt_save(VerilatedSerialize &os, const std::pair<A, B> &v);
+template <class A, class B>
+void ckpt_restore(VerilatedDeserialize &is, std::pair<A, B> &v);
+template <class A, class B, class C>
+void ckpt_save(VerilatedSerialize &os, const std::tuple<A, B, C> &v);
+template <class A, class B, class C>
+void ckpt_restore(VerilatedDeserialize &is, std::tuple<A, B, C> &v);
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::vector<T> &v);
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::vector<T> &v);
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::deque<T> &v);
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::deque<T> &v);
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::list<T> &v);
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::list<T> &v);
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::queue<T> &v);
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::queue<T> &v);
+template <class K, class V>
+void ckpt_save(VerilatedSerialize &os, const std::map<K, V> &v);
+template <class K, class V>
+void ckpt_restore(VerilatedDeserialize &is, std::map<K, V> &v);
+template <class K, class V>
+void ckpt_save(VerilatedSerialize &os, const std::unordered_map<K, V> &v);
+template <class K, class V>
+void ckpt_restore(VerilatedDeserialize &is, std::unordered_map<K, V> &v);
+
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const T &v) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only plain data can be stored as raw bytes");
+    os.write(&v, sizeof(T));
+}
+
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, T &v) {
+    static_assert(std::is_trivially_copyable<T>::value,
+                  "only plain data can be stored as raw bytes");
+    is.read(&v, sizeof(T));
+}
+
+template <class A, class B>
+void ckpt_save(VerilatedSerialize &os, const std::pair<A, B> &v) {
+    ckpt_save(os, v.first);
+    ckpt_save(os, v.second);
+}
+
+template <class A, class B>
+void ckpt_restore(VerilatedDeserialize &is, std::pair<A, B> &v) {
+    ckpt_restore(is, v.first);
+    ckpt_restore(is, v.second);
+}
+
+template <class A, class B, class C>
+void ckpt_save(VerilatedSerialize &os, const std::tuple<A, B, C> &v) {
+    ckpt_save(os, std::get<0>(v));
+    ckpt_save(os, std::get<1>(v));
+    ckpt_save(os, std::get<2>(v));
+}
+
+template <class A, class B, class C>
+void ckpt_restore(VerilatedDeserialize &is, std::tuple<A, B, C> &v) {
+    ckpt_restore(is, std::get<0>(v));
+    ckpt_restore(is, std::get<1>(v));
+    ckpt_restore(is, std::get<2>(v));
+}
+
+// sequences are stored as their size followed by the elements
+template <class Seq>
+void ckpt_save_seq(VerilatedSerialize &os, const Seq &v) {
+    uint64_t n = v.size();
+    ckpt_save(os, n);
+    for (const auto &e : v)
+        ckpt_save(os, e);
+}
+
+template <class Seq>
+void ckpt_restore_seq(VerilatedDeserialize &is, Seq &v) {
+    uint64_t n;
+    ckpt_restore(is, n);
+    v.clear();
+    for (uint64_t i = 0; i < n; i++) {
+        typename Seq::value_type e;
+        ckpt_restore(is, e);
+        v.push_back(std::move(e));
+    }
+}
+
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::vector<T> &v) {
+    ckpt_save_seq(os, v);
+}
+
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::vector<T> &v) {
+    ckpt_restore_seq(is, v);
+}
+
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::deque<T> &v) {
+    ckpt_save_seq(os, v);
+}
+
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::deque<T> &v) {
+    ckpt_restore_seq(is, v);
+}
+
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::list<T> &v) {
+    ckpt_save_seq(os, v);
+}
+
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::list<T> &v) {
+    ckpt_restore_seq(is, v);
+}
+
+template <class T>
+void ckpt_save(VerilatedSerialize &os, const std::queue<T> &v) {
+    // std::queue hides its container, walk a copy
+    std::deque<T> elems;
+    for (std::queue<T> q = v; !q.empty(); q.pop())
+        elems.push_back(q.front());
+    ckpt_save_seq(os, elems);
+}
+
+template <class T>
+void ckpt_restore(VerilatedDeserialize &is, std::queue<T> &v) {
+    std::deque<T> elems;
+    ckpt_restore_seq(is, elems);
+    v = std::queue<T>(std::move(elems));
+}
+
+template <class K, class V>
+void ckpt_save(VerilatedSerialize &os, const std::map<K, V> &v) {
+    uint64_t n = v.size();
+    ckpt_save(os, n);
+    for (const auto &e : v) {
+        ckpt_save(os, e.first);
+        ckpt_save(os, e.second);
+    }
+}
+
+template <class K, class V>
+void ckpt_restore(VerilatedDeserialize &is, std::map<K, V> &v) {
+    uint64_t n;
+    ckpt_restore(is, n);
+    v.clear();
+    for (uint64_t i = 0; i < n; i++) {
+        K k;
+        ckpt_restore(is, k);
+        ckpt_restore(is, v[k]);
+    }
+}
+
+template <class K, class V>
+void ckpt_save(VerilatedSerialize &os, const std::unordered_map<K, V> &v) {
+    uint64_t n = v.size();
+    ckpt_save(os, n);
+    for (const auto &e : v) {
+        ckpt_save(os, e.first);
+        ckpt_save(os, e.second);
+    }
+}
+
+template <class K, class V>
+void ckpt_restore(VerilatedDeserialize &is, std::unordered_map<K, V> &v) {
+    uint64_t n;
+    ckpt_restore(is, n);
+    v.clear();
+    for (uint64_t i = 0; i < n; i++) {
+        K k;
+        ckpt_restore(is, k);
+        ckpt_restore(is, v[k]);
+    }
+}
+
+#endif // __NVDLA_CHECKPOINT_HH__
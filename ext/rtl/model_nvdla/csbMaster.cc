@@ -1,4 +1,5 @@
 #include "csbMaster.hh"
+#include "checkpoint.hh"
 
 CSBMaster::CSBMaster(VNV_nvdla *_dla, Wrapper_nvdla *_wrapper) {
     dla = _dla;
@@ -128,6 +129,8 @@ int CSBMaster::eval(int noop) {
         dla->csb2nvdla_nposted = 0;
         printf("(%lu) write to nvdla: addr %08x, data %08x\n",
                 wrapper->tickcount, op.addr, op.data);
+        if (wrapper->tracer)
+            wrapper->tracer->csbWrite(op.addr, wrapper->tickcount);
         opq.pop();
     } else {
         dla->csb2nvdla_valid = 1;
@@ -147,6 +150,30 @@ bool CSBMaster::done() {
     return opq.empty();
 }
 
+bool CSBMaster::idle(int noop) {
+    if (opq.empty())
+        return true;
+    const csb_op &op = opq.front();
+    return noop && (op.is_ext || op.write || !op.reading);
+}
+
+bool CSBMaster::programming() const {
+    if (opq.empty())
+        return false;
+    const csb_op &op = opq.front();
+    return !op.is_ext && !op.wait_until;
+}
+
 int CSBMaster::test_passed() {
     return _test_passed;
 }
+
+void CSBMaster::save(VerilatedSerialize &os) const {
+    ckpt_save(os, opq);
+    ckpt_save(os, _test_passed);
+}
+
+void CSBMaster::restore(VerilatedDeserialize &is) {
+    ckpt_restore(is, opq);
+    ckpt_restore(is, _test_passed);
+}
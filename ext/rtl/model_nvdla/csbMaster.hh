@@ -50,6 +50,20 @@ public:
 
     bool done();
 
+    // operations queued and not completed yet
+    size_t pending() { return opq.size(); }
+
+    // eval(noop) would neither drive nor sample the csb interface
+    bool idle(int noop);
+
+    // the front operation programs a register, it does not wait for
+    // the hardware to finish a layer
+    bool programming() const;
+
     int test_passed(); 
+
+    // queued operations, for checkpoints
+    void save(VerilatedSerialize &os) const;
+    void restore(VerilatedDeserialize &is);
 };
 #endif // __CSB_MASTER__
@@ -0,0 +1,293 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __INFLIGHT_TABLE_HH__
+#define __INFLIGHT_TABLE_HH__
+
+#include <cassert>
+#include <cstdint>
+#include <vector>
+
+// Table of read transactions waiting to be returned to NVDLA.
+//
+// Transactions live in a ring of slots kept in issue order, so the
+// oldest one is always at the head and retiring in order is O(1).
+// Transactions still waiting for their data are also chained per
+// address, and the head of every chain is found through an
+// open-addressed hash table, so a response coming back from memory
+// finds its transaction in O(1) too.
+//
+// Slots can be removed out of order (prefetches are dropped when their
+// data arrives), they are just marked as dead and reclaimed when the
+// head reaches them. The ring is sized at construction for the maximum
+// number of outstanding requests; it only grows if that is exceeded,
+// e.g. when a whole output tensor is read back for verification.
+template <class Txn>
+class InflightTable {
+private:
+    struct Slot {
+        Txn txn;
+        uint32_t addr;
+        bool live;
+        bool pending;
+        bool prefetch;
+        int32_t prev_pending;
+        int32_t next_pending;
+    };
+
+    struct Bucket {
+        uint32_t addr;
+        bool used;
+        int32_t first;
+        int32_t last;
+    };
+
+    std::vector<Slot> slots;
+    uint64_t slot_mask;
+
+    // sequence numbers, the slot is seq & slot_mask
+    uint64_t head;
+    uint64_t tail;
+    uint64_t demand;
+    uint32_t live;
+
+    std::vector<Bucket> buckets;
+    uint64_t bucket_mask;
+
+    static uint64_t
+    pow2(uint64_t n) {
+        uint64_t p = 1;
+        while (p < n)
+            p <<= 1;
+        return p;
+    }
+
+    uint64_t
+    home(uint32_t addr) const {
+        // requests are line aligned, drop the offset before hashing
+        return ((uint64_t)(addr >> 6) * 2654435761u) & bucket_mask;
+    }
+
+    int64_t
+    find_bucket(uint32_t addr) const {
+        for (uint64_t b = home(addr); buckets[b].used; b = (b + 1) & bucket_mask) {
+            if (buckets[b].addr == addr)
+                return b;
+        }
+        return -1;
+    }
+
+    Bucket &
+    get_bucket(uint32_t addr) {
+        uint64_t b = home(addr);
+        while (buckets[b].used && buckets[b].addr != addr)
+            b = (b + 1) & bucket_mask;
+        if (!buckets[b].used) {
+            buckets[b].used = true;
+            buckets[b].addr = addr;
+            buckets[b].first = -1;
+            buckets[b].last = -1;
+        }
+        return buckets[b];
+    }
+
+    // backward shift deletion, keeps probe sequences without tombstones
+    void
+    erase_bucket(uint64_t b) {
+        uint64_t j = b;
+        while (true) {
+            j = (j + 1) & bucket_mask;
+            if (!buckets[j].used)
+                break;
+            uint64_t k = home(buckets[j].addr);
+            bool movable = (j > b) ? (k <= b || k > j) : (k <= b && k > j);
+            if (movable) {
+                buckets[b] = buckets[j];
+                b = j;
+            }
+        }
+        buckets[b].used = false;
+    }
+
+    void
+    chain_append(uint32_t idx) {
+        Slot &s = slots[idx];
+        Bucket &b = get_bucket(s.addr);
+        s.prev_pending = b.last;
+        s.next_pending = -1;
+        if (b.last >= 0)
+            slots[b.last].next_pending = idx;
+        else
+            b.first = idx;
+        b.last = idx;
+        s.pending = true;
+    }
+
+    void
+    chain_remove(uint32_t idx) {
+        Slot &s = slots[idx];
+        int64_t bi = find_bucket(s.addr);
+        assert(bi >= 0);
+        Bucket &b = buckets[bi];
+        if (s.prev_pending >= 0)
+            slots[s.prev_pending].next_pending = s.next_pending;
+        else
+            b.first = s.next_pending;
+        if (s.next_pending >= 0)
+            slots[s.next_pending].prev_pending = s.prev_pending;
+        else
+            b.last = s.prev_pending;
+        s.pending = false;
+        if (b.first < 0)
+            erase_bucket(bi);
+    }
+
+    void
+    resize(uint64_t capacity) {
+        std::vector<Slot> old;
+        old.swap(slots);
+        uint64_t old_head = head, old_tail = tail, old_mask = slot_mask;
+
+        slots.resize(pow2(capacity));
+        slot_mask = slots.size() - 1;
+        buckets.assign(2 * slots.size(), Bucket());
+        bucket_mask = buckets.size() - 1;
+        head = tail = demand = 0;
+        live = 0;
+
+        // re-insert in issue order so the pending chains keep their order
+        for (uint64_t seq = old_head; seq < old_tail; seq++) {
+            Slot &s = old[seq & old_mask];
+            if (s.live)
+                push(s.addr, s.txn, s.pending, s.prefetch);
+        }
+    }
+
+public:
+    explicit InflightTable(uint32_t capacity = 256)
+        : slot_mask(0), head(0), tail(0), demand(0), live(0), bucket_mask(0) {
+        resize(capacity);
+    }
+
+    uint32_t size() const { return live; }
+    bool empty() const { return live == 0; }
+    uint64_t capacity() const { return slots.size(); }
+
+    // Add a transaction at the end of the issue order. Pending ones are
+    // waiting for data and can be found with find_pending().
+    void
+    push(uint32_t addr, const Txn &txn, bool pending, bool prefetch) {
+        if (tail - head == slots.size())
+            resize(2 * slots.size());
+
+        uint32_t idx = tail & slot_mask;
+        Slot &s = slots[idx];
+        s.txn = txn;
+        s.addr = addr;
+        s.live = true;
+        s.pending = false;
+        s.prefetch = prefetch;
+        tail++;
+        live++;
+        if (pending)
+            chain_append(idx);
+    }
+
+    // Oldest transaction in the table
+    uint32_t front() const { assert(live); return head & slot_mask; }
+
+    // Oldest transaction that is not a prefetch, -1 if there is none
+    int32_t
+    first_demand() {
+        if (demand < head)
+            demand = head;
+        while (demand < tail &&
+               (!slots[demand & slot_mask].live || slots[demand & slot_mask].prefetch))
+            demand++;
+        return demand < tail ? (int32_t)(demand & slot_mask) : -1;
+    }
+
+    // Oldest transaction still waiting for data from addr, -1 if none
+    int32_t
+    find_pending(uint32_t addr) const {
+        int64_t b = find_bucket(addr);
+        return b >= 0 ? buckets[b].first : -1;
+    }
+
+    Txn &txn(uint32_t idx) { return slots[idx].txn; }
+    uint32_t addr(uint32_t idx) const { return slots[idx].addr; }
+
+    // The data of this transaction is available, stop looking it up
+    void
+    fill(uint32_t idx) {
+        if (slots[idx].pending)
+            chain_remove(idx);
+    }
+
+    // Remove a transaction, from any position
+    void
+    retire(uint32_t idx) {
+        Slot &s = slots[idx];
+        assert(s.live);
+        if (s.pending)
+            chain_remove(idx);
+        s.live = false;
+        live--;
+        while (head < tail && !slots[head & slot_mask].live)
+            head++;
+    }
+
+    // Checkpoint the whole table, with the helpers of checkpoint.hh
+    template <class Out>
+    void
+    save(Out &os) const {
+        ckpt_save(os, slots);
+        ckpt_save(os, slot_mask);
+        ckpt_save(os, head);
+        ckpt_save(os, tail);
+        ckpt_save(os, demand);
+        ckpt_save(os, live);
+        ckpt_save(os, buckets);
+        ckpt_save(os, bucket_mask);
+    }
+
+    template <class In>
+    void
+    restore(In &is) {
+        ckpt_restore(is, slots);
+        ckpt_restore(is, slot_mask);
+        ckpt_restore(is, head);
+        ckpt_restore(is, tail);
+        ckpt_restore(is, demand);
+        ckpt_restore(is, live);
+        ckpt_restore(is, buckets);
+        ckpt_restore(is, bucket_mask);
+    }
+};
+
+#endif
@@ -0,0 +1,199 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Cycles/s of the AXIResponder read path with the in-flight table
+// against the previous std::map + std::list bookkeeping.
+//
+// Every cycle NVDLA issues a burst while there is room in the window,
+// memory answers each beat after a random latency (so responses come
+// back out of order), and at most one beat is retired in order, as
+// AXIResponder::eval_timing does.
+//
+// usage: inflight_bench [cycles]
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <list>
+#include <map>
+#include <queue>
+#include <random>
+#include <vector>
+
+#include "inflightTable.hh"
+
+#define AXI_WIDTH 512
+
+struct axi_r_txn {
+    int rvalid;
+    int rlast;
+    uint32_t rdata[AXI_WIDTH / 32];
+    uint8_t rid;
+    uint8_t is_prefetch;
+};
+
+class MapTracker {
+    std::map<uint32_t, std::list<axi_r_txn>> inflight_req;
+    std::list<uint32_t> inflight_req_order;
+
+public:
+    uint32_t size() const { return inflight_req_order.size(); }
+
+    void
+    push(uint32_t addr, const axi_r_txn &txn) {
+        inflight_req[addr].push_back(txn);
+        inflight_req_order.push_back(addr);
+    }
+
+    void
+    resp(uint32_t addr, const uint32_t *data) {
+        auto it = inflight_req[addr].begin();
+        while (it != inflight_req[addr].end() && it->rvalid)
+            it++;
+        for (int i = 0; i < AXI_WIDTH / 32; i++)
+            it->rdata[i] = data[i];
+        it->rvalid = 1;
+    }
+
+    bool
+    retire(uint32_t &addr) {
+        if (inflight_req_order.empty())
+            return false;
+        addr = inflight_req_order.front();
+        if (!inflight_req[addr].front().rvalid)
+            return false;
+        inflight_req[addr].pop_front();
+        if (inflight_req[addr].empty())
+            inflight_req.erase(addr);
+        inflight_req_order.pop_front();
+        return true;
+    }
+};
+
+class TableTracker {
+    InflightTable<axi_r_txn> inflight_req;
+
+public:
+    explicit TableTracker(uint32_t window) : inflight_req(window + 256) {}
+
+    uint32_t size() const { return inflight_req.size(); }
+
+    void
+    push(uint32_t addr, const axi_r_txn &txn) {
+        inflight_req.push(addr, txn, true, false);
+    }
+
+    void
+    resp(uint32_t addr, const uint32_t *data) {
+        int32_t slot = inflight_req.find_pending(addr);
+        axi_r_txn &txn = inflight_req.txn(slot);
+        for (int i = 0; i < AXI_WIDTH / 32; i++)
+            txn.rdata[i] = data[i];
+        txn.rvalid = 1;
+        inflight_req.fill(slot);
+    }
+
+    bool
+    retire(uint32_t &addr) {
+        int32_t slot = inflight_req.first_demand();
+        if (slot < 0 || !inflight_req.txn(slot).rvalid)
+            return false;
+        addr = inflight_req.addr(slot);
+        inflight_req.retire(slot);
+        return true;
+    }
+};
+
+struct Resp {
+    uint64_t cycle;
+    uint32_t addr;
+    bool operator>(const Resp &o) const { return cycle > o.cycle; }
+};
+
+template <class Tracker>
+static double
+run(Tracker &tracker, uint32_t window, uint64_t cycles, uint64_t &checksum) {
+    std::mt19937 rng(1);
+    std::priority_queue<Resp, std::vector<Resp>, std::greater<Resp>> mem;
+    uint32_t data[AXI_WIDTH / 32] = {0};
+    uint32_t addr = 0x80000000;
+    checksum = 0;
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint64_t cycle = 0; cycle < cycles; cycle++) {
+        // issue, weights are re-read every 4K so addresses repeat
+        if (tracker.size() <= window) {
+            uint32_t len = rng() % 4;
+            for (uint32_t j = 0; j <= len; j++) {
+                axi_r_txn txn;
+                txn.rvalid = 0;
+                txn.rlast = (j == len);
+                txn.rid = 0;
+                txn.is_prefetch = 0;
+                tracker.push(addr, txn);
+                mem.push({cycle + 20 + rng() % 100, addr});
+                addr = 0x80000000 + ((addr + AXI_WIDTH / 8) & 0xfff);
+            }
+        }
+
+        while (!mem.empty() && mem.top().cycle <= cycle) {
+            tracker.resp(mem.top().addr, data);
+            mem.pop();
+        }
+
+        uint32_t done;
+        if (tracker.retire(done))
+            checksum = checksum * 31 + done;
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    return cycles / std::chrono::duration<double>(stop - start).count();
+}
+
+int
+main(int argc, char **argv) {
+    uint64_t cycles = argc > 1 ? strtoull(argv[1], NULL, 0) : 2000000;
+    const uint32_t windows[] = {4, 32, 128};
+
+    printf("%-12s %16s %16s %8s\n", "outstanding", "map cycles/s",
+           "table cycles/s", "speedup");
+    for (uint32_t window : windows) {
+        uint64_t map_sum, table_sum;
+        MapTracker map_tracker;
+        TableTracker table_tracker(window);
+        double map_rate = run(map_tracker, window, cycles, map_sum);
+        double table_rate = run(table_tracker, window, cycles, table_sum);
+        if (map_sum != table_sum) {
+            printf("outstanding %u: retire order differs\n", window);
+            return 1;
+        }
+        printf("%-12u %16.0f %16.0f %7.2fx\n", window, map_rate,
+               table_rate, table_rate / map_rate);
+    }
+    return 0;
+}
@@ -11,6 +11,7 @@
 #include <stdio.h>
 #include <fcntl.h>
 
+#include <chrono>
 #include <queue>
 #include <map>
 #include <vector>
@@ -802,6 +803,8 @@ int main(int argc, const char **argv, char **env) {
 	}
 
 	printf("running trace...\n");
+	uint64_t start_ticks = ticks;
+	auto start = std::chrono::steady_clock::now();
 	uint32_t quiesc_timer = 200;
 	int waiting = 0;
 	while (!csb->done() || (quiesc_timer--)) {
@@ -843,6 +846,11 @@ int main(int argc, const char **argv, char **env) {
 	
 	printf("done at %lu ticks\n", ticks);
 
+	// two ticks per clock cycle
+	double secs = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	printf("rtl: %lu cycles in %.2f s, %.0f cycles/s\n", (ticks - start_ticks) / 2, secs,
+	       (ticks - start_ticks) / 2 / secs);
+
 	if (!trace->test_passed()) {
 		printf("*** FAIL: test failed due to output mismatch\n");
 		return 1;
@@ -0,0 +1,355 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "scratchpad.hh"
+#include "checkpoint.hh"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+
+Scratchpad::Scratchpad(uint32_t _line_size, uint32_t _line_num, uint32_t _assoc,
+                       int _policy, WritebackQueue &_writeback,
+                       bool _eager_writeback) :
+        line_size(_line_size),
+        line_num(_line_num),
+        assoc((_assoc == 0 || _assoc > _line_num) ? _line_num : _assoc),
+        sets(line_num / assoc),
+        policy(_policy),
+        eager_writeback(_eager_writeback),
+        hits(0),
+        misses(0),
+        evictions(0),
+        writebacks(0),
+        write_arounds(0),
+        writeback(_writeback),
+        words_per_line((_line_size + 63) / 64),
+        clock(0),
+        rng(1) {
+    if ((line_size & (line_size - 1)) != 0 || line_num % assoc != 0) {
+        printf("spm: line size (%u) must be a power of 2 and line num (%u) a multiple of assoc (%u)\n",
+               line_size, line_num, assoc);
+        abort();
+    }
+    data.resize((uint64_t)line_size * line_num, 0);
+    tags.resize(line_num, Tag());
+    dirty_mask.resize((uint64_t)line_num * words_per_line, 0);
+    written_mask.resize((uint64_t)line_num * words_per_line, 0);
+}
+
+uint32_t
+Scratchpad::set_of(uint64_t line_addr) const {
+    return (line_addr / line_size) % sets;
+}
+
+int
+Scratchpad::find(uint64_t line_addr) const {
+    int base = set_of(line_addr) * assoc;
+    for (int w = base; w < base + (int)assoc; w++) {
+        if (tags[w].valid && tags[w].line_addr == line_addr)
+            return w;
+    }
+    return -1;
+}
+
+void
+Scratchpad::evict(int way) {
+    Tag &t = tags[way];
+    if (!t.valid)
+        return;
+    evictions++;
+    if (t.dirty)
+        write_back(way);
+    t.valid = 0;
+}
+
+void
+Scratchpad::write_back(int way) {
+    Tag &t = tags[way];
+    uint64_t *bits = dirty_bits(way);
+    const uint8_t *src = line(way);
+
+    if (t.filled == line_size) {
+        // every byte is known, a single transfer for the whole line
+        writeback.push(std::make_pair(t.line_addr, std::vector<uint8_t>(src, src + line_size)));
+    } else {
+        // the bytes not written were never fetched, send the dirty runs only
+        uint32_t i = 0;
+        while (i < line_size) {
+            if (bits[i / 64] == 0 && i % 64 == 0) {
+                i += 64;
+                continue;
+            }
+            if (!((bits[i / 64] >> (i % 64)) & 1)) {
+                i++;
+                continue;
+            }
+            uint32_t start = i;
+            while (i < line_size && ((bits[i / 64] >> (i % 64)) & 1))
+                i++;
+            writeback.push(std::make_pair(t.line_addr + start,
+                                          std::vector<uint8_t>(src + start, src + i)));
+        }
+    }
+    writebacks++;
+
+    memset(bits, 0, words_per_line * sizeof(uint64_t));
+    t.dirty = 0;
+}
+
+void
+Scratchpad::write_around(uint64_t addr, const uint8_t *buf, uint32_t len, uint64_t mask) {
+    uint32_t i = 0;
+    while (i < len) {
+        if (!((mask >> i) & 1)) {
+            i++;
+            continue;
+        }
+        uint32_t start = i;
+        while (i < len && ((mask >> i) & 1))
+            i++;
+        writeback.push(std::make_pair(addr + start,
+                                      std::vector<uint8_t>(buf + start, buf + i)));
+    }
+    write_arounds++;
+}
+
+bool
+Scratchpad::valid_range(int way, uint32_t offset, uint32_t len) const {
+    const Tag &t = tags[way];
+    if (offset + len <= t.filled)
+        return true;
+    if (!t.written)
+        return false;
+    const uint64_t *bits = written_bits(way);
+    for (uint32_t i = std::max(offset, t.filled); i < offset + len; i++) {
+        if (!((bits[i / 64] >> (i % 64)) & 1))
+            return false;
+    }
+    return true;
+}
+
+int
+Scratchpad::allocate(uint64_t line_addr) {
+    int base = set_of(line_addr) * assoc;
+    int victim = -1;
+
+    // free way first, then prefer clean lines that are not being filled
+    for (int w = base; w < base + (int)assoc && victim < 0; w++) {
+        if (!tags[w].valid)
+            victim = w;
+    }
+    for (int pass = 0; pass < 2 && victim < 0; pass++) {
+        if (policy == REPL_RANDOM) {
+            int w = base + rng() % assoc;
+            if (pass == 1 || (!tags[w].dirty && tags[w].filled == line_size))
+                victim = w;
+            continue;
+        }
+        for (int w = base; w < base + (int)assoc; w++) {
+            if (pass == 0 && (tags[w].dirty || tags[w].filled != line_size))
+                continue;
+            if (victim < 0 || tags[w].stamp < tags[victim].stamp)
+                victim = w;
+        }
+    }
+
+    evict(victim);
+
+    Tag &t = tags[victim];
+    t.line_addr = line_addr;
+    t.stamp = clock++;
+    t.filled = 0;
+    t.written = 0;
+    t.valid = 1;
+    memset(written_bits(victim), 0, words_per_line * sizeof(uint64_t));
+    return victim;
+}
+
+bool
+Scratchpad::contains(uint64_t addr, uint32_t len) const {
+    uint64_t line_addr = addr & ~(uint64_t)(line_size - 1);
+    int way = find(line_addr);
+    return way >= 0 && valid_range(way, addr - line_addr, len);
+}
+
+bool
+Scratchpad::read(uint64_t addr, uint8_t *buf, uint32_t len, bool count) {
+    uint64_t line_addr = addr & ~(uint64_t)(line_size - 1);
+    uint32_t offset = addr - line_addr;
+    assert(offset + len <= line_size);
+
+    int way = find(line_addr);
+    if (way < 0 || !valid_range(way, offset, len)) {
+        if (count)
+            misses++;
+        return false;
+    }
+    if (count)
+        hits++;
+    if (policy == REPL_LRU)
+        tags[way].stamp = clock++;
+    memcpy(buf, line(way) + offset, len);
+    return true;
+}
+
+void
+Scratchpad::write(uint64_t addr, const uint8_t *buf, uint32_t len, uint64_t mask,
+                  bool alloc) {
+    uint64_t line_addr = addr & ~(uint64_t)(line_size - 1);
+    uint32_t offset = addr - line_addr;
+    assert(offset + len <= line_size && len <= 64);
+    if (len < 64)
+        mask &= ((uint64_t)1 << len) - 1;
+
+    int way = find(line_addr);
+    if (way < 0) {
+        if (!alloc) {
+            write_around(addr, buf, len, mask);
+            return;
+        }
+        // no fetch on write, only the bytes written become valid
+        way = allocate(line_addr);
+    } else if (policy == REPL_LRU) {
+        tags[way].stamp = clock++;
+    }
+
+    uint8_t *dst = line(way) + offset;
+    if (len == 64 && mask == ~(uint64_t)0) {
+        memcpy(dst, buf, len);
+    } else {
+        for (uint32_t i = 0; i < len; i++) {
+            if ((mask >> i) & 1)
+                dst[i] = buf[i];
+        }
+    }
+
+    Tag &t = tags[way];
+    t.dirty += set_bits(dirty_bits(way), offset, mask);
+    t.written += set_bits(written_bits(way), offset, mask);
+
+    // nothing left to fetch, a fill still in flight is dropped
+    if (t.written == line_size)
+        t.filled = line_size;
+    if (t.dirty == line_size && eager_writeback)
+        write_back(way);
+}
+
+uint32_t
+Scratchpad::set_bits(uint64_t *bits, uint32_t offset, uint64_t mask) {
+    // the written bytes span at most two words of the mask
+    uint32_t w = offset / 64;
+    uint32_t shift = offset % 64;
+    uint64_t lo = mask << shift;
+    uint32_t set = __builtin_popcountll(lo & ~bits[w]);
+    bits[w] |= lo;
+    if (shift) {
+        uint64_t hi = mask >> (64 - shift);
+        if (hi) {
+            set += __builtin_popcountll(hi & ~bits[w + 1]);
+            bits[w + 1] |= hi;
+        }
+    }
+    return set;
+}
+
+void
+Scratchpad::fill(uint64_t line_addr, uint32_t offset, const uint8_t *buf, uint32_t len) {
+    int way = find(line_addr);
+    if (offset == 0) {
+        if (way < 0)
+            way = allocate(line_addr);
+        else if (tags[way].written == line_size)
+            return;
+        tags[way].filled = 0;
+    } else if (way < 0 || tags[way].filled != offset) {
+        // the line was evicted while it was being filled, drop the rest
+        return;
+    }
+    assert(offset + len <= line_size);
+    Tag &t = tags[way];
+    if (!t.written) {
+        memcpy(line(way) + offset, buf, len);
+    } else {
+        // memory is older than the bytes NVDLA wrote, even the ones
+        // already written back: the read may have been issued before
+        const uint64_t *bits = written_bits(way);
+        uint8_t *dst = line(way);
+        for (uint32_t i = offset; i < offset + len; i++) {
+            if (!((bits[i / 64] >> (i % 64)) & 1))
+                dst[i] = buf[i - offset];
+        }
+    }
+    t.filled = offset + len;
+}
+
+void
+Scratchpad::flush(uint64_t region_mask, uint64_t region) {
+    for (uint32_t w = 0; w < line_num; w++) {
+        Tag &t = tags[w];
+        if (!t.valid)
+            continue;
+        if (t.dirty)
+            write_back(w);
+        if ((t.line_addr & region_mask) == region)
+            t.valid = 0;
+    }
+}
+
+void
+Scratchpad::save(VerilatedSerialize &os) const {
+    ckpt_save(os, data);
+    ckpt_save(os, tags);
+    ckpt_save(os, dirty_mask);
+    ckpt_save(os, written_mask);
+    ckpt_save(os, clock);
+    ckpt_save(os, rng);
+    ckpt_save(os, hits);
+    ckpt_save(os, misses);
+    ckpt_save(os, evictions);
+    ckpt_save(os, writebacks);
+    ckpt_save(os, write_arounds);
+}
+
+void
+Scratchpad::restore(VerilatedDeserialize &is) {
+    ckpt_restore(is, data);
+    ckpt_restore(is, tags);
+    ckpt_restore(is, dirty_mask);
+    ckpt_restore(is, written_mask);
+    ckpt_restore(is, clock);
+    ckpt_restore(is, rng);
+    ckpt_restore(is, hits);
+    ckpt_restore(is, misses);
+    ckpt_restore(is, evictions);
+    ckpt_restore(is, writebacks);
+    ckpt_restore(is, write_arounds);
+    assert(data.size() == (uint64_t)line_num * line_size);
+}
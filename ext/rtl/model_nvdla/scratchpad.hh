@@ -0,0 +1,152 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __SCRATCHPAD_HH__
+#define __SCRATCHPAD_HH__
+
+#include <cstdint>
+#include <queue>
+#include <random>
+#include <vector>
+
+class VerilatedSerialize;
+class VerilatedDeserialize;
+
+// NVDLA private scratchpad.
+//
+// The data of all lines lives in one contiguous buffer of
+// line_num * line_size bytes, organised in sets of assoc ways. A line
+// address maps to a set and is looked up in a small tag array, so
+// accesses are line-granular memcpys instead of per-byte map lookups.
+// Lines filled by DMA become readable as their data arrives.
+//
+// The spm is write-back. Every line keeps a mask of the bytes NVDLA
+// wrote, and only those are written back through the DMA write queue
+// when the line is evicted or flushed. A write miss either allocates
+// the line without fetching it (the written bytes are valid, a read
+// of the others misses and the fill keeps the written bytes) or goes
+// around the spm straight to memory. With eager writeback a line is
+// written back as soon as all of its bytes are dirty, overlapping
+// the transfer with compute instead of leaving it for the flush.
+//
+// Writing a line back cleans it, but a DMA read of the line may have
+// been issued before and bring older data. Lines also keep a mask of
+// the bytes written since they were allocated, which a fill never
+// overwrites.
+class Scratchpad {
+public:
+    enum ReplPolicy {
+        REPL_LRU = 0,
+        REPL_FIFO = 1,
+        REPL_RANDOM = 2
+    };
+
+    typedef std::queue<std::pair<uint64_t, std::vector<uint8_t>>> WritebackQueue;
+
+    Scratchpad(uint32_t line_size, uint32_t line_num, uint32_t assoc,
+               int policy, WritebackQueue &writeback,
+               bool eager_writeback = false);
+
+    // true if bytes [addr, addr + len) are in the spm, without touching stats or replacement state
+    bool contains(uint64_t addr, uint32_t len) const;
+
+    // copy len bytes from the spm, false on miss. The range must not cross a line
+    bool read(uint64_t addr, uint8_t *data, uint32_t len, bool count = true);
+
+    // write the bytes enabled in mask. On a miss the line is allocated,
+    // or with !allocate the bytes are written around the spm
+    void write(uint64_t addr, const uint8_t *data, uint32_t len, uint64_t mask,
+               bool alloc = true);
+
+    // DMA data for a line, in order. offset 0 (re)allocates the line.
+    // Bytes the line has dirty are newer than memory and are kept
+    void fill(uint64_t line_addr, uint32_t offset, const uint8_t *data, uint32_t len);
+
+    // lines, tags, replacement state and stats, for checkpoints
+    void save(VerilatedSerialize &os) const;
+    void restore(VerilatedDeserialize &is);
+
+    // write back the dirty bytes of every line, and invalidate the
+    // lines whose address matches (line_addr & region_mask) == region
+    void flush(uint64_t region_mask, uint64_t region);
+
+    const uint32_t line_size;
+    const uint32_t line_num;
+    const uint32_t assoc;
+    const uint32_t sets;
+    const int policy;
+    const bool eager_writeback;
+
+    // stats
+    uint64_t hits;
+    uint64_t misses;
+    uint64_t evictions;
+    uint64_t writebacks;
+    uint64_t write_arounds;
+
+private:
+    struct Tag {
+        uint64_t line_addr;
+        uint64_t stamp;     // last use (LRU) or allocation (FIFO)
+        uint32_t filled;    // bytes valid from the start of the line
+        uint32_t dirty;     // bytes set in the dirty mask
+        uint32_t written;   // bytes set in the written mask
+        uint8_t valid;
+    };
+
+    std::vector<uint8_t> data;
+    std::vector<Tag> tags;
+    // a bit per byte, words_per_line words per line
+    std::vector<uint64_t> dirty_mask;
+    // same layout, bytes written since allocation, even if written back
+    std::vector<uint64_t> written_mask;
+    const uint32_t words_per_line;
+    WritebackQueue &writeback;
+    uint64_t clock;
+    std::mt19937 rng;
+
+    uint32_t set_of(uint64_t line_addr) const;
+    int find(uint64_t line_addr) const;
+    int allocate(uint64_t line_addr);
+    void evict(int way);
+    // push the dirty bytes of a line to the write queue and clean it
+    void write_back(int way);
+    // write the bytes enabled in mask straight to memory
+    void write_around(uint64_t addr, const uint8_t *buf, uint32_t len, uint64_t mask);
+    // bytes [offset, offset + len) are valid: filled or written
+    bool valid_range(int way, uint32_t offset, uint32_t len) const;
+    // set the bits of mask at byte offset, returns how many were clear
+    static uint32_t set_bits(uint64_t *bits, uint32_t offset, uint64_t mask);
+    uint8_t *line(int way) { return &data[(uint64_t)way * line_size]; }
+    uint64_t *dirty_bits(int way) { return &dirty_mask[(uint64_t)way * words_per_line]; }
+    const uint64_t *dirty_bits(int way) const { return &dirty_mask[(uint64_t)way * words_per_line]; }
+    uint64_t *written_bits(int way) { return &written_mask[(uint64_t)way * words_per_line]; }
+    const uint64_t *written_bits(int way) const { return &written_mask[(uint64_t)way * words_per_line]; }
+};
+
+#endif // __SCRATCHPAD_HH__
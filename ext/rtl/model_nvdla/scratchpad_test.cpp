@@ -0,0 +1,269 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+// Unit checks of the NVDLA scratchpad: hits and misses, the victim
+// each replacement policy picks, the dirty runs written back from
+// partially written lines and writes around the spm.
+//
+// usage: scratchpad_test
+
+#include <cstdio>
+#include <cstring>
+#include <set>
+#include <vector>
+
+#include "scratchpad.hh"
+
+static int failures = 0;
+
+#define CHECK(cond) \
+    do { \
+        if (!(cond)) { \
+            printf("%s:%d: check failed: %s\n", __FILE__, __LINE__, #cond); \
+            failures++; \
+        } \
+    } while (0)
+
+static const uint32_t LINE = 128;
+
+// bring a whole line in through the DMA, two beats of 64 bytes
+static void
+fill_line(Scratchpad &spm, uint64_t line_addr, uint8_t value) {
+    uint8_t buf[64];
+    memset(buf, value, sizeof(buf));
+    spm.fill(line_addr, 0, buf, 64);
+    spm.fill(line_addr, 64, buf, 64);
+}
+
+static void
+test_hit_miss() {
+    Scratchpad::WritebackQueue wb;
+    Scratchpad spm(LINE, 4, 2, Scratchpad::REPL_LRU, wb);
+    uint8_t buf[64];
+
+    CHECK(!spm.read(0x1000, buf, 64));
+    CHECK(spm.misses == 1 && spm.hits == 0);
+
+    // readable as the data arrives, the second half is not there yet
+    memset(buf, 0x5a, 64);
+    spm.fill(0x1000, 0, buf, 64);
+    CHECK(spm.contains(0x1000, 64));
+    CHECK(!spm.contains(0x1040, 64));
+    CHECK(!spm.read(0x1040, buf, 64));
+    CHECK(spm.misses == 2);
+
+    spm.fill(0x1000, 64, buf, 64);
+    memset(buf, 0, 64);
+    CHECK(spm.read(0x1040, buf, 64));
+    CHECK(buf[0] == 0x5a && buf[63] == 0x5a);
+    CHECK(spm.hits == 1);
+
+    // contains does not count
+    CHECK(spm.contains(0x1000, LINE));
+    CHECK(spm.hits == 1 && spm.misses == 2);
+    CHECK(wb.empty());
+}
+
+// one set of two ways: lines A and B, then C replaces one of them
+static void
+test_lru_fifo() {
+    for (int policy : {Scratchpad::REPL_LRU, Scratchpad::REPL_FIFO}) {
+        Scratchpad::WritebackQueue wb;
+        Scratchpad spm(LINE, 2, 2, policy, wb);
+        uint8_t buf[64];
+
+        fill_line(spm, 0x0000, 0xa);
+        fill_line(spm, 0x1000, 0xb);
+        // A is the oldest allocation but the most recently used
+        CHECK(spm.read(0x0000, buf, 64));
+        fill_line(spm, 0x2000, 0xc);
+
+        CHECK(spm.evictions == 1);
+        CHECK(spm.contains(0x2000, LINE));
+        if (policy == Scratchpad::REPL_LRU) {
+            CHECK(spm.contains(0x0000, LINE));
+            CHECK(!spm.contains(0x1000, 1));
+        } else {
+            CHECK(!spm.contains(0x0000, 1));
+            CHECK(spm.contains(0x1000, LINE));
+        }
+        CHECK(wb.empty());
+    }
+
+    // clean lines go first: the dirty line is older but stays
+    for (int policy : {Scratchpad::REPL_LRU, Scratchpad::REPL_FIFO}) {
+        Scratchpad::WritebackQueue wb;
+        Scratchpad spm(LINE, 2, 2, policy, wb);
+        uint8_t buf[64];
+        memset(buf, 0xd, 64);
+
+        fill_line(spm, 0x0000, 0xa);
+        spm.write(0x0000, buf, 64, ~(uint64_t)0);
+        fill_line(spm, 0x1000, 0xb);
+        fill_line(spm, 0x2000, 0xc);
+
+        CHECK(spm.contains(0x0000, LINE));
+        CHECK(!spm.contains(0x1000, 1));
+        CHECK(wb.empty());
+
+        // only dirty lines left to pick from, the victim is written back.
+        // A is used last, LRU picks C and FIFO the older allocation A
+        spm.write(0x2000, buf, 64, ~(uint64_t)0);
+        CHECK(spm.read(0x0000, buf, 64));
+        fill_line(spm, 0x3000, 0xe);
+        CHECK(spm.evictions == 2);
+        CHECK(spm.writebacks == 1 && wb.size() == 1);
+        uint64_t victim = policy == Scratchpad::REPL_LRU ? 0x2000 : 0x0000;
+        CHECK(!wb.empty() && wb.front().first == victim);
+        CHECK(!spm.contains(victim, 1));
+    }
+}
+
+// the victim is drawn at random, but the same on every run
+static void
+test_random() {
+    Scratchpad::WritebackQueue wb1, wb2;
+    Scratchpad spm1(LINE, 4, 4, Scratchpad::REPL_RANDOM, wb1);
+    Scratchpad spm2(LINE, 4, 4, Scratchpad::REPL_RANDOM, wb2);
+    std::set<uint64_t> evicted;
+
+    for (uint64_t i = 0; i < 64; i++) {
+        uint64_t addr = i * 0x1000;
+        std::vector<uint64_t> before;
+        for (uint64_t j = 0; j < i; j++) {
+            if (spm1.contains(j * 0x1000, 1))
+                before.push_back(j * 0x1000);
+        }
+        fill_line(spm1, addr, i);
+        fill_line(spm2, addr, i);
+
+        unsigned present = 0;
+        for (uint64_t j = 0; j <= i; j++) {
+            bool in = spm1.contains(j * 0x1000, LINE);
+            CHECK(in == spm2.contains(j * 0x1000, LINE));
+            present += in;
+        }
+        CHECK(spm1.contains(addr, LINE));
+        CHECK(present == (i < 4 ? i + 1 : 4));
+        for (uint64_t a : before) {
+            if (!spm1.contains(a, 1))
+                evicted.insert(a);
+        }
+    }
+    CHECK(spm1.evictions == 60 && spm2.evictions == 60);
+    // not always the newest or the oldest line
+    CHECK(evicted.size() == 60);
+    unsigned young = 0;
+    for (uint64_t i = 4; i < 64; i++)
+        young += !spm1.contains(i * 0x1000, 1) && evicted.count(i * 0x1000);
+    CHECK(young > 0 && young < 60);
+}
+
+static void
+test_partial_writeback() {
+    Scratchpad::WritebackQueue wb;
+    Scratchpad spm(LINE, 4, 2, Scratchpad::REPL_LRU, wb);
+    uint8_t buf[64];
+    for (int i = 0; i < 64; i++)
+        buf[i] = i;
+
+    // allocated on the write, never fetched: only the dirty runs go back
+    spm.write(0x1000, buf, 16, 0xff00);
+    spm.write(0x1020, buf, 8, 0xff);
+    // across the two words of the dirty mask
+    spm.write(0x1038, buf, 16, 0x0ff0);
+    CHECK(spm.contains(0x1008, 8));
+    CHECK(!spm.contains(0x1000, 16));
+    spm.flush(0, 0);
+
+    CHECK(spm.writebacks == 1);
+    CHECK(wb.size() == 3);
+    const uint64_t addrs[] = {0x1008, 0x1020, 0x103c};
+    const uint8_t firsts[] = {8, 0, 4};
+    for (int i = 0; i < 3 && !wb.empty(); i++, wb.pop()) {
+        CHECK(wb.front().first == addrs[i]);
+        CHECK(wb.front().second.size() == 8);
+        CHECK(wb.front().second[0] == firsts[i]);
+    }
+    // written back and invalidated by the flush
+    CHECK(!spm.contains(0x1008, 1));
+
+    // a line that was filled is written back whole
+    fill_line(spm, 0x2000, 0x77);
+    spm.write(0x2010, buf, 4, 0xf);
+    spm.flush(0, 0);
+    CHECK(wb.size() == 1);
+    if (!wb.empty()) {
+        CHECK(wb.front().first == 0x2000);
+        CHECK(wb.front().second.size() == LINE);
+        CHECK(wb.front().second[0] == 0x77 && wb.front().second[0x10] == 0);
+    }
+}
+
+static void
+test_write_around() {
+    Scratchpad::WritebackQueue wb;
+    Scratchpad spm(LINE, 4, 2, Scratchpad::REPL_LRU, wb);
+    uint8_t buf[64];
+    for (int i = 0; i < 64; i++)
+        buf[i] = i;
+
+    spm.write(0x3000, buf, 16, 0x0f0f, false);
+    CHECK(!spm.contains(0x3000, 1));
+    CHECK(spm.write_arounds == 1 && spm.evictions == 0);
+    CHECK(wb.size() == 2);
+    const uint64_t addrs[] = {0x3000, 0x3008};
+    for (int i = 0; i < 2 && !wb.empty(); i++, wb.pop()) {
+        CHECK(wb.front().first == addrs[i]);
+        CHECK(wb.front().second.size() == 4);
+        CHECK(wb.front().second[0] == addrs[i] - 0x3000);
+    }
+
+    // a hit is written in the spm even without allocation
+    fill_line(spm, 0x4000, 0);
+    spm.write(0x4000, buf, 8, 0xff, false);
+    CHECK(spm.write_arounds == 1 && wb.empty());
+    uint8_t out[8];
+    CHECK(spm.read(0x4000, out, 8) && out[7] == 7);
+}
+
+int
+main() {
+    test_hit_miss();
+    test_lru_fifo();
+    test_random();
+    test_partial_writeback();
+    test_write_around();
+
+    if (failures) {
+        printf("%d checks failed\n", failures);
+        return 1;
+    }
+    printf("scratchpad: all checks passed\n");
+    return 0;
+}
@@ -0,0 +1,254 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#include "waveTracer.hh"
+
+#include <stdio.h>
+
+#include "VNV_nvdla.h"
+#include "verilated.h"
+
+#if VM_TRACE
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <zlib.h>
+
+#include "verilated_vcd_c.h"
+#ifdef NVDLA_TRACE_FST
+#include "verilated_fst_c.h"
+#endif
+
+// VCD output compressed and written by a separate thread.
+//
+// Verilator hands the text it produces in chunks; they are queued
+// here and gzipped by the writer thread, so the simulation only pays
+// for a copy. The queue is bounded, if the writer falls behind the
+// simulation waits for it instead of buffering the whole waveform.
+class TraceWriterThread : public VerilatedVcdFile {
+public:
+    TraceWriterThread() : file(NULL), stop(false) {}
+    virtual ~TraceWriterThread() { close(); }
+
+    virtual bool open(const std::string &name) {
+        // fastest level, waveforms compress well anyway
+        file = gzopen(name.c_str(), "wb1");
+        if (!file)
+            return false;
+        stop = false;
+        worker = std::thread(&TraceWriterThread::run, this);
+        return true;
+    }
+
+    virtual void close() {
+        if (!file)
+            return;
+        handOver();
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            stop = true;
+        }
+        ready.notify_one();
+        worker.join();
+        gzclose(file);
+        file = NULL;
+    }
+
+    virtual ssize_t write(const char *buf, ssize_t len) {
+        current.insert(current.end(), buf, buf + len);
+        if (current.size() >= chunk_size)
+            handOver();
+        return len;
+    }
+
+private:
+    static const size_t chunk_size = 1 << 20;
+    static const size_t max_pending = 16;
+
+    void handOver() {
+        if (current.empty())
+            return;
+        std::unique_lock<std::mutex> lock(mtx);
+        space.wait(lock, [this]{ return pending.size() < max_pending; });
+        pending.push_back(std::move(current));
+        current = spare.empty() ? std::vector<char>() : std::move(spare.back());
+        if (!spare.empty())
+            spare.pop_back();
+        lock.unlock();
+        ready.notify_one();
+        current.reserve(chunk_size);
+    }
+
+    void run() {
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            ready.wait(lock, [this]{ return stop || !pending.empty(); });
+            if (pending.empty())
+                break;
+            std::vector<char> buf = std::move(pending.front());
+            pending.pop_front();
+            lock.unlock();
+            space.notify_one();
+
+            gzwrite(file, buf.data(), buf.size());
+
+            buf.clear();
+            lock.lock();
+            spare.push_back(std::move(buf));
+        }
+    }
+
+    gzFile file;
+    std::thread worker;
+    std::mutex mtx;
+    std::condition_variable ready;
+    std::condition_variable space;
+    bool stop;
+
+    // only touched by the simulation thread
+    std::vector<char> current;
+    // protected by mtx
+    std::deque<std::vector<char>> pending;
+    std::vector<std::vector<char>> spare;
+};
+#else
+class TraceWriterThread {};
+#endif
+
+WaveTracer::WaveTracer(VNV_nvdla *dla, const WaveTraceConfig &_cfg) :
+        dumped(0),
+        cfg(_cfg),
+        enabled(true),
+        closed(true),
+        begin(_cfg.trigger_addr ? UINT64_MAX : 2 * _cfg.start),
+        finish(UINT64_MAX),
+        vcd(NULL),
+        fst(NULL),
+        writer(NULL) {
+
+    if (!cfg.trigger_addr && cfg.cycles)
+        finish = begin + 2 * cfg.cycles - 1;
+
+#if VM_TRACE
+    if (cfg.format == TRACE_FST) {
+#ifdef NVDLA_TRACE_FST
+        // FST is compressed by Verilator, which also moves the writing
+        // to its own thread when the model is built with --trace-threads
+        Verilated::traceEverOn(true);
+        filename = cfg.path + ".fst";
+        fst = new VerilatedFstC;
+        dla->trace(fst, 99);
+        fst->open(filename.c_str());
+        closed = !fst->isOpen();
+#else
+        printf("FST waveforms are not supported by this build\n");
+#endif
+    } else if (cfg.format == TRACE_VCD) {
+        Verilated::traceEverOn(true);
+        if (cfg.threaded) {
+            writer = new TraceWriterThread;
+            filename = cfg.path + ".vcd.gz";
+        } else {
+            filename = cfg.path + ".vcd";
+        }
+        vcd = new VerilatedVcdC(writer);
+        dla->trace(vcd, 99);
+        vcd->open(filename.c_str());
+        closed = !vcd->isOpen();
+    }
+#else
+    printf("waveforms are not supported by this build (VM_TRACE=0)\n");
+#endif
+
+    if (!closed)
+        printf("dumping waveform to %s\n", filename.c_str());
+    else if (!filename.empty())
+        printf("could not open waveform %s\n", filename.c_str());
+}
+
+WaveTracer::~WaveTracer() {
+    close();
+}
+
+int WaveTracer::parseFormat(const std::string &name) {
+    if (name == "none")
+        return TRACE_NONE;
+    if (name == "vcd")
+        return TRACE_VCD;
+    if (name == "fst")
+        return TRACE_FST;
+    return -1;
+}
+
+void WaveTracer::csbWrite(uint32_t addr, uint64_t tick) {
+    if (!cfg.trigger_addr || addr != cfg.trigger_addr || begin != UINT64_MAX)
+        return;
+
+    begin = tick + 2 * cfg.start;
+    if (cfg.cycles)
+        finish = begin + 2 * cfg.cycles - 1;
+    printf("(%lu) waveform trigger %08x, dumping to %s\n",
+           tick, addr, filename.c_str());
+}
+
+void WaveTracer::write(uint64_t tick) {
+#if VM_TRACE
+    if (vcd)
+        vcd->dump(tick);
+#ifdef NVDLA_TRACE_FST
+    if (fst)
+        fst->dump(tick);
+#endif
+    dumped++;
+#endif
+}
+
+void WaveTracer::close() {
+#if VM_TRACE
+    if (vcd) {
+        vcd->close();
+        delete vcd;
+        vcd = NULL;
+    }
+    delete writer;
+    writer = NULL;
+#ifdef NVDLA_TRACE_FST
+    if (fst) {
+        fst->close();
+        delete fst;
+        fst = NULL;
+    }
+#endif
+#endif
+    if (!closed)
+        printf("waveform %s closed, %lu edges dumped\n",
+               filename.c_str(), dumped);
+    closed = true;
+}
@@ -0,0 +1,115 @@
+/*
+* Copyright (c) 2026 agent
+* All rights reserved.
+*
+* Redistribution and use in source and binary forms, with or without
+* modification, are permitted provided that the following conditions are
+* met: redistributions of source code must retain the above copyright
+* notice, this list of conditions and the following disclaimer;
+* redistributions in binary form must reproduce the above copyright
+* notice, this list of conditions and the following disclaimer in the
+* documentation and/or other materials provided with the distribution;
+* neither the name of the copyright holders nor the names of its
+* contributors may be used to endorse or promote products derived from
+* this software without specific prior written permission.
+*
+* THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+* "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+* LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+* A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+* OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+* SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+* LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+* DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+* THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+* (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+* OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+
+#ifndef __WAVE_TRACER_HH__
+#define __WAVE_TRACER_HH__
+
+#include <cstdint>
+#include <string>
+
+class VNV_nvdla;
+class VerilatedVcdC;
+class VerilatedFstC;
+class TraceWriterThread;
+
+// Waveform settings of one NVDLA instance.
+//
+// Cycles are NVDLA cycles. Without a trigger the window is counted
+// from reset; with a trigger it is counted from the first CSB write
+// to trigger_addr, so a single layer can be captured without dumping
+// the whole network before it.
+struct WaveTraceConfig {
+    int format;             // WaveTracer::Format
+    std::string path;       // output path without extension
+    uint64_t start;         // first cycle dumped
+    uint64_t cycles;        // cycles dumped, 0 for no limit
+    uint32_t trigger_addr;  // CSB write opening the window, 0 for none
+    bool threaded;          // compress and write from a separate thread
+};
+
+// Waveform dumper of the NVDLA RTL.
+//
+// Only created when a waveform was requested, so a run without
+// waveforms never enables Verilator tracing nor opens a file. Support
+// is selected at build time: with VM_TRACE=0 nothing is compiled in,
+// FST needs NVDLA_TRACE_FST and the FST Verilator model.
+class WaveTracer {
+public:
+    enum Format {
+        TRACE_NONE = 0,
+        TRACE_VCD = 1,
+        TRACE_FST = 2
+    };
+
+    WaveTracer(VNV_nvdla *dla, const WaveTraceConfig &cfg);
+    ~WaveTracer();
+
+    // format from its name: "none", "vcd" or "fst", -1 if unknown
+    static int parseFormat(const std::string &name);
+
+    // called on every clock edge, tick in half cycles
+    void dump(uint64_t tick) {
+        if (tick < begin || closed)
+            return;
+        if (tick > finish)
+            close();
+        else if (enabled)
+            write(tick);
+    }
+
+    // the CSB master wrote addr, open the window if it is the trigger
+    void csbWrite(uint32_t addr, uint64_t tick);
+
+    void setEnabled(bool on) { enabled = on; }
+
+    // flush and close the output, later dumps are ignored
+    void close();
+
+    bool isOpen() const { return !closed; }
+
+    std::string filename;
+
+    // number of dumped clock edges
+    uint64_t dumped;
+
+private:
+    void write(uint64_t tick);
+
+    const WaveTraceConfig cfg;
+    bool enabled;
+    bool closed;
+    // window in half cycles, empty until the trigger fires
+    uint64_t begin;
+    uint64_t finish;
+
+    VerilatedVcdC *vcd;
+    VerilatedFstC *fst;
+    TraceWriterThread *writer;
+};
+
+#endif
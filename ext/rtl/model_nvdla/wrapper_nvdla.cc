@@ -46,44 +46,117 @@
 */
 
 #include "wrapper_nvdla.hh"
+#include "checkpoint.hh"
+#include <cstring>
 #include <iostream>
+#include <mutex>
+
+#if NVDLA_THREADS > 1 && defined(__linux__)
+#include <pthread.h>
+#include <sched.h>
+#endif
 
 double sc_time_stamp(){
   return double_t(0);
 }
 
-Wrapper_nvdla::Wrapper_nvdla(int id_nvdla, bool traceOn, std::string name,const unsigned int maxReq,
-                             int _dma_enable, int _spm_latency, int _spm_line_size, int _spm_line_num, int pft_enable) :
+#if NVDLA_THREADS > 1 && defined(__linux__)
+// Host cores shared by the Verilator worker threads of all the
+// instances. The pool of a model is started by its constructor and
+// its threads inherit the affinity of the thread that creates it, so
+// each instance takes the least used cores while the model is built.
+// The first allowed core is left to the simulator itself.
+namespace {
+
+std::mutex cpu_lock;
+std::vector<int> cpu_ids;
+std::vector<int> cpu_users;
+
+std::vector<int> reserve_cpus(int count) {
+    std::lock_guard<std::mutex> guard(cpu_lock);
+    if (cpu_ids.empty()) {
+        cpu_set_t allowed;
+        sched_getaffinity(0, sizeof(allowed), &allowed);
+        for (int c = 0; c < CPU_SETSIZE; c++) {
+            if (CPU_ISSET(c, &allowed))
+                cpu_ids.push_back(c);
+        }
+        if (cpu_ids.size() > 1)
+            cpu_ids.erase(cpu_ids.begin());
+        cpu_users.assign(cpu_ids.size(), 0);
+    }
+
+    std::vector<int> taken;
+    for (int i = 0; i < count; i++) {
+        int best = std::min_element(cpu_users.begin(), cpu_users.end()) -
+                   cpu_users.begin();
+        cpu_users[best]++;
+        taken.push_back(cpu_ids[best]);
+    }
+    return taken;
+}
+
+void release_cpus(const std::vector<int> &cpus) {
+    std::lock_guard<std::mutex> guard(cpu_lock);
+    for (int cpu : cpus) {
+        int i = std::find(cpu_ids.begin(), cpu_ids.end(), cpu) -
+                cpu_ids.begin();
+        cpu_users[i]--;
+    }
+}
+
+} // anonymous namespace
+#endif
+
+Wrapper_nvdla::Wrapper_nvdla(int id_nvdla, const WaveTraceConfig &trace_cfg, const unsigned int maxReq,
+                             int _dma_enable, int _spm_latency, int _spm_line_size, int _spm_line_num, int pft_enable,
+                             int _spm_assoc, int _spm_repl_policy,
+                             int _spm_write_allocate, bool _spm_eager_writeback,
+                             const StreamPrefetchConfig &_stream_pft_cfg) :
         id_nvdla(id_nvdla),
         tickcount(0),
-        tfp(NULL),
-        tfpname(name),
-        traceOn(traceOn),
+        tracer(NULL),
         dma_enable(_dma_enable),
         spm_latency(_spm_latency),
         spm_line_size(_spm_line_size),
         spm_line_num(_spm_line_num),
-        prefetch_enable(pft_enable) {
+        // without dma nothing is ever stored in the spm, don't reserve it
+        spm(_spm_line_size, _dma_enable ? _spm_line_num : 1, _spm_assoc,
+            _spm_repl_policy, output.dma_write_buffer, _spm_eager_writeback),
+        spm_write_allocate(_spm_write_allocate),
+        spm_write_seq(0),
+        spm_write_clock(0),
+        prefetch_enable(pft_enable),
+        stream_pft_cfg(_stream_pft_cfg) {
 
     int argcc = 1;
     char* buf[] = {(char*)"aaa",(char*)"bbb"};
     Verilated::commandArgs(argcc, buf);
 
+#if NVDLA_THREADS > 1 && defined(__linux__)
+    // the thread evaluating the model is one of the NVDLA_THREADS
+    eval_cpus = reserve_cpus(NVDLA_THREADS - 1);
+    cpu_set_t mask, pinned;
+    pthread_getaffinity_np(pthread_self(), sizeof(mask), &mask);
+    CPU_ZERO(&pinned);
+    for (int cpu : eval_cpus)
+        CPU_SET(cpu, &pinned);
+    pthread_setaffinity_np(pthread_self(), sizeof(pinned), &pinned);
     dla = new VNV_nvdla();
+    pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask);
+
+    printf("nvdla#%d: %d RTL threads, workers on cpus", id_nvdla,
+           NVDLA_THREADS);
+    for (int cpu : eval_cpus)
+        printf(" %d", cpu);
+    printf("\n");
+#else
+    dla = new VNV_nvdla();
+#endif
 
-    // we always enable the trace
-    // but we will use it depending on traceOn
-    // otherwise this function launch an error
-    Verilated::traceEverOn(true);
-    tfp = new VerilatedVcdC;
-    // dla->trace(tfp, 99);
-    tfp->open(name.c_str());
-    if (!tfp) {
-        return;
-    }
-
-    std::cout << tfpname << std::endl;
-    //tfp->open(tfpname.c_str());
+    // without a waveform Verilator tracing is never turned on
+    if (trace_cfg.format != WaveTracer::TRACE_NONE)
+        tracer = new WaveTracer(dla, trace_cfg);
 
     // CSB Wrapper
     csb = new CSBMaster(dla, this);
@@ -160,24 +233,28 @@ Wrapper_nvdla::Wrapper_nvdla(int id_nvdla, bool traceOn, std::string name,const
 
 
 Wrapper_nvdla::~Wrapper_nvdla() {
-    if (tfp) {
-        tfp->dump(tickcount);
-        tfp->close();
-            delete tfp;
+    if (tracer) {
+        tracer->dump(tickcount);
+        delete tracer;
     }
     // TODO: this was causing a segfault not sure
     // TO CHECK
     //dla->final(); 
     delete dla;
+#if NVDLA_THREADS > 1 && defined(__linux__)
+    release_cpus(eval_cpus);
+#endif
     exit(EXIT_SUCCESS);
 }
 
 void Wrapper_nvdla::enableTracing() {
-    traceOn = true;
+    if (tracer)
+        tracer->setEnabled(true);
 }
 
 void Wrapper_nvdla::disableTracing() {
-    traceOn = false;
+    if (tracer)
+        tracer->setEnabled(false);
 }
 
 void Wrapper_nvdla::tick() {
@@ -197,10 +274,13 @@ void Wrapper_nvdla::tick() {
 
 void Wrapper_nvdla::advanceTickCount() {
     tickcount++;
-    if (tfp and traceOn) {
-        tfp->dump(tickcount);
-    }
-    
+    if (tracer)
+        tracer->dump(tickcount);
+}
+
+// account for cycles in which the RTL was quiescent and not evaluated
+void Wrapper_nvdla::skipTicks(uint64_t cycles) {
+    tickcount += 2 * cycles;
 }
 
 uint64_t Wrapper_nvdla::getTickCount() {
@@ -242,14 +322,12 @@ void Wrapper_nvdla::init() {
         dla->dla_core_clk = 1;
         dla->dla_csb_clk = 1;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
         
         dla->dla_core_clk = 0;
         dla->dla_csb_clk = 0;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
     }
 
     dla->dla_reset_rstn = 0;
@@ -260,14 +338,12 @@ void Wrapper_nvdla::init() {
         dla->dla_core_clk = 1;
         dla->dla_csb_clk = 1;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
         
         dla->dla_core_clk = 0;
         dla->dla_csb_clk = 0;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
     }
     
     dla->dla_reset_rstn = 1;
@@ -278,17 +354,72 @@ void Wrapper_nvdla::init() {
         dla->dla_core_clk = 1;
         dla->dla_csb_clk = 1;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
         
         dla->dla_core_clk = 0;
         dla->dla_csb_clk = 0;
         dla->eval();
-        tickcount++;
-        tfp->dump(tickcount);
+        advanceTickCount();
     }
 }
 
+bool Wrapper_nvdla::save(const char *fname) {
+#if NVDLA_SAVABLE
+    VerilatedSave os;
+    os.open(fname);
+    if (!os.isOpen())
+        return false;
+
+    os << *dla;
+    ckpt_save(os, tickcount);
+    csb->save(os);
+    axi_dbb->save(os);
+    axi_cvsram->save(os);
+    spm.save(os);
+    ckpt_save(os, spm_write_queue);
+    ckpt_save(os, spm_write_index);
+    ckpt_save(os, spm_write_seq);
+    ckpt_save(os, spm_write_clock);
+    // requests for the dma engine not issued yet
+    ckpt_save(os, output.dma_read_buffer);
+    ckpt_save(os, output.dma_write_buffer);
+
+    os.close();
+    return true;
+#else
+    printf("nvdla#%d: the RTL is not savable, rebuild with NVDLA_SAVABLE\n", id_nvdla);
+    return false;
+#endif
+}
+
+bool Wrapper_nvdla::restore(const char *fname) {
+#if NVDLA_SAVABLE
+    VerilatedRestore is;
+    is.open(fname);
+    if (!is.isOpen())
+        return false;
+
+    is >> *dla;
+    ckpt_restore(is, tickcount);
+    csb->restore(is);
+    axi_dbb->restore(is);
+    axi_cvsram->restore(is);
+    spm.restore(is);
+    ckpt_restore(is, spm_write_queue);
+    ckpt_restore(is, spm_write_index);
+    ckpt_restore(is, spm_write_seq);
+    ckpt_restore(is, spm_write_clock);
+    ckpt_restore(is, output.dma_read_buffer);
+    ckpt_restore(is, output.dma_write_buffer);
+
+    is.close();
+    return true;
+#else
+    printf("nvdla#%d: the RTL is not savable, rebuild with NVDLA_SAVABLE\n", id_nvdla);
+    return false;
+#endif
+}
+
 void Wrapper_nvdla::addReadReq(bool read_sram, bool read_timing,
                 uint32_t read_addr, uint32_t read_bytes) {
 
@@ -326,6 +457,17 @@ void Wrapper_nvdla::addLongWriteReq(bool write_sram, bool write_timing,
     output.long_write_buffer.push(std::move(wr));
 }
 
+void Wrapper_nvdla::addBulkWriteReq(bool write_sram, uint32_t write_addr,
+                                    uint32_t length, const uint8_t* write_data) {
+    output.write_valid = true;
+    bulk_write_req_entry_t wr;
+    wr.write_sram = write_sram;
+    wr.write_addr = write_addr;
+    wr.length = length;
+    wr.write_data = write_data;
+    output.bulk_write_buffer.push(wr);
+}
+
 void Wrapper_nvdla::clearOutput() {
     output.read_valid  = false;
     output.write_valid = false;
@@ -357,46 +499,79 @@ outputNVDLA& Wrapper_nvdla::tick(inputNVDLA in) {
     return output;    
 }
 
-uint8_t Wrapper_nvdla::read_spm(uint64_t addr) {
-    uint64_t addr_base = addr & ~(uint64_t)(spm_line_size - 1);
-    assert(spm.find(addr_base) != spm.end());
-    uint64_t offset = addr & (uint64_t)(spm_line_size - 1);
-    return spm[addr_base][offset];
+bool Wrapper_nvdla::read_spm(uint64_t addr, uint8_t* data, uint32_t len, bool count) {
+    return spm.read(addr, data, len, count);
 }
 
-// write is temporarily not used
-void Wrapper_nvdla::write_spm(uint64_t addr, uint8_t data) {
-    uint64_t addr_base = addr & ~(uint64_t)(spm_line_size - 1);
+bool Wrapper_nvdla::spm_allocates(uint64_t addr) const {
+    uint64_t cls = addr >> 28;
+    if (cls < 0x8 || cls > 0xa)
+        return true;
+    return (spm_write_allocate >> (cls - 0x8)) & 1;
+}
 
-    uint64_t offset = addr & (uint64_t)(spm_line_size - 1);
-    if(spm.find(addr_base) == spm.end()) {      // if the element to write is not in spm
-        // assign space to this spm line
-        std::vector<uint8_t>& entry_vector = spm[addr_base];
-        entry_vector.resize(spm_line_size, 0);
-    }
-    spm[addr_base][offset] = data;
+void Wrapper_nvdla::write_spm(uint64_t addr, const uint8_t* data, uint32_t len, uint64_t mask) {
+    // a line being fetched takes the write, or the fill would bring
+    // back the old data after the write went around to memory
+    uint64_t line_addr = addr & ~(uint64_t)(spm_line_size - 1);
+    bool alloc = spm_allocates(addr) || axi_dbb->dma_in_flight(line_addr);
+    spm.write(addr, data, len, mask, alloc);
 }
 
-void Wrapper_nvdla::flush_spm() {
-    // first write all items in spm write queue into spm
-    while (!spm_write_queue.empty()) {
-        auto &txn = spm_write_queue.front();
-        for (int i = 0; i < AXI_WIDTH / 8; i++) {
-            if (!((txn.mask >> i) & 1))
-                continue;
-            write_spm(txn.addr + i, txn.data[i]);
-            spm_write_queue.pop_front();
+void Wrapper_nvdla::push_spm_write(uint64_t addr, const uint8_t* data, uint64_t mask) {
+    spm_wr_txn txn;
+    txn.addr = addr;
+    txn.mask = mask;
+    txn.due = spm_write_clock + spm_latency;
+    memcpy(txn.data, data, AXI_WIDTH / 8);
+    spm_write_index[addr] = spm_write_seq + spm_write_queue.size();
+    spm_write_queue.push_back(txn);
+}
+
+// apply every queued write to addr on top of data, oldest first, and
+// return the mask of the bytes they cover
+uint64_t Wrapper_nvdla::merge_spm_writes(uint64_t addr, uint8_t* data) const {
+    auto it = spm_write_index.find(addr);
+    if (it == spm_write_index.end())
+        return 0;
+
+    uint64_t covered = 0;
+    for (uint64_t i = 0; i <= it->second - spm_write_seq; i++) {
+        const spm_wr_txn& txn = spm_write_queue[i];
+        if (txn.addr != addr)
+            continue;
+        for (int k = 0; k < AXI_WIDTH / 8; k++) {
+            if ((txn.mask >> k) & 1)
+                data[k] = txn.data[k];
         }
+        covered |= txn.mask;
     }
+    return covered;
+}
 
-    auto it = spm.begin();
-    while (it != spm.end()) {
-        if ((it->first & 0xF0000000) == 0x90000000) {   // this is a read-and-write variable
-            output.dma_write_buffer.push(std::make_pair(it->first, std::move(it->second)));
-            spm.erase(it++);
-        } else
-            it++;
+// called once per AXI evaluation, writes whose latency has elapsed reach the spm
+void Wrapper_nvdla::drain_spm_write_queue(bool all) {
+    while (!spm_write_queue.empty() && (all || spm_write_queue.front().due <= spm_write_clock)) {
+        spm_wr_txn& txn = spm_write_queue.front();
+        write_spm(txn.addr, txn.data, AXI_WIDTH / 8, txn.mask);
+
+        auto it = spm_write_index.find(txn.addr);
+        if (it->second == spm_write_seq)
+            spm_write_index.erase(it);
+        spm_write_queue.pop_front();
+        spm_write_seq++;
     }
+    if (!all)
+        spm_write_clock++;
+}
+
+void Wrapper_nvdla::flush_spm() {
+    // first write all items in spm write queue into spm
+    drain_spm_write_queue(true);
+
+    // then write back whatever is still dirty, the outputs are dropped
+    // from the spm as the guest will read them from memory
+    spm.flush(0xF0000000, 0x90000000);
 }
 
 void Wrapper_nvdla::addDMAReadReq(uint64_t read_addr, uint32_t read_bytes) {
@@ -70,6 +70,15 @@ struct long_write_req_entry_t {
     bool        write_timing;
 };
 
+// a whole buffer written functionally, data is not copied and must
+// stay valid until the output has been processed
+struct bulk_write_req_entry_t {
+    const uint8_t* write_data;
+    uint32_t    write_addr;
+    uint32_t    length;
+    bool        write_sram;
+};
+
 struct read_req_entry_t {
     uint32_t    read_addr;
     uint32_t    read_bytes;
@@ -83,6 +92,7 @@ struct outputNVDLA {
     bool                             write_valid;
     std::queue<write_req_entry_t>    write_buffer;
     std::queue<long_write_req_entry_t>    long_write_buffer;
+    std::queue<bulk_write_req_entry_t>    bulk_write_buffer;
     std::queue<std::pair<uint64_t, uint32_t>> dma_read_buffer;
     std::queue<std::pair<uint64_t, std::vector<uint8_t>>> dma_write_buffer;
 };
@@ -82,6 +82,11 @@
 #define NVDLA_SECONDARY_MEMIF_WIDTH 512
 #define NVDLA_MEM_ADDRESS_WIDTH 64
 
+// must match the --threads the RTL was Verilated with
+#ifndef NVDLA_THREADS
+#define NVDLA_THREADS 1
+#endif
+
 
 
 
@@ -96,15 +101,18 @@
 #include <algorithm> // for std::copy
 
 #include <queue>
+#include <deque>
 #include <map>
+#include <unordered_map>
 #include <vector>
 
 #include "VNV_nvdla.h"
 #include "verilated.h"
-#include "verilated_vcd_c.h"
 #include "csbMaster.hh"
 #include "axiResponder.hh"
 #include "rtl_packet_nvdla.hh"
+#include "scratchpad.hh"
+#include "waveTracer.hh"
 
 
 
@@ -114,8 +122,10 @@ class AXIResponder;
 class Wrapper_nvdla {
 
     public:
-        Wrapper_nvdla(int id_nvdla, bool traceOn, std::string name, const unsigned int maxReq,
-                      int _dma_enable, int _spm_latency, int _spm_line_size, int _spm_line_num, int pft_enable);
+        Wrapper_nvdla(int id_nvdla, const WaveTraceConfig &trace_cfg, const unsigned int maxReq,
+                      int _dma_enable, int _spm_latency, int _spm_line_size, int _spm_line_num, int pft_enable,
+                      int _spm_assoc = 8, int _spm_repl_policy = Scratchpad::REPL_LRU,
+                      int _spm_write_allocate = SPM_ALLOC_ALL, bool _spm_eager_writeback = false);
         ~Wrapper_nvdla();
 
         void tick();
@@ -124,23 +134,35 @@ class Wrapper_nvdla {
         void enableTracing();
         void disableTracing();
         void advanceTickCount();
+        void skipTicks(uint64_t cycles);
         void reset();
         void addInput(int writeCSB);
         void init();
 
+        // Write the RTL and the C++ side of the model to fname, or read
+        // them back into a wrapper built with the same parameters. The
+        // RTL must have been Verilated with --savable and built with
+        // NVDLA_SAVABLE, otherwise both return false.
+        bool save(const char *fname);
+        bool restore(const char *fname);
+
         void addReadReq(bool read_sram, bool read_timing,
                         uint32_t read_addr, uint32_t read_bytes);
         void addWriteReq(bool write_sram, bool write_timing,
                          uint32_t write_addr, uint8_t write_data);
         void addLongWriteReq(bool write_sram, bool write_timing,
                          uint32_t write_addr, uint32_t length, uint8_t* write_data, uint64_t mask);
+        void addBulkWriteReq(bool write_sram, uint32_t write_addr,
+                             uint32_t length, const uint8_t* write_data);
         void clearOutput();
 
         VNV_nvdla *dla;// = new VNV_nvdla;
+        // host cores the Verilator worker threads are pinned to, empty
+        // unless the RTL was Verilated with --threads (NVDLA_THREADS)
+        std::vector<int> eval_cpus;
         uint64_t tickcount;
-        VerilatedVcdC* tfp;
-        std::string tfpname;
-        bool traceOn;
+        // NULL unless a waveform was requested
+        WaveTracer *tracer;
 
         int id_nvdla;
 
@@ -158,21 +180,40 @@ class Wrapper_nvdla {
         // all the sizes are in bytes
         const uint32_t spm_line_size;
         const uint32_t spm_line_num;
-        std::map<uint64_t, std::vector<uint8_t> > spm;
-        // todo: need a spm write waiting list to temporarily store dirty data if write mask != 0xffffffffffffffff so that we can load clean from mem
+        Scratchpad spm;
+
+        // Address classes of the compiled network, a write miss in a
+        // class whose bit is set in spm_write_allocate allocates the
+        // spm line, otherwise it goes around the spm to memory.
+        enum {
+            SPM_ALLOC_RO = 1 << 0,     // 0x8xxxxxxx, read-only inputs
+            SPM_ALLOC_WO = 1 << 1,     // 0x9xxxxxxx, write-only outputs
+            SPM_ALLOC_RW = 1 << 2,     // 0xaxxxxxxx, read-write intermediates
+            SPM_ALLOC_ALL = SPM_ALLOC_RO | SPM_ALLOC_WO | SPM_ALLOC_RW
+        };
+        const int spm_write_allocate;
+        bool spm_allocates(uint64_t addr) const;
 
+        // writes wait spm_latency evaluations before reaching the spm
         struct spm_wr_txn{
             uint64_t addr;
             uint64_t mask;
-            uint32_t countdown;
+            uint64_t due;
             uint8_t data[512 / 8];
         };
-        std::list<spm_wr_txn> spm_write_queue;
+        std::deque<spm_wr_txn> spm_write_queue;
+        // addr -> sequence number of the newest queued write to it
+        std::unordered_map<uint64_t, uint64_t> spm_write_index;
+        uint64_t spm_write_seq;     // sequence number of spm_write_queue.front()
+        uint64_t spm_write_clock;
 
         void addDMAReadReq(uint64_t read_addr, uint32_t read_bytes);
 
-        uint8_t read_spm(uint64_t addr);
-        void write_spm(uint64_t addr, uint8_t data);
+        bool read_spm(uint64_t addr, uint8_t* data, uint32_t len, bool count = true);
+        void write_spm(uint64_t addr, const uint8_t* data, uint32_t len, uint64_t mask);
+        void push_spm_write(uint64_t addr, const uint8_t* data, uint64_t mask);
+        const spm_wr_txn* find_spm_write(uint64_t addr) const;
+        void drain_spm_write_queue(bool all);
         void flush_spm();
 
         // software prefetching
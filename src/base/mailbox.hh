@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __BASE_MAILBOX_HH__
+#define __BASE_MAILBOX_HH__
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include "base/intmath.hh"
+
+namespace gem5
+{
+
+/**
+ * Bounded single producer, single consumer queue used to pass
+ * messages between two simulation threads without taking a lock.
+ *
+ * One thread may push while another one pops at the same time. The
+ * capacity is rounded up to a power of two so the indices can run
+ * freely and be masked into the slot array.
+ */
+template <typename T>
+class Mailbox
+{
+  private:
+    std::vector<T> slots;
+    const size_t mask;
+
+    /// Next slot to pop, only written by the consumer
+    alignas(64) std::atomic<size_t> head;
+
+    /// Next slot to push, only written by the producer
+    alignas(64) std::atomic<size_t> tail;
+
+    static size_t
+    slotsFor(size_t capacity)
+    {
+        return capacity <= 1 ? 1 : (size_t)1 << ceilLog2(capacity);
+    }
+
+  public:
+    explicit Mailbox(size_t capacity)
+        : slots(slotsFor(capacity)), mask(slots.size() - 1),
+          head(0), tail(0)
+    {}
+
+    Mailbox(const Mailbox &) = delete;
+    Mailbox &operator=(const Mailbox &) = delete;
+
+    /**
+     * Post a message, to be called by the producer only.
+     *
+     * @return false if the mailbox is full
+     */
+    bool
+    push(const T &item)
+    {
+        size_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == slots.size())
+            return false;
+        slots[t & mask] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Take the oldest message, to be called by the consumer only.
+     *
+     * @return false if the mailbox is empty
+     */
+    bool
+    pop(T &item)
+    {
+        size_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+            return false;
+        item = slots[h & mask];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    /**
+     * Number of messages posted and not popped yet. Only exact when
+     * called from one of the two sides while the other one is idle.
+     */
+    size_t
+    size() const
+    {
+        return tail.load(std::memory_order_acquire) -
+            head.load(std::memory_order_acquire);
+    }
+
+    bool empty() const { return size() == 0; }
+    bool full() const { return size() == slots.size(); }
+    size_t capacity() const { return slots.size(); }
+};
+
+} // namespace gem5
+
+#endif // __BASE_MAILBOX_HH__
@@ -0,0 +1,109 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstdint>
+#include <thread>
+
+#include "base/mailbox.hh"
+
+using namespace gem5;
+
+/** The capacity is rounded up to a power of two. */
+TEST(MailboxTest, Capacity)
+{
+    Mailbox<int> box(6);
+    ASSERT_EQ(box.capacity(), 8);
+    ASSERT_TRUE(box.empty());
+
+    Mailbox<int> one(1);
+    ASSERT_EQ(one.capacity(), 1);
+}
+
+/** Messages come out in order and a full box refuses new ones. */
+TEST(MailboxTest, OrderAndFull)
+{
+    Mailbox<int> box(4);
+    for (int i = 0; i < 4; i++)
+        ASSERT_TRUE(box.push(i));
+    ASSERT_TRUE(box.full());
+    ASSERT_FALSE(box.push(4));
+
+    int item;
+    for (int i = 0; i < 4; i++) {
+        ASSERT_TRUE(box.pop(item));
+        ASSERT_EQ(item, i);
+    }
+    ASSERT_FALSE(box.pop(item));
+    ASSERT_TRUE(box.empty());
+}
+
+/** The indices keep running past the end of the slot array. */
+TEST(MailboxTest, WrapAround)
+{
+    Mailbox<int> box(4);
+    int item;
+    for (int i = 0; i < 100; i++) {
+        ASSERT_TRUE(box.push(i));
+        ASSERT_TRUE(box.push(i + 1000));
+        ASSERT_TRUE(box.pop(item));
+        ASSERT_EQ(item, i);
+        ASSERT_TRUE(box.pop(item));
+        ASSERT_EQ(item, i + 1000);
+    }
+    ASSERT_EQ(box.size(), 0);
+}
+
+/** A producer and a consumer thread running concurrently. */
+TEST(MailboxTest, TwoThreads)
+{
+    const uint64_t count = 1000000;
+    Mailbox<uint64_t> box(64);
+
+    std::thread producer([&] {
+        for (uint64_t i = 0; i < count; i++) {
+            while (!box.push(i))
+                std::this_thread::yield();
+        }
+    });
+
+    uint64_t expected = 0;
+    uint64_t item;
+    while (expected < count) {
+        if (box.pop(item)) {
+            ASSERT_EQ(item, expected);
+            expected++;
+        } else {
+            std::this_thread::yield();
+        }
+    }
+
+    producer.join();
+    ASSERT_TRUE(box.empty());
+}
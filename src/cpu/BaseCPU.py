@@ -125,12 +125,12 @@ class BaseCPU(ClockedObject):
 
 
     # ACCELERATORS
-    accel_0 = Param.rtlNVDLA(NULL, "RTL NVDLA Accelerator Object")
-    accel_1 = Param.rtlNVDLA(NULL, "RTL NVDLA Accelerator Object")
-    accel_2 = Param.rtlNVDLA(NULL, "RTL NVDLA Accelerator Object")
-    accel_3 = Param.rtlNVDLA(NULL, "RTL NVDLA Accelerator Object")
+    accels = VectorParam.rtlNVDLA([], "RTL NVDLA Accelerator Objects")
 
-    num_accels = Param.Int(0, "Number of rtl Objects")
+    num_accels = Param.Int(0, "Number of rtl Objects started by "
+                           "start_accel and waited for by wait_accel")
+    accel_wait_quiesce = Param.Bool(False, "Suspend a thread that waits "
+        "on a busy accelerator until the accelerator finishes")
 
 
     system = Param.System(Parent.any, "system object")
@@ -182,10 +182,8 @@ class BaseCPU(ClockedObject):
     icache_port = RequestPort("Instruction Port")
     dcache_port = RequestPort("Data Port")
 
-    accel_port_0 = RequestPort("Accelerator Port")
-    accel_port_1 = RequestPort("Accelerator Port")
-    accel_port_2 = RequestPort("Accelerator Port")
-    accel_port_3 = RequestPort("Accelerator Port")
+    accel_ports = VectorRequestPort("Accelerator Ports, the index is the "
+                                    "accelerator id")
 
     _cached_ports = ['icache_port', 'dcache_port']
 
@@ -46,6 +46,7 @@
 #include <iostream>
 #include <sstream>
 #include <string>
+#include <utility>
 
 #include "arch/generic/tlb.hh"
 #include "base/cprintf.hh"
@@ -55,6 +56,7 @@
 #include "base/trace.hh"
 #include "cpu/checker/cpu.hh"
 #include "cpu/thread_context.hh"
+#include "debug/Accel.hh"
 #include "debug/Mwait.hh"
 #include "debug/SyscallVerbose.hh"
 #include "debug/Thread.hh"
@@ -131,11 +133,9 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       _dataRequestorId(p.system->getRequestorId(this, "data")),
       _taskId(context_switch_task_id::Unknown), _pid(invldPid),
       _switchedOut(p.switched_out), _cacheLineSize(p.system->cacheLineSize()),
-      nvdla_port_0(this,"0"),
-      nvdla_port_1(this,"1"),
-      nvdla_port_2(this,"2"),
-      nvdla_port_3(this,"3"),
+      nvdla(p.accels),
       num_accels(p.num_accels),
+      accelWaitQuiesce(p.accel_wait_quiesce),
       interrupts(p.interrupts), numThreads(p.numThreads), system(p.system),
       previousCycle(0), previousState(CPU_STATE_SLEEP),
       functionTraceStream(nullptr), currentFunctionStart(0),
@@ -147,10 +147,12 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
       powerGatingOnIdle(p.power_gating_on_idle),
       enterPwrGatingEvent([this]{ enterPwrGating(); }, name())
 {
-    nvdla_0 = p.accel_0;
-    nvdla_1 = p.accel_1;
-    nvdla_2 = p.accel_2;
-    nvdla_3 = p.accel_3;
+    for (int i = 0; i < p.port_accel_ports_connection_count; i++)
+        accelPorts.emplace_back(new AccelPort(this, i));
+
+    fatal_if(num_accels > accelPorts.size(),
+             "%s: num_accels is %d but only %d accel_ports are connected\n",
+             name(), num_accels, accelPorts.size());
 
     // if Python did not provide a valid ID, do it here
     if (_cpuId == -1 ) {
@@ -190,10 +192,7 @@ BaseCPU::BaseCPU(const Params &p, bool is_checker)
               "of threads (%i).\n", params().isa.size(), numThreads);
     }
 
-    finishedAccelerator0=true;
-    finishedAccelerator1=true;
-    finishedAccelerator2=true;
-    finishedAccelerator3=true;
+    finishedAccelerator.assign(accelPorts.size(), true);
 }
 
 void
@@ -204,10 +203,6 @@ BaseCPU::enableFunctionTrace()
 
 BaseCPU::~BaseCPU()
 {
-    delete nvdla_0;
-    delete nvdla_1;
-    delete nvdla_2;
-    delete nvdla_3;
 }
 
 void
@@ -437,14 +432,8 @@ BaseCPU::getPort(const std::string &if_name, PortID idx)
     else if (if_name == "icache_port")
         return getInstPort();
     // (guillemlp) Add accelerator port when requested
-    else if (if_name == "accel_port_0")
-        return getAccelPort(0);
-    else if (if_name == "accel_port_1")
-        return getAccelPort(1);
-    else if (if_name == "accel_port_2")
-        return getAccelPort(2);
-    else if (if_name == "accel_port_3")
-        return getAccelPort(3);
+    else if (if_name == "accel_ports" && idx < accelPorts.size())
+        return getAccelPort(idx);
     else
         return ClockedObject::getPort(if_name, idx);
 }
@@ -453,20 +442,9 @@ BaseCPU::getPort(const std::string &if_name, PortID idx)
 Port &
 BaseCPU::getAccelPort(int n)
 {
-    // Get the right port based on name. This applies to all the
-    // subclasses of the base CPU and relies on their implementation
-    // of getDataPort and getInstPort. In all cases there methods
-    // return a MasterPort pointer.
-    if (n==0) {
-        return nvdla_port_0;
-    } else if (n==1) {
-        return nvdla_port_1;
-    } else if (n==2) {
-        return nvdla_port_2;
-    } else {
-        return nvdla_port_3;
-    }
-
+    panic_if(n < 0 || n >= accelPorts.size(),
+             "%s: no accelerator port %d\n", name(), n);
+    return *accelPorts[n];
 }
 
 void
@@ -660,7 +638,22 @@ BaseCPU::takeOverFrom(BaseCPU *oldCPU)
     getInstPort().takeOverFrom(&oldCPU->getInstPort());
     getDataPort().takeOverFrom(&oldCPU->getDataPort());
 
-    getAccelPort(0).takeOverFrom(&oldCPU->getAccelPort(0));
+    // Switched out CPUs usually have no accelerator connected, create
+    // the ports the old CPU had so they can be bound to the same
+    // accelerators. Jobs in flight, and the threads waiting for them,
+    // complete on this CPU.
+    while (accelPorts.size() < oldCPU->accelPorts.size())
+        accelPorts.emplace_back(new AccelPort(this, accelPorts.size()));
+
+    for (int i = 0; i < oldCPU->accelPorts.size(); i++)
+        getAccelPort(i).takeOverFrom(&oldCPU->getAccelPort(i));
+
+    num_accels = oldCPU->num_accels;
+    accelWaitQuiesce = oldCPU->accelWaitQuiesce;
+    finishedAccelerator = oldCPU->finishedAccelerator;
+    finishedAccelerator.resize(accelPorts.size(), true);
+    accelWaiters = std::move(oldCPU->accelWaiters);
+    oldCPU->accelWaiters.clear();
 }
 
 void
@@ -828,40 +821,123 @@ BaseCPU::AccelPort::ITickEvent::process()
 bool
 BaseCPU::AccelPort::recvTimingResp(PacketPtr pkt)
 {
-    //DPRINTF(SimpleCPU, "Received fetch response %#x\n", pkt->getAddr());
-    std::cout << "Received finished addr: " << pkt->getAddr() << std::endl;
+    // the accelerator answers with its id as address
+    DPRINTF(Accel, "Accelerator %d finished (id %d)\n", index,
+            pkt->getAddr());
 
-    if (pkt->getAddr() == 0) {
-        cpu->finishedAccelerator0=true;
-    }
+    delete pkt;
+    cpu->accelCompleted(index);
 
-    else if (pkt->getAddr() == 1) {
-        cpu->finishedAccelerator1=true;
-    }
+    return true;
+}
 
-    else if (pkt->getAddr() == 2) {
-        cpu->finishedAccelerator2=true;
+void
+BaseCPU::AccelPort::sendStart(PacketPtr pkt)
+{
+    // keep the order of the starts, a queued one goes first
+    if (!retryPkts.empty() || !sendTimingReq(pkt)) {
+        DPRINTF(Accel, "Accelerator %d busy, start queued\n", index);
+        retryPkts.push_back(pkt);
     }
+}
+
+void
+BaseCPU::AccelPort::recvReqRetry()
+{
+    // we shouldn't get a retry unless we have a packet that we're
+    // waiting to transmit
+    assert(!retryPkts.empty());
+    while (!retryPkts.empty() && sendTimingReq(retryPkts.front()))
+        retryPkts.pop_front();
+}
+
+void
+BaseCPU::sendAccelStart(int accel_id, Addr vaddr, int elements)
+{
+    RequestPtr req = std::make_shared<Request>(vaddr, elements,
+                              0, Request::funcRequestorId, 0, 0);
+    PacketPtr pkt = new Packet(req, MemCmd::ReadReq, elements);
+    accelPorts[accel_id]->sendStart(pkt);
+
+    finishedAccelerator[accel_id] = false;
+}
+
+void
+BaseCPU::startAccel(Addr vaddr, int elements, Addr region_nvdla)
+{
+    for (int i = num_accels - 1; i >= 0; i--)
+        sendAccelStart(i, vaddr, elements);
+}
 
-    else {
-        cpu->finishedAccelerator3=true;
+void
+BaseCPU::startAccelID(Addr vaddr, int elements, Addr region_nvdla,
+                      int accel_id)
+{
+    if (accel_id < 0 || accel_id >= accelPorts.size()) {
+        warn("startAccelID: Unknown accel id %d.\n", accel_id);
+        return;
     }
 
+    sendAccelStart(accel_id, vaddr, elements);
+}
+
+bool
+BaseCPU::accelFinished(int accel_id) const
+{
+    if (accel_id >= 0)
+        return finishedAccelerator[accel_id];
+
+    for (int i = 0; i < num_accels; i++) {
+        if (!finishedAccelerator[i])
+            return false;
+    }
     return true;
 }
 
 void
-BaseCPU::AccelPort::recvReqRetry()
+BaseCPU::accelCompleted(int accel_id)
 {
-    // we shouldn't get a retry unless we have a packet that we're
-    // waiting to transmit
-    //assert(cpu->ifetch_pkt != NULL);
-    //assert(cpu->_status == IcacheRetry);
-    //PacketPtr tmp = cpu->ifetch_pkt;
-    //if (sendTimingReq(tmp)) {
-    //    cpu->_status = IcacheWaitResponse;
-    //    cpu->ifetch_pkt = NULL;
-    //}
+    finishedAccelerator[accel_id] = true;
+
+    for (auto it = accelWaiters.begin(); it != accelWaiters.end(); ) {
+        if (accelFinished(it->second)) {
+            DPRINTF(Accel, "Waking up thread %d\n", it->first);
+            ThreadID tid = it->first;
+            it = accelWaiters.erase(it);
+            wakeup(tid);
+        } else {
+            it++;
+        }
+    }
+}
+
+uint64_t
+BaseCPU::waitAccel(ThreadContext *tc, Addr vaddr, int elements)
+{
+    if (accelFinished(-1))
+        return 0;
+
+    if (accelWaitQuiesce) {
+        accelWaiters.emplace_back(tc->threadId(), -1);
+        tc->quiesce();
+    }
+    return 1;
+}
+
+uint64_t
+BaseCPU::waitAccelID(ThreadContext *tc, int accel_id)
+{
+    fatal_if(accel_id < 0 || accel_id >= accelPorts.size(),
+             "waitAccelID: Unknown accel id %d.\n", accel_id);
+
+    if (accelFinished(accel_id))
+        return 0;
+
+    if (accelWaitQuiesce) {
+        accelWaiters.emplace_back(tc->threadId(), accel_id);
+        tc->quiesce();
+    }
+    return 1;
 }
 
 } // namespace gem5
@@ -42,6 +42,9 @@
 #ifndef __CPU_BASE_HH__
 #define __CPU_BASE_HH__
 
+#include <deque>
+#include <memory>
+#include <utility>
 #include <vector>
 
 // Before we do anything else, check if this build is the NULL ISA,
@@ -52,6 +55,7 @@
 #error Including BaseCPU in a system without CPU support
 #else
 #include "arch/generic/interrupts.hh"
+#include "base/cprintf.hh"
 #include "base/statistics.hh"
 #include "debug/Mwait.hh"
 #include "mem/port_proxy.hh"
@@ -201,13 +205,23 @@ class BaseCPU : public ClockedObject
     {
       public:
 
-        AccelPort(BaseCPU *_cpu, std::string id)
-            : TimingCPUPort(_cpu->name() + ".accel_port" + id, _cpu),
-              tickEvent(_cpu)
+        AccelPort(BaseCPU *_cpu, int _index)
+            : TimingCPUPort(csprintf("%s.accel_ports[%d]", _cpu->name(),
+                                     _index), _cpu),
+              index(_index), tickEvent(_cpu)
         { }
 
+        /// Send a start request, or queue it until the accelerator retries
+        void sendStart(PacketPtr pkt);
+
       protected:
 
+        /// Position of the port in accel_ports, also the accelerator id
+        const int index;
+
+        /// Start requests refused by the accelerator, oldest first
+        std::deque<PacketPtr> retryPkts;
+
         virtual bool recvTimingResp(PacketPtr pkt);
 
         virtual void recvReqRetry();
@@ -224,42 +238,52 @@ class BaseCPU : public ClockedObject
         ITickEvent tickEvent;
 
     };
-    AccelPort nvdla_port_0;
-    AccelPort nvdla_port_1;
-    AccelPort nvdla_port_2;
-    AccelPort nvdla_port_3;
+    std::vector<std::unique_ptr<AccelPort>> accelPorts;
 
-    rtlNVDLA* nvdla_0;
-    rtlNVDLA* nvdla_1;
-    rtlNVDLA* nvdla_2;
-    rtlNVDLA* nvdla_3;
+    std::vector<rtlNVDLA *> nvdla;
 
     int num_accels;
 
+    /**
+     * Suspend threads waiting on a busy accelerator until it finishes.
+     * Like num_accels, it is inherited from the CPU we take over from.
+     */
+    bool accelWaitQuiesce;
+
+    /**
+     * Threads suspended in waitAccel/waitAccelID, with the accelerator
+     * they wait for (-1 for all of them). Kept by thread id so they can
+     * be woken up by whichever CPU owns the accel ports at the time.
+     */
+    std::vector<std::pair<ThreadID, int>> accelWaiters;
+
+    /// Whether the accelerator (-1 for the first num_accels) is done
+    bool accelFinished(int accel_id) const;
 
+    /// Wake the waiting threads whose accelerators are done
+    void accelCompleted(int accel_id);
+
+    /// Send a start request for a trace at vaddr to an accelerator
+    void sendAccelStart(int accel_id, Addr vaddr, int elements);
 
     // Method to use when instruction start accel is used
-    virtual void startAccel(Addr addr, int elements, Addr region_nvdla)  {};
+    virtual void startAccel(Addr addr, int elements, Addr region_nvdla);
 
     // Method to use when instruction start_accel_id is used
-    virtual void startAccelID(Addr addr, int elements, Addr region_nvdla, int accel_id)  {};
+    virtual void startAccelID(Addr addr, int elements, Addr region_nvdla,
+                              int accel_id);
 
-    virtual uint64_t waitAccel(Addr addr, int elements)  {
-        std::cout << "THIS SHOULD NOT BE PRINTED, " <<
-        " HENCE WAIT ACCEL NOT IMPLMENTED" << std::endl;
-        return !finishedAccelerator0;
-    };
+    /**
+     * Returns non-zero while any of the accelerators in use is busy.
+     * With accel_wait_quiesce the calling thread is also suspended, so
+     * the guest poll loop only runs again once they are done.
+     */
+    virtual uint64_t waitAccel(ThreadContext *tc, Addr addr, int elements);
 
-    virtual uint64_t waitAccelID(int accel_id)  {
-        std::cout << "THIS SHOULD NOT BE PRINTED, " <<
-        " HENCE WAIT ACCEL ID NOT IMPLMENTED" << std::endl;
-        return !finishedAccelerator0;
-    };
+    // Same as waitAccel for a single accelerator
+    virtual uint64_t waitAccelID(ThreadContext *tc, int accel_id);
 
-    bool finishedAccelerator0;
-    bool finishedAccelerator1;
-    bool finishedAccelerator2;
-    bool finishedAccelerator3;
+    std::vector<bool> finishedAccelerator;
 
     /**
      * method that returns a reference to the accelerator
@@ -489,6 +489,38 @@ BaseKvmCPU::wakeup(ThreadID tid)
     thread->activate();
 }
 
+void
+BaseKvmCPU::startAccel(Addr addr, int elements, Addr region_nvdla)
+{
+    EventQueue::ScopedMigration migrate(deviceEventQueue());
+    BaseCPU::startAccel(addr, elements, region_nvdla);
+}
+
+void
+BaseKvmCPU::startAccelID(Addr addr, int elements, Addr region_nvdla,
+                         int accel_id)
+{
+    EventQueue::ScopedMigration migrate(deviceEventQueue());
+    BaseCPU::startAccelID(addr, elements, region_nvdla, accel_id);
+}
+
+uint64_t
+BaseKvmCPU::waitAccel(ThreadContext *tc, Addr addr, int elements)
+{
+    // The completion callback runs in the device event queue as well,
+    // so this also keeps the list of waiting threads consistent. The
+    // wakeup migrates back to our queue when the accelerator is done.
+    EventQueue::ScopedMigration migrate(deviceEventQueue());
+    return BaseCPU::waitAccel(tc, addr, elements);
+}
+
+uint64_t
+BaseKvmCPU::waitAccelID(ThreadContext *tc, int accel_id)
+{
+    EventQueue::ScopedMigration migrate(deviceEventQueue());
+    return BaseCPU::waitAccelID(tc, accel_id);
+}
+
 void
 BaseKvmCPU::activateContext(ThreadID thread_num)
 {
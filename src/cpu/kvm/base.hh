@@ -114,6 +114,16 @@ class BaseKvmCPU : public BaseCPU
     void deallocateContext(ThreadID thread_num);
     void haltContext(ThreadID thread_num) override;
 
+    /**
+     * The accelerators live in the device event queue, run the
+     * accelerator pseudo-ops there when each vCPU has its own queue.
+     */
+    void startAccel(Addr addr, int elements, Addr region_nvdla) override;
+    void startAccelID(Addr addr, int elements, Addr region_nvdla,
+                      int accel_id) override;
+    uint64_t waitAccel(ThreadContext *tc, Addr addr, int elements) override;
+    uint64_t waitAccelID(ThreadContext *tc, int accel_id) override;
+
     long getVCpuID() const { return vcpuID; }
     ThreadContext *getContext(int tn) override;
 
@@ -295,4 +295,196 @@ DmaNvdla::DmaDoneEvent::process()
     parent->dmaDone();
 }
 
+DmaNvdlaChannels::Channel::Channel(DmaNvdlaChannels *parent,
+                                   const std::string &name)
+    : doneEvent([this, parent]{ parent->channelDone(this); }, name)
+{
+}
+
+DmaNvdlaChannels::DmaNvdlaChannels(const std::string &name, DmaPort &_port,
+                                   unsigned num_channels,
+                                   Request::Flags flags)
+    : port(_port), reqFlags(flags)
+{
+    fatal_if(num_channels == 0, "%s needs at least one DMA channel\n", name);
+
+    for (unsigned i = 0; i < num_channels; i++) {
+        channels.emplace_back(new Channel(this,
+                    name + ".channel" + std::to_string(i) + ".doneEvent"));
+        freeChannels.push_back(channels.back().get());
+    }
+}
+
+DmaNvdlaChannels::~DmaNvdlaChannels()
+{
+    // We can't kill in-flight DMAs, the port still points to their
+    // events, so those channels are leaked
+    for (auto &ch : channels) {
+        if (ch->inFlight)
+            ch.release();
+    }
+}
+
+void
+DmaNvdlaChannels::read(Addr addr, unsigned size, uint64_t tag)
+{
+    descriptors.push_back({false, addr, tag, std::vector<uint8_t>(size)});
+    issue();
+}
+
+void
+DmaNvdlaChannels::write(Addr addr, std::vector<uint8_t> &&data)
+{
+    descriptors.push_back({true, addr, 0, std::move(data)});
+    pendingWrites++;
+    issue();
+}
+
+void
+DmaNvdlaChannels::issue()
+{
+    // Let the channels settle down before we checkpoint
+    if (drainState() == DrainState::Draining)
+        return;
+
+    while (!freeChannels.empty() && !descriptors.empty()) {
+        Descriptor &desc = descriptors.front();
+        if (!desc.isWrite && writeInFlight(desc.addr, desc.data.size())) {
+            DPRINTF(DMA, "Read of %#x waits for a write back\n", desc.addr);
+            break;
+        }
+
+        Channel *ch = freeChannels.back();
+        freeChannels.pop_back();
+
+        ch->isWrite = desc.isWrite;
+        ch->addr = desc.addr;
+        ch->tag = desc.tag;
+        ch->size = desc.data.size();
+        ch->consumed = 0;
+        ch->inFlight = true;
+        ch->data.swap(desc.data);
+        inFlight++;
+
+        DPRINTF(DMA, "Channel %s addr %#x size %d\n",
+                ch->isWrite ? "write" : "read", desc.addr, ch->size);
+
+        if (ch->isWrite)
+            writesIssued++;
+        else
+            readsIssued++;
+
+        port.dmaAction(ch->isWrite ? MemCmd::WriteReq : MemCmd::ReadReq,
+                       desc.addr, ch->size, &ch->doneEvent, ch->data.data(),
+                       0, reqFlags);
+        descriptors.pop_front();
+    }
+}
+
+bool
+DmaNvdlaChannels::writeInFlight(Addr addr, unsigned size) const
+{
+    for (const auto &ch : channels) {
+        if (ch->inFlight && ch->isWrite && ch->addr < addr + size &&
+            addr < ch->addr + ch->size)
+            return true;
+    }
+    return false;
+}
+
+void
+DmaNvdlaChannels::channelDone(Channel *ch)
+{
+    assert(ch->inFlight);
+    ch->inFlight = false;
+    inFlight--;
+
+    if (ch->isWrite) {
+        pendingWrites--;
+        freeChannel(ch);
+    } else {
+        completedReads.push_back(ch);
+    }
+
+    if (doneCallback)
+        doneCallback();
+
+    if (inFlight == 0)
+        signalDrainDone();
+}
+
+void
+DmaNvdlaChannels::freeChannel(Channel *ch)
+{
+    freeChannels.push_back(ch);
+    issue();
+}
+
+unsigned
+DmaNvdlaChannels::deliver(unsigned max_bytes, const ReadCallback &cb)
+{
+    unsigned delivered = 0;
+
+    while (delivered < max_bytes && !completedReads.empty()) {
+        Channel *ch = completedReads.front();
+        unsigned len = std::min(max_bytes - delivered,
+                                ch->size - ch->consumed);
+        cb(ch->tag, ch->consumed, ch->data.data() + ch->consumed, len);
+        ch->consumed += len;
+        delivered += len;
+
+        if (ch->consumed == ch->size) {
+            completedReads.pop_front();
+            freeChannel(ch);
+        }
+    }
+
+    return delivered;
+}
+
+DrainState
+DmaNvdlaChannels::drain()
+{
+    return inFlight == 0 ? DrainState::Drained : DrainState::Draining;
+}
+
+void
+DmaNvdlaChannels::serialize(CheckpointOut &cp) const
+{
+    panic_if(busyChannels() != 0,
+             "DMA channels checkpointed with transfers not consumed\n");
+
+    unsigned num_descriptors = descriptors.size();
+    SERIALIZE_SCALAR(num_descriptors);
+    for (unsigned i = 0; i < num_descriptors; i++) {
+        ScopedCheckpointSection sec(cp, csprintf("desc%d", i));
+        const Descriptor &desc = descriptors[i];
+        paramOut(cp, "is_write", desc.isWrite);
+        paramOut(cp, "addr", desc.addr);
+        paramOut(cp, "tag", desc.tag);
+        arrayParamOut(cp, "data", desc.data);
+    }
+}
+
+void
+DmaNvdlaChannels::unserialize(CheckpointIn &cp)
+{
+    unsigned num_descriptors;
+    UNSERIALIZE_SCALAR(num_descriptors);
+
+    descriptors.clear();
+    pendingWrites = 0;
+    for (unsigned i = 0; i < num_descriptors; i++) {
+        ScopedCheckpointSection sec(cp, csprintf("desc%d", i));
+        Descriptor desc;
+        paramIn(cp, "is_write", desc.isWrite);
+        paramIn(cp, "addr", desc.addr);
+        paramIn(cp, "tag", desc.tag);
+        arrayParamIn(cp, "data", desc.data);
+        if (desc.isWrite)
+            pendingWrites++;
+        descriptors.push_back(std::move(desc));
+    }
+}
+
 } // namespace gem5
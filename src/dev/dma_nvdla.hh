@@ -42,7 +42,10 @@
 #define __DEV_DMA_NVDLA_HH__
 
 #include <deque>
+#include <functional>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "base/addr_range_map.hh"
 #include "base/chunk_generator.hh"
@@ -308,6 +311,121 @@ class DmaNvdla : public Drainable, public Serializable
     bool is_write;
 };
 
+/**
+ * DMA engine with several independent channels.
+ *
+ * Transfers are queued as descriptors with read() and write() and
+ * issued in order as channels become free. Every channel sends its
+ * whole transfer with a single DmaPort::dmaAction, so up to
+ * numChannels transfers overlap and they can complete in any order.
+ * Write channels are freed as soon as the write completes, read
+ * channels keep their data until the owner consumes it with
+ * deliver(). A read overlapping a write still in flight is held,
+ * with everything queued behind it, until the write completes, so a
+ * refetch never returns the data from before a write back.
+ */
+class DmaNvdlaChannels : public Drainable, public Serializable
+{
+  public:
+    /**
+     * Consumer of read data: tag of the descriptor, offset of the
+     * chunk within the transfer and the chunk itself.
+     */
+    typedef std::function<void(uint64_t tag, unsigned offset,
+                               const uint8_t *data, unsigned len)>
+        ReadCallback;
+
+    DmaNvdlaChannels(const std::string &name, DmaPort &port,
+                     unsigned num_channels, Request::Flags flags=0);
+    ~DmaNvdlaChannels();
+
+    /** Queue a read of size bytes from addr, reported with tag. */
+    void read(Addr addr, unsigned size, uint64_t tag);
+
+    /** Queue a write of data to addr. */
+    void write(Addr addr, std::vector<uint8_t> &&data);
+
+    /**
+     * Hand up to max_bytes of completed reads to cb, in completion
+     * order. A transfer is always delivered from its start to its
+     * end before the next one.
+     *
+     * @return Number of bytes delivered.
+     */
+    unsigned deliver(unsigned max_bytes, const ReadCallback &cb);
+
+    /** Number of channels with a transfer in flight or not consumed */
+    unsigned busyChannels() const { return channels.size() - freeChannels.size(); }
+
+    /** Are there writes queued or in flight? */
+    bool writesPending() const { return pendingWrites != 0; }
+
+    /** Are there completed reads waiting for deliver()? */
+    bool readsCompleted() const { return !completedReads.empty(); }
+
+    /** Call cb every time a transfer completes */
+    void setDoneCallback(std::function<void()> cb) { doneCallback = cb; }
+
+    DrainState drain() override;
+    void drainResume() override { issue(); }
+
+    /**
+     * Only the descriptors not yet issued are saved, the owner has to
+     * consume the completed reads before checkpointing.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+
+    /** Number of read and write transfers issued */
+    uint64_t readsIssued = 0;
+    uint64_t writesIssued = 0;
+
+  private:
+    struct Descriptor
+    {
+        bool isWrite;
+        Addr addr;
+        uint64_t tag;
+        std::vector<uint8_t> data;
+    };
+
+    struct Channel
+    {
+        Channel(DmaNvdlaChannels *parent, const std::string &name);
+
+        bool isWrite = false;
+        Addr addr = 0;
+        uint64_t tag = 0;
+        unsigned size = 0;
+        unsigned consumed = 0;
+        bool inFlight = false;
+        std::vector<uint8_t> data;
+        EventFunctionWrapper doneEvent;
+    };
+
+    /** Start queued descriptors on free channels */
+    void issue();
+
+    /** Does a write in flight overlap [addr, addr + size)? */
+    bool writeInFlight(Addr addr, unsigned size) const;
+
+    /** Completion of the transfer of a channel */
+    void channelDone(Channel *ch);
+
+    void freeChannel(Channel *ch);
+
+    DmaPort &port;
+    const Request::Flags reqFlags;
+
+    std::vector<std::unique_ptr<Channel>> channels;
+    std::vector<Channel *> freeChannels;
+    std::deque<Descriptor> descriptors;
+    std::deque<Channel *> completedReads;
+    unsigned inFlight = 0;
+    unsigned pendingWrites = 0;
+    std::function<void()> doneCallback;
+};
+
 } // namespace gem5
 
 #endif // __DEV_DMA_NVDLA_HH__
@@ -0,0 +1,52 @@
+# -*- coding: utf-8 -*-
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+from m5.params import *
+from m5.proxy import *
+from m5.objects.ClockedObject import ClockedObject
+
+class MailboxBridge(ClockedObject):
+    type = 'MailboxBridge'
+    cxx_header = "mem/mailbox_bridge.hh"
+    cxx_class = 'gem5::MailboxBridge'
+
+    # The cpu side runs on eventq_index, the memory side on
+    # mem_side_eventq_index. When they differ the two sides only
+    # exchange packets through lock-free mailboxes at the quantum
+    # barriers, so the delay must not be shorter than the quantum.
+    mem_side_port = RequestPort("This port sends requests and "
+                                "receives responses")
+    cpu_side_port = ResponsePort("This port receives requests and "
+                                 "sends responses")
+
+    mem_side_eventq_index = Param.UInt32(Parent.eventq_index,
+        "Event queue the memory side of the bridge runs on")
+    delay = Param.Latency('10ns', "Latency of the link, the simulation "
+                          "quantum must not be longer")
+    size = Param.Unsigned(128, "Number of requests and responses in "
+                          "flight in each direction")
@@ -0,0 +1,311 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/mailbox_bridge.hh"
+
+#include <algorithm>
+
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/MailboxBridge.hh"
+
+namespace gem5
+{
+
+MailboxBridge::MailboxBridge(const Params &p)
+    : ClockedObject(p),
+      cpuSidePort(p.name + ".cpu_side_port", *this),
+      memSidePort(p.name + ".mem_side_port", *this),
+      memSideQueue(getEventQueue(p.mem_side_eventq_index)),
+      delay(p.delay), size(p.size),
+      reqBox(p.size), respBox(p.size),
+      outstanding(0), retryReq(false),
+      waitReqRetry(false), waitRespRetry(false),
+      inFlight(0), drainSignalled(false),
+      sendReqEvent([this]{ trySendReq(); }, name() + ".sendReq"),
+      sendRespEvent([this]{ trySendResp(); }, name() + ".sendResp"),
+      retryEvent([this]{ retryReq = false; cpuSidePort.sendRetryReq(); },
+                 name() + ".retry")
+{
+    fatal_if(size == 0, "%s: size must be at least one\n", name());
+}
+
+Port &
+MailboxBridge::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "mem_side_port")
+        return memSidePort;
+    else if (if_name == "cpu_side_port")
+        return cpuSidePort;
+    else
+        return ClockedObject::getPort(if_name, idx);
+}
+
+void
+MailboxBridge::init()
+{
+    if (!cpuSidePort.isConnected() || !memSidePort.isConnected())
+        fatal("Both ports of a mailbox bridge must be connected.\n");
+
+    cpuSidePort.sendRangeChange();
+}
+
+void
+MailboxBridge::startup()
+{
+    if (!split())
+        return;
+
+    // a message posted at the start of a quantum is only seen by the
+    // other side at its end
+    fatal_if(delay < simQuantum, "%s: delay of %d ticks is shorter than "
+             "the simulation quantum (%d ticks)\n", name(), delay,
+             simQuantum);
+
+    memSideQueue->addQuantumHandler([this]{ collectRequests(); });
+    eventQueue()->addQuantumHandler([this]{ collectResponses(); });
+}
+
+AddrRangeList
+MailboxBridge::CpuSidePort::getAddrRanges() const
+{
+    return bridge.memSidePort.getAddrRanges();
+}
+
+bool
+MailboxBridge::recvTimingReq(PacketPtr pkt)
+{
+    DPRINTF(MailboxBridge, "recvTimingReq: %s addr 0x%x\n",
+            pkt->cmdString(), pkt->getAddr());
+
+    panic_if(pkt->cacheResponding(), "Should not see packets where cache "
+             "is responding");
+
+    if (retryReq)
+        return false;
+
+    bool expects_response = pkt->needsResponse();
+    if (reqBox.full() || (expects_response && outstanding == size)) {
+        DPRINTF(MailboxBridge, "Mailbox full, outstanding %d\n",
+                outstanding);
+        retryReq = true;
+        return false;
+    }
+
+    if (expects_response)
+        ++outstanding;
+    ++inFlight;
+
+    Tick when = curTick() + delay + pkt->headerDelay + pkt->payloadDelay;
+    pkt->headerDelay = pkt->payloadDelay = 0;
+
+    bool posted = reqBox.push({pkt, when});
+    assert(posted);
+    (void)posted;
+
+    if (!split())
+        collectRequests();
+
+    return true;
+}
+
+bool
+MailboxBridge::recvTimingResp(PacketPtr pkt)
+{
+    DPRINTF(MailboxBridge, "recvTimingResp: %s addr 0x%x\n",
+            pkt->cmdString(), pkt->getAddr());
+
+    Tick when = curTick() + delay + pkt->headerDelay + pkt->payloadDelay;
+    pkt->headerDelay = pkt->payloadDelay = 0;
+
+    // space for the response was reserved when the request came in
+    panic_if(!respBox.push({pkt, when}),
+             "%s: response mailbox overflow\n", name());
+
+    if (!split())
+        collectResponses();
+
+    return true;
+}
+
+void
+MailboxBridge::collectRequests()
+{
+    Message msg;
+    while (reqBox.pop(msg))
+        reqPending.push_back(msg);
+
+    schedSendReq();
+}
+
+void
+MailboxBridge::collectResponses()
+{
+    Message msg;
+    while (respBox.pop(msg))
+        respPending.push_back(msg);
+
+    schedSendResp();
+    schedRetry();
+}
+
+void
+MailboxBridge::schedSendReq()
+{
+    if (reqPending.empty() || waitReqRetry || sendReqEvent.scheduled())
+        return;
+
+    memSideQueue->schedule(&sendReqEvent,
+                           std::max(reqPending.front().tick, curTick()));
+}
+
+void
+MailboxBridge::schedSendResp()
+{
+    if (respPending.empty() || waitRespRetry || sendRespEvent.scheduled())
+        return;
+
+    schedule(sendRespEvent, std::max(respPending.front().tick, curTick()));
+}
+
+void
+MailboxBridge::schedRetry()
+{
+    if (!retryReq || retryEvent.scheduled() || reqBox.full() ||
+        outstanding == size)
+        return;
+
+    schedule(retryEvent, curTick());
+}
+
+void
+MailboxBridge::trySendReq()
+{
+    waitReqRetry = false;
+    assert(!reqPending.empty());
+
+    PacketPtr pkt = reqPending.front().pkt;
+    bool expects_response = pkt->needsResponse();
+
+    DPRINTF(MailboxBridge, "trySendReq: addr 0x%x\n", pkt->getAddr());
+    if (!memSidePort.sendTimingReq(pkt)) {
+        waitReqRetry = true;
+        return;
+    }
+
+    reqPending.pop_front();
+    schedSendReq();
+
+    if (!expects_response)
+        packetDone();
+}
+
+void
+MailboxBridge::trySendResp()
+{
+    waitRespRetry = false;
+    assert(!respPending.empty());
+
+    PacketPtr pkt = respPending.front().pkt;
+
+    DPRINTF(MailboxBridge, "trySendResp: addr 0x%x\n", pkt->getAddr());
+    if (!cpuSidePort.sendTimingResp(pkt)) {
+        waitRespRetry = true;
+        return;
+    }
+
+    respPending.pop_front();
+    assert(outstanding != 0);
+    --outstanding;
+
+    schedSendResp();
+    schedRetry();
+    packetDone();
+}
+
+void
+MailboxBridge::packetDone()
+{
+    assert(inFlight != 0);
+    // both sides may get here, only the one taking the count to zero
+    // can signal the drain
+    if (--inFlight == 0 && drainState() == DrainState::Draining &&
+        !drainSignalled.exchange(true)) {
+        DPRINTF(MailboxBridge, "Done draining\n");
+        signalDrainDone();
+    }
+}
+
+Tick
+MailboxBridge::recvAtomic(PacketPtr pkt)
+{
+    panic_if(pkt->cacheResponding(), "Should not see packets where cache "
+             "is responding");
+
+    EventQueue::ScopedMigration migrate(memSideQueue);
+    return delay + memSidePort.sendAtomic(pkt);
+}
+
+void
+MailboxBridge::recvFunctional(PacketPtr pkt)
+{
+    pkt->pushLabel(name());
+
+    // packets still in the mailboxes are not checked, they belong to
+    // whichever side has not collected them yet
+    for (const auto &msg : respPending) {
+        if (pkt->trySatisfyFunctional(msg.pkt)) {
+            pkt->popLabel();
+            return;
+        }
+    }
+
+    {
+        EventQueue::ScopedMigration migrate(memSideQueue);
+        bool satisfied = false;
+        for (const auto &msg : reqPending) {
+            if (pkt->trySatisfyFunctional(msg.pkt)) {
+                satisfied = true;
+                break;
+            }
+        }
+        if (!satisfied)
+            memSidePort.sendFunctional(pkt);
+    }
+
+    pkt->popLabel();
+}
+
+DrainState
+MailboxBridge::drain()
+{
+    drainSignalled = false;
+    return inFlight == 0 ? DrainState::Drained : DrainState::Draining;
+}
+
+} // namespace gem5
@@ -0,0 +1,224 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_MAILBOX_BRIDGE_HH__
+#define __MEM_MAILBOX_BRIDGE_HH__
+
+#include <atomic>
+#include <deque>
+
+#include "base/mailbox.hh"
+#include "base/types.hh"
+#include "mem/port.hh"
+#include "params/MailboxBridge.hh"
+#include "sim/clocked_object.hh"
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+/**
+ * Bridge between two event queues, used to cut a port connection
+ * when the two ends are simulated by different threads.
+ *
+ * The cpu side runs on the bridge's own queue and the memory side on
+ * mem_side_eventq_index. Packets crossing the bridge are posted to a
+ * lock-free mailbox in each direction, which the receiving side only
+ * empties when its queue handles the asynchronous insertions at the
+ * end of a quantum. A packet posted at tick t is due at t + delay, so
+ * as long as the delay is not shorter than the quantum it is always
+ * picked up before it has to be sent, and the simulation stays
+ * deterministic. With both sides on the same queue it behaves as a
+ * plain bridge with a fixed delay.
+ *
+ * Atomic and functional accesses are forwarded by migrating to the
+ * memory side queue, as KVM does for its devices. Snoops are not
+ * supported, the bridge is only meant for non-coherent links.
+ */
+class MailboxBridge : public ClockedObject
+{
+  protected:
+    struct Message
+    {
+        PacketPtr pkt;
+        Tick tick;
+    };
+
+    class CpuSidePort : public ResponsePort
+    {
+      private:
+        MailboxBridge &bridge;
+
+      public:
+        CpuSidePort(const std::string &_name, MailboxBridge &_bridge)
+            : ResponsePort(_name, &_bridge), bridge(_bridge)
+        {}
+
+      protected:
+        bool
+        recvTimingReq(PacketPtr pkt) override
+        {
+            return bridge.recvTimingReq(pkt);
+        }
+
+        void recvRespRetry() override { bridge.trySendResp(); }
+
+        Tick
+        recvAtomic(PacketPtr pkt) override
+        {
+            return bridge.recvAtomic(pkt);
+        }
+
+        void
+        recvFunctional(PacketPtr pkt) override
+        {
+            bridge.recvFunctional(pkt);
+        }
+
+        AddrRangeList getAddrRanges() const override;
+    };
+
+    class MemSidePort : public RequestPort
+    {
+      private:
+        MailboxBridge &bridge;
+
+      public:
+        MemSidePort(const std::string &_name, MailboxBridge &_bridge)
+            : RequestPort(_name, &_bridge), bridge(_bridge)
+        {}
+
+      protected:
+        bool
+        recvTimingResp(PacketPtr pkt) override
+        {
+            return bridge.recvTimingResp(pkt);
+        }
+
+        void recvReqRetry() override { bridge.trySendReq(); }
+
+        void
+        recvRangeChange() override
+        {
+            bridge.cpuSidePort.sendRangeChange();
+        }
+    };
+
+    CpuSidePort cpuSidePort;
+    MemSidePort memSidePort;
+
+    /// Queue of the memory side, the cpu side uses the bridge's own
+    EventQueue *memSideQueue;
+
+    /// Latency of the link in ticks
+    const Tick delay;
+
+    /// Requests and responses in flight in each direction
+    const unsigned size;
+
+    /// Requests posted by the cpu side
+    Mailbox<Message> reqBox;
+
+    /// Responses posted by the memory side
+    Mailbox<Message> respBox;
+
+    /// Requests collected by the memory side, waiting to be sent
+    std::deque<Message> reqPending;
+
+    /// Responses collected by the cpu side, waiting to be sent
+    std::deque<Message> respPending;
+
+    /// Requests accepted on the cpu side still waiting for a response
+    unsigned outstanding;
+
+    /// The cpu side refused a request and owes a retry
+    bool retryReq;
+
+    /// Each side waiting for a retry from its peer
+    bool waitReqRetry;
+    bool waitRespRetry;
+
+    /**
+     * Packets accepted and not handed over yet, counted from both
+     * sides. A request expecting a response is only done once the
+     * response leaves the cpu side.
+     */
+    std::atomic<unsigned> inFlight;
+
+    /// Set once the drain of the bridge has been signalled
+    std::atomic<bool> drainSignalled;
+
+    /// Memory side event
+    EventFunctionWrapper sendReqEvent;
+
+    /// Cpu side events
+    EventFunctionWrapper sendRespEvent;
+    EventFunctionWrapper retryEvent;
+
+    /// Are the two sides simulated on different queues
+    bool split() const { return memSideQueue != eventQueue(); }
+
+    bool recvTimingReq(PacketPtr pkt);
+    bool recvTimingResp(PacketPtr pkt);
+    Tick recvAtomic(PacketPtr pkt);
+    void recvFunctional(PacketPtr pkt);
+
+    /**
+     * Move the messages posted by the other side into the pending
+     * list and schedule their transmission. Called on the receiving
+     * side's thread.
+     */
+    void collectRequests();
+    void collectResponses();
+
+    void schedSendReq();
+    void schedSendResp();
+    void schedRetry();
+
+    void trySendReq();
+    void trySendResp();
+
+    /// One packet handed over, signal the drain if it was the last
+    void packetDone();
+
+  public:
+    PARAMS(MailboxBridge);
+    MailboxBridge(const Params &p);
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+    void init() override;
+    void startup() override;
+
+    DrainState drain() override;
+};
+
+} // namespace gem5
+
+#endif // __MEM_MAILBOX_BRIDGE_HH__
@@ -141,6 +141,9 @@ class PhysicalMemory : public Serializable
 
     const std::string sharedBackstore;
 
+    /// Host threads used to save and restore the backing stores
+    const unsigned checkpointThreads;
+
     // The physical memory used to provide the memory in the simulated
     // system
     std::vector<BackingStoreEntry> backingStore;
@@ -173,7 +176,8 @@ class PhysicalMemory : public Serializable
     PhysicalMemory(const std::string& _name,
                    const std::vector<AbstractMemory*>& _memories,
                    bool mmap_using_noreserve,
-                   const std::string& shared_backstore);
+                   const std::string& shared_backstore,
+                   unsigned checkpoint_threads = 0);
 
     /**
      * Unmap all the backing store we have used.
@@ -0,0 +1,456 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "mem/store_image.hh"
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <zlib.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+namespace memory
+{
+
+namespace
+{
+
+const char imageMagic[8] = {'g', 'e', 'm', '5', 'p', 'm', 'e', 'm'};
+const uint32_t imageVersion = 1;
+
+struct ChunkEntry
+{
+    uint64_t offset;
+    uint64_t length;
+};
+
+unsigned
+poolSize(unsigned threads, uint64_t jobs)
+{
+    if (threads == 0)
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    return std::max<uint64_t>(1, std::min<uint64_t>(threads, jobs));
+}
+
+bool
+pwriteAll(int fd, const void *buf, uint64_t len, uint64_t offset)
+{
+    const uint8_t *p = (const uint8_t *)buf;
+    while (len) {
+        ssize_t n = pwrite(fd, p, len, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool
+preadAll(int fd, void *buf, uint64_t len, uint64_t offset)
+{
+    uint8_t *p = (uint8_t *)buf;
+    while (len) {
+        ssize_t n = pread(fd, p, len, offset);
+        if (n < 0 && errno == EINTR)
+            continue;
+        if (n <= 0)
+            return false;
+        p += n;
+        len -= n;
+        offset += n;
+    }
+    return true;
+}
+
+bool
+isZero(const uint8_t *p, uint64_t len)
+{
+    // the stores are page aligned, so whole words can be read
+    const uint64_t *w = (const uint64_t *)p;
+    uint64_t words = len / sizeof(uint64_t);
+    uint64_t i = 0;
+    for (; i + 8 <= words; i += 8) {
+        if (w[i] | w[i + 1] | w[i + 2] | w[i + 3] |
+            w[i + 4] | w[i + 5] | w[i + 6] | w[i + 7])
+            return false;
+    }
+    for (; i < words; i++) {
+        if (w[i])
+            return false;
+    }
+    for (uint64_t b = words * sizeof(uint64_t); b < len; b++) {
+        if (p[b])
+            return false;
+    }
+    return true;
+}
+
+/**
+ * Compress the non-zero pages of a chunk into out, setting the bits
+ * of the zero ones. Each chunk owns whole words of the bitmap, so the
+ * workers don't need to synchronise.
+ */
+bool
+compressChunk(const uint8_t *chunk, uint64_t len, uint64_t first_page,
+              uint64_t *bitmap, std::vector<uint8_t> &raw,
+              std::vector<uint8_t> &out)
+{
+    bool sparse = false;
+    for (uint64_t off = 0; off < len; off += storeImagePageSize) {
+        uint64_t page = first_page + off / storeImagePageSize;
+        if (isZero(chunk + off, std::min<uint64_t>(storeImagePageSize,
+                                                   len - off))) {
+            bitmap[page / 64] |= (uint64_t)1 << (page % 64);
+            sparse = true;
+        }
+    }
+
+    // without zero pages the chunk is compressed in place
+    raw.clear();
+    if (sparse) {
+        for (uint64_t off = 0; off < len; off += storeImagePageSize) {
+            uint64_t page = first_page + off / storeImagePageSize;
+            if (bitmap[page / 64] & ((uint64_t)1 << (page % 64)))
+                continue;
+            uint64_t page_len = std::min<uint64_t>(storeImagePageSize,
+                                                   len - off);
+            raw.insert(raw.end(), chunk + off, chunk + off + page_len);
+        }
+    }
+
+    const uint8_t *src = sparse ? raw.data() : chunk;
+    uint64_t src_len = sparse ? raw.size() : len;
+    if (src_len == 0) {
+        out.clear();
+        return true;
+    }
+
+    uLongf out_len = compressBound(src_len);
+    out.resize(out_len);
+    if (compress2(out.data(), &out_len, src, src_len, Z_BEST_SPEED) != Z_OK)
+        return false;
+    out.resize(out_len);
+    return true;
+}
+
+void
+loadGzImage(const std::string &path, uint8_t *pmem, uint64_t size)
+{
+    const uint32_t chunk_size = 16384;
+
+    gzFile compressed_mem = gzopen(path.c_str(), "rb");
+    if (compressed_mem == NULL)
+        fatal("Can't open physical memory checkpoint file '%s'", path);
+
+    uint64_t curr_size = 0;
+    long* temp_page = new long[chunk_size];
+    long* pmem_current;
+    uint32_t bytes_read;
+    while (curr_size < size) {
+        bytes_read = gzread(compressed_mem, temp_page, chunk_size);
+        if (bytes_read == 0)
+            break;
+
+        assert(bytes_read % sizeof(long) == 0);
+
+        for (uint32_t x = 0; x < bytes_read / sizeof(long); x++) {
+            // Only copy bytes that are non-zero, so we don't give
+            // the VM system hell
+            if (*(temp_page + x) != 0) {
+                pmem_current = (long*)(pmem + curr_size + x * sizeof(long));
+                *pmem_current = *(temp_page + x);
+            }
+        }
+        curr_size += bytes_read;
+    }
+
+    delete[] temp_page;
+
+    if (gzclose(compressed_mem))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              path);
+}
+
+} // anonymous namespace
+
+void
+saveStoreImage(const std::string &path, const uint8_t *pmem, uint64_t size,
+               unsigned threads)
+{
+    static_assert(storeImageChunkSize % (64 * storeImagePageSize) == 0,
+                  "Chunks must cover whole bitmap words");
+
+    const uint64_t pages_per_chunk = storeImageChunkSize / storeImagePageSize;
+    uint64_t pages = divCeil(size, storeImagePageSize);
+    uint64_t chunks = divCeil(size, storeImageChunkSize);
+
+    std::vector<uint64_t> bitmap(divCeil(pages, 64), 0);
+    std::vector<ChunkEntry> index(chunks);
+
+    int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0664);
+    if (fd < 0)
+        fatal("Can't open physical memory checkpoint file '%s'\n", path);
+
+    StoreImageHeader header;
+    std::memcpy(header.magic, imageMagic, sizeof(header.magic));
+    header.version = imageVersion;
+    header.pageSize = storeImagePageSize;
+    header.chunkSize = storeImageChunkSize;
+    header.size = size;
+    header.chunks = chunks;
+
+    uint64_t bitmap_bytes = bitmap.size() * sizeof(uint64_t);
+    uint64_t index_bytes = index.size() * sizeof(ChunkEntry);
+    uint64_t offset = sizeof(header) + bitmap_bytes + index_bytes;
+
+    // the workers compress ahead of the chunk being written by at
+    // most a window of chunks, each one with its own buffer, so the
+    // file comes out in order and the same for any number of threads
+    struct Slot
+    {
+        std::vector<uint8_t> data;
+        bool ready = false;
+    };
+
+    unsigned workers = poolSize(threads, chunks);
+    uint64_t window = 4 * workers;
+    std::vector<Slot> slots(window);
+    std::mutex mtx;
+    std::condition_variable cv;
+    uint64_t next = 0;
+    uint64_t written = 0;
+    bool failed = false;
+
+    auto worker = [&]() {
+        std::vector<uint8_t> raw;
+        std::unique_lock<std::mutex> lock(mtx);
+        while (true) {
+            cv.wait(lock, [&]{
+                return next == chunks || next < written + window;
+            });
+            if (next == chunks)
+                return;
+
+            uint64_t c = next++;
+            Slot &slot = slots[c % window];
+            lock.unlock();
+
+            uint64_t start = c * storeImageChunkSize;
+            bool ok = compressChunk(pmem + start,
+                std::min(storeImageChunkSize, size - start),
+                c * pages_per_chunk, bitmap.data(), raw, slot.data);
+
+            lock.lock();
+            failed |= !ok;
+            slot.ready = true;
+            cv.notify_all();
+        }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned i = 0; i < workers; i++)
+        pool.emplace_back(worker);
+
+    bool write_ok = true;
+    for (uint64_t c = 0; c < chunks; c++) {
+        Slot &slot = slots[c % window];
+        {
+            std::unique_lock<std::mutex> lock(mtx);
+            cv.wait(lock, [&]{ return slot.ready; });
+        }
+
+        index[c].offset = offset;
+        index[c].length = slot.data.size();
+        if (write_ok && !slot.data.empty())
+            write_ok = pwriteAll(fd, slot.data.data(), slot.data.size(),
+                                 offset);
+        offset += slot.data.size();
+
+        {
+            std::lock_guard<std::mutex> lock(mtx);
+            slot.ready = false;
+            written++;
+        }
+        cv.notify_all();
+    }
+
+    for (auto &t : pool)
+        t.join();
+
+    if (failed)
+        fatal("Compression failed on physical memory checkpoint file "
+              "'%s'\n", path);
+
+    if (!write_ok ||
+        !pwriteAll(fd, &header, sizeof(header), 0) ||
+        !pwriteAll(fd, bitmap.data(), bitmap_bytes, sizeof(header)) ||
+        !pwriteAll(fd, index.data(), index_bytes,
+                   sizeof(header) + bitmap_bytes)) {
+        fatal("Write failed on physical memory checkpoint file '%s'\n",
+              path);
+    }
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              path);
+}
+
+void
+loadStoreImage(const std::string &path, uint8_t *pmem, uint64_t size,
+               unsigned threads)
+{
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        fatal("Can't open physical memory checkpoint file '%s'\n", path);
+
+    StoreImageHeader header;
+    if (!preadAll(fd, &header, sizeof(header), 0) ||
+        std::memcmp(header.magic, imageMagic, sizeof(header.magic))) {
+        // written before the chunked images
+        close(fd);
+        loadGzImage(path, pmem, size);
+        return;
+    }
+
+    fatal_if(header.version != imageVersion,
+             "Unsupported physical memory checkpoint version %d in '%s'\n",
+             header.version, path);
+    fatal_if(header.size != size,
+             "Memory range size has changed! Saw %lld, expected %lld\n",
+             header.size, size);
+    fatal_if(header.pageSize == 0 ||
+             header.chunkSize % (64 * (uint64_t)header.pageSize) ||
+             header.chunks != divCeil(size, header.chunkSize),
+             "Corrupt physical memory checkpoint file '%s'\n", path);
+
+    const uint64_t page_size = header.pageSize;
+    const uint64_t pages_per_chunk = header.chunkSize / page_size;
+    std::vector<uint64_t> bitmap(divCeil(divCeil(size, page_size), 64));
+    std::vector<ChunkEntry> index(header.chunks);
+    uint64_t bitmap_bytes = bitmap.size() * sizeof(uint64_t);
+    if (!preadAll(fd, bitmap.data(), bitmap_bytes, sizeof(header)) ||
+        !preadAll(fd, index.data(), index.size() * sizeof(ChunkEntry),
+                  sizeof(header) + bitmap_bytes)) {
+        fatal("Read failed on physical memory checkpoint file '%s'\n",
+              path);
+    }
+
+    std::atomic<uint64_t> next(0);
+    std::atomic<bool> failed(false);
+
+    auto worker = [&]() {
+        std::vector<uint8_t> comp;
+        std::vector<uint8_t> raw;
+        for (uint64_t c = next++; c < index.size(); c = next++) {
+            const ChunkEntry &entry = index[c];
+            if (entry.length == 0)
+                continue;
+
+            uint64_t start = c * header.chunkSize;
+            uint64_t len = std::min(header.chunkSize, size - start);
+            uint64_t first_page = c * pages_per_chunk;
+
+            // size of the non-zero pages
+            uint64_t raw_len = 0;
+            for (uint64_t off = 0; off < len; off += page_size) {
+                uint64_t page = first_page + off / page_size;
+                if (!(bitmap[page / 64] & ((uint64_t)1 << (page % 64))))
+                    raw_len += std::min(page_size, len - off);
+            }
+
+            comp.resize(entry.length);
+            if (!preadAll(fd, comp.data(), entry.length, entry.offset)) {
+                failed = true;
+                return;
+            }
+
+            // chunks without zero pages go straight to the store
+            uint8_t *dest = pmem + start;
+            if (raw_len != len) {
+                raw.resize(raw_len);
+                dest = raw.data();
+            }
+
+            uLongf dest_len = raw_len;
+            if (uncompress(dest, &dest_len, comp.data(), entry.length) !=
+                Z_OK || dest_len != raw_len) {
+                failed = true;
+                return;
+            }
+
+            if (raw_len == len)
+                continue;
+
+            const uint8_t *src = raw.data();
+            for (uint64_t off = 0; off < len; off += page_size) {
+                uint64_t page = first_page + off / page_size;
+                if (bitmap[page / 64] & ((uint64_t)1 << (page % 64)))
+                    continue;
+                uint64_t page_len = std::min(page_size, len - off);
+                std::memcpy(pmem + start + off, src, page_len);
+                src += page_len;
+            }
+        }
+    };
+
+    unsigned workers = poolSize(threads, index.size());
+    std::vector<std::thread> pool;
+    for (unsigned i = 1; i < workers; i++)
+        pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool)
+        t.join();
+
+    if (failed)
+        fatal("Corrupt physical memory checkpoint file '%s'\n", path);
+
+    if (close(fd))
+        fatal("Close failed on physical memory checkpoint file '%s'\n",
+              path);
+}
+
+} // namespace memory
+} // namespace gem5
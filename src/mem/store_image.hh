@@ -0,0 +1,95 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __MEM_STORE_IMAGE_HH__
+#define __MEM_STORE_IMAGE_HH__
+
+#include <cstdint>
+#include <string>
+
+namespace gem5
+{
+
+namespace memory
+{
+
+/**
+ * @file
+ * Files holding the contents of a backing store in a checkpoint.
+ *
+ * The store is split into chunks that are compressed independently by
+ * a pool of host threads. Pages that are all zero are only recorded in
+ * a bitmap, and an index with the position of each chunk lets them be
+ * read back in parallel as well. The file is laid out as
+ *
+ *   StoreImageHeader
+ *   zero page bitmap, one bit per page, 64 bit words
+ *   chunk index, offset and length of each compressed chunk
+ *   compressed chunks, with the non-zero pages of each one
+ *
+ * Images written by older versions, a single gzip stream of the whole
+ * store, can still be read.
+ */
+
+struct StoreImageHeader
+{
+    char magic[8];
+    uint32_t version;
+    uint32_t pageSize;
+    uint64_t chunkSize;
+    uint64_t size;
+    uint64_t chunks;
+};
+
+/// Pages tracked in the bitmap
+const uint32_t storeImagePageSize = 4096;
+
+/// Bytes per chunk, a multiple of 64 pages so chunks own whole words
+const uint64_t storeImageChunkSize = 1 << 20;
+
+/**
+ * Write size bytes at pmem to a chunked image at path.
+ *
+ * @param threads Host threads compressing chunks, 0 for one per core
+ */
+void saveStoreImage(const std::string &path, const uint8_t *pmem,
+                    uint64_t size, unsigned threads = 0);
+
+/**
+ * Read the image at path into pmem, either chunked or a gzip stream.
+ * Zero pages are not written, the store is assumed to be cleared.
+ *
+ * @param threads Host threads reading chunks, 0 for one per core
+ */
+void loadStoreImage(const std::string &path, uint8_t *pmem, uint64_t size,
+                    unsigned threads = 0);
+
+} // namespace memory
+} // namespace gem5
+
+#endif // __MEM_STORE_IMAGE_HH__
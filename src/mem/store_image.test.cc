@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+#include <zlib.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "mem/store_image.hh"
+
+using namespace gem5;
+using namespace gem5::memory;
+
+namespace
+{
+
+/**
+ * Fill a store the way a booted system looks like: most pages never
+ * touched, the rest a mix of compressible and random data.
+ */
+void
+fillStore(uint8_t *pmem, uint64_t size, unsigned zero_percent,
+          unsigned seed)
+{
+    std::mt19937_64 rng(seed);
+    const char text[] = "gem5 physical memory checkpoint ";
+    for (uint64_t off = 0; off < size; off += storeImagePageSize) {
+        uint64_t len = std::min<uint64_t>(storeImagePageSize, size - off);
+        unsigned kind = rng() % 100;
+        if (kind < zero_percent) {
+            std::memset(pmem + off, 0, len);
+        } else if (kind % 2) {
+            for (uint64_t b = 0; b < len; b++)
+                pmem[off + b] = text[b % (sizeof(text) - 1)];
+        } else {
+            for (uint64_t b = 0; b < len; b++)
+                pmem[off + b] = rng();
+        }
+    }
+}
+
+std::string
+tempPath(const std::string &name)
+{
+    return testing::TempDir() + "/" + name;
+}
+
+std::string
+readFile(const std::string &path)
+{
+    std::ifstream in(path, std::ios::binary);
+    return std::string(std::istreambuf_iterator<char>(in),
+                       std::istreambuf_iterator<char>());
+}
+
+/** Write a store as checkpoints did before the chunked images */
+void
+saveGzImage(const std::string &path, const uint8_t *pmem, uint64_t size)
+{
+    gzFile out = gzopen(path.c_str(), "wb");
+    ASSERT_NE(out, nullptr);
+    ASSERT_EQ(gzwrite(out, pmem, size), (int)size);
+    ASSERT_EQ(gzclose(out), Z_OK);
+}
+
+} // anonymous namespace
+
+/** A store with a partial last chunk and page comes back unchanged. */
+TEST(StoreImageTest, RoundTrip)
+{
+    const uint64_t size = 5 * storeImageChunkSize + 3 * storeImagePageSize +
+        96;
+    std::vector<uint64_t> store(size / sizeof(uint64_t));
+    uint8_t *pmem = (uint8_t *)store.data();
+    fillStore(pmem, size, 60, 1);
+    // a chunk without zero pages takes the in-place path
+    std::memset(pmem + storeImageChunkSize, 0x5a, storeImageChunkSize);
+
+    std::string path = tempPath("store_image_round_trip.pmemc");
+    saveStoreImage(path, pmem, size, 3);
+
+    std::vector<uint64_t> restored(store.size(), 0);
+    loadStoreImage(path, (uint8_t *)restored.data(), size, 2);
+    ASSERT_TRUE(restored == store);
+
+    ASSERT_LT(readFile(path).size(), size / 2);
+    std::remove(path.c_str());
+}
+
+/** An empty store only takes the header, bitmap and index. */
+TEST(StoreImageTest, AllZero)
+{
+    const uint64_t size = 4 * storeImageChunkSize;
+    std::vector<uint64_t> store(size / sizeof(uint64_t), 0);
+
+    std::string path = tempPath("store_image_zero.pmemc");
+    saveStoreImage(path, (uint8_t *)store.data(), size, 2);
+
+    uint64_t pages = size / storeImagePageSize;
+    ASSERT_EQ(readFile(path).size(), sizeof(StoreImageHeader) + pages / 8 +
+              4 * 2 * sizeof(uint64_t));
+
+    loadStoreImage(path, (uint8_t *)store.data(), size, 2);
+    for (auto w : store)
+        ASSERT_EQ(w, 0);
+    std::remove(path.c_str());
+}
+
+/** The file does not depend on the number of threads writing it. */
+TEST(StoreImageTest, Deterministic)
+{
+    const uint64_t size = 16 * storeImageChunkSize;
+    std::vector<uint64_t> store(size / sizeof(uint64_t));
+    fillStore((uint8_t *)store.data(), size, 50, 2);
+
+    std::string one = tempPath("store_image_one.pmemc");
+    std::string many = tempPath("store_image_many.pmemc");
+    saveStoreImage(one, (uint8_t *)store.data(), size, 1);
+    saveStoreImage(many, (uint8_t *)store.data(), size, 8);
+    ASSERT_EQ(readFile(one), readFile(many));
+    std::remove(one.c_str());
+    std::remove(many.c_str());
+}
+
+/** Checkpoints taken before the chunked images can be restored. */
+TEST(StoreImageTest, LegacyGzip)
+{
+    const uint64_t size = 2 * storeImageChunkSize;
+    std::vector<uint64_t> store(size / sizeof(uint64_t));
+    fillStore((uint8_t *)store.data(), size, 50, 3);
+
+    std::string path = tempPath("store_image_legacy.pmem");
+    saveGzImage(path, (uint8_t *)store.data(), size);
+
+    std::vector<uint64_t> restored(store.size(), 0);
+    loadStoreImage(path, (uint8_t *)restored.data(), size);
+    ASSERT_TRUE(restored == store);
+    std::remove(path.c_str());
+}
+
+/**
+ * Save and restore bandwidth of a store of STORE_IMAGE_BENCH_MB
+ * (128 by default) with STORE_IMAGE_BENCH_ZERO percent of zero pages
+ * (70 by default), compared with the single gzip stream.
+ */
+// Takes a while, run it with --gtest_also_run_disabled_tests
+TEST(StoreImageTest, DISABLED_Bandwidth)
+{
+    const char *mb = std::getenv("STORE_IMAGE_BENCH_MB");
+    const char *zero = std::getenv("STORE_IMAGE_BENCH_ZERO");
+    const uint64_t size = (mb ? std::strtoull(mb, nullptr, 0) : 128) << 20;
+    const unsigned zero_percent = zero ? std::atoi(zero) : 70;
+
+    std::vector<uint64_t> store(size / sizeof(uint64_t));
+    uint8_t *pmem = (uint8_t *)store.data();
+    fillStore(pmem, size, zero_percent, 4);
+    std::vector<uint64_t> restored(store.size());
+
+    auto gbps = [size](std::chrono::steady_clock::time_point start) {
+        auto stop = std::chrono::steady_clock::now();
+        double secs = std::chrono::duration<double>(stop - start).count();
+        return size / secs / 1e9;
+    };
+
+    std::string path = tempPath("store_image_bench.pmemc");
+    auto start = std::chrono::steady_clock::now();
+    saveStoreImage(path, pmem, size);
+    double save = gbps(start);
+    uint64_t file_size = readFile(path).size();
+
+    start = std::chrono::steady_clock::now();
+    loadStoreImage(path, (uint8_t *)restored.data(), size);
+    double load = gbps(start);
+    ASSERT_TRUE(restored == store);
+    std::remove(path.c_str());
+
+    std::string gz_path = tempPath("store_image_bench.pmem");
+    start = std::chrono::steady_clock::now();
+    saveGzImage(gz_path, pmem, size);
+    double gz_save = gbps(start);
+    uint64_t gz_file_size = readFile(gz_path).size();
+
+    std::fill(restored.begin(), restored.end(), 0);
+    start = std::chrono::steady_clock::now();
+    loadStoreImage(gz_path, (uint8_t *)restored.data(), size);
+    double gz_load = gbps(start);
+    ASSERT_TRUE(restored == store);
+    std::remove(gz_path.c_str());
+
+    std::cout << "Store image, " << (size >> 20) << " MiB, "
+              << zero_percent << "% zero pages: chunked save "
+              << save << " GB/s, restore " << load << " GB/s, "
+              << file_size << " bytes; gzip save " << gz_save
+              << " GB/s, restore " << gz_load << " GB/s, "
+              << gz_file_size << " bytes" << std::endl;
+}
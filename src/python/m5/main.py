@@ -128,6 +128,10 @@ def parse_options():
     option("--dot-dvfs-config", metavar="FILE", default=None,
         help="Create DOT & pdf outputs of the DVFS configuration" + \
              " [Default: %default]")
+    option("--event-queue", metavar="{list,calendar}",
+        choices=("list", "calendar"), default="list",
+        help="Keep the scheduled events in a sorted list or in a calendar " \
+        "queue, faster with many clocked objects [Default: %default]")
 
     # Debugging options
     group("Debugging Options")
@@ -235,6 +239,7 @@ def main(*args):
     m5.options = options
 
     # Set the main event queue for the main thread.
+    event.setCalendarEventQueues(options.event_queue == "calendar")
     event.mainq = event.getEventQueue(0)
     event.setEventQueue(event.mainq)
 
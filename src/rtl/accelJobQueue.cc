@@ -0,0 +1,397 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/accelJobQueue.hh"
+
+#include <algorithm>
+#include <cstring>
+
+#include "base/bitfield.hh"
+#include "base/logging.hh"
+#include "base/trace.hh"
+#include "debug/AccelJobQueue.hh"
+#include "mem/packet_access.hh"
+#include "sim/byteswap.hh"
+#include "sim/stats.hh"
+#include "sim/system.hh"
+
+namespace gem5
+{
+
+AccelJobQueue::AccelJobQueue(const Params &p) :
+    BasicPioDevice(p, SQ_BASE + p.ring_size * (SQ_ENTRY_SIZE + CQ_ENTRY_SIZE)),
+    accels(p.port_accel_ports_connection_count),
+    ringSize(p.ring_size),
+    workStealing(p.work_stealing),
+    requestorId(p.system->getRequestorId(this)),
+    sqRing(p.ring_size * SQ_ENTRY_SIZE, 0),
+    sqHead(0),
+    sqTail(0),
+    cqRing(p.ring_size * CQ_ENTRY_SIZE, 0),
+    cqHead(0),
+    cqTail(0),
+    pending(0)
+{
+    fatal_if(ringSize == 0, "%s: ring_size must not be 0\n", name());
+
+    for (int i = 0; i < accels.size(); i++) {
+        accels[i].port.reset(new AccelPort(
+            csprintf("%s.accel_ports[%d]", name(), i), this, i));
+    }
+}
+
+Port &
+AccelJobQueue::getPort(const std::string &if_name, PortID idx)
+{
+    if (if_name == "accel_ports" && idx < accels.size())
+        return *accels[idx].port;
+    return BasicPioDevice::getPort(if_name, idx);
+}
+
+bool
+AccelJobQueue::ringAccess(Addr daddr, unsigned size) const
+{
+    Addr cq_base = SQ_BASE + ringSize * SQ_ENTRY_SIZE;
+    if (daddr >= cq_base)
+        return daddr - cq_base + size <= cqRing.size();
+    return daddr - SQ_BASE + size <= sqRing.size();
+}
+
+Tick
+AccelJobQueue::read(PacketPtr pkt)
+{
+    Addr daddr = pkt->getAddr() - pioAddr;
+    Addr cq_base = SQ_BASE + ringSize * SQ_ENTRY_SIZE;
+
+    if (daddr >= SQ_BASE && !ringAccess(daddr, pkt->getSize())) {
+        warn("%s: read of %d bytes at %#x crosses a ring boundary\n",
+             name(), pkt->getSize(), daddr);
+        memset(pkt->getPtr<uint8_t>(), 0, pkt->getSize());
+    } else if (daddr >= cq_base) {
+        pkt->setData(&cqRing[daddr - cq_base]);
+    } else if (daddr >= SQ_BASE) {
+        pkt->setData(&sqRing[daddr - SQ_BASE]);
+    } else {
+        uint64_t value;
+        switch (daddr) {
+          case SQ_HEAD:
+            value = sqHead;
+            break;
+          case SQ_TAIL:
+            value = sqTail;
+            break;
+          case CQ_HEAD:
+            value = cqHead;
+            break;
+          case CQ_TAIL:
+            value = cqTail;
+            break;
+          case RING_SIZE:
+            value = ringSize;
+            break;
+          case NUM_ACCELS:
+            value = accels.size();
+            break;
+          case PENDING:
+            value = pending;
+            break;
+          default:
+            warn("%s: read of unknown register %#x\n", name(), daddr);
+            value = 0;
+            break;
+        }
+        pkt->setUintX(value, ByteOrder::little);
+    }
+
+    pkt->makeAtomicResponse();
+    return pioDelay;
+}
+
+Tick
+AccelJobQueue::write(PacketPtr pkt)
+{
+    Addr daddr = pkt->getAddr() - pioAddr;
+    Addr cq_base = SQ_BASE + ringSize * SQ_ENTRY_SIZE;
+
+    if (daddr >= cq_base) {
+        warn("%s: write to the completion ring at %#x ignored\n",
+             name(), daddr);
+    } else if (daddr >= SQ_BASE && !ringAccess(daddr, pkt->getSize())) {
+        warn("%s: write of %d bytes at %#x crosses a ring boundary, "
+             "ignored\n", name(), pkt->getSize(), daddr);
+    } else if (daddr >= SQ_BASE) {
+        pkt->writeData(&sqRing[daddr - SQ_BASE]);
+    } else {
+        uint64_t value = pkt->getUintX(ByteOrder::little);
+        switch (daddr) {
+          case SQ_TAIL:
+            if (value - sqHead > ringSize) {
+                warn("%s: doorbell %d overruns the ring (head %d), "
+                     "ignored\n", name(), value, sqHead);
+                break;
+            }
+            sqTail = value;
+            consumeDescriptors();
+            dispatch();
+            break;
+          case CQ_HEAD:
+            if (value - cqHead > cqTail - cqHead) {
+                warn("%s: CQ_HEAD %d past CQ_TAIL %d, ignored\n",
+                     name(), value, cqTail);
+                break;
+            }
+            cqHead = value;
+            drainOverflow();
+            break;
+          default:
+            warn("%s: write to read-only register %#x ignored\n",
+                 name(), daddr);
+            break;
+        }
+    }
+
+    pkt->makeAtomicResponse();
+    return pioDelay;
+}
+
+void
+AccelJobQueue::consumeDescriptors()
+{
+    fatal_if(accels.empty(), "%s: jobs submitted with no accelerator\n",
+             name());
+
+    for (; sqHead != sqTail; sqHead++) {
+        const uint8_t *desc = &sqRing[(sqHead % ringSize) * SQ_ENTRY_SIZE];
+        uint64_t words[4];
+        std::memcpy(words, desc, sizeof(words));
+        for (auto &w : words)
+            w = letoh(w);
+
+        Job job;
+        job.vaddr = words[0];
+        job.size = words[1];
+        job.tag = words[2];
+        job.priority = bits(words[3], 31, 0);
+        job.submitted = curTick();
+
+        uint64_t preferred = bits(words[3], 63, 32);
+        int accel;
+        if (preferred != 0 && preferred <= accels.size()) {
+            accel = preferred - 1;
+        } else {
+            // least loaded accelerator, counting the job it runs
+            accel = 0;
+            size_t best = accels[0].queue.size() + accels[0].busy;
+            for (int i = 1; i < accels.size(); i++) {
+                size_t load = accels[i].queue.size() + accels[i].busy;
+                if (load < best) {
+                    best = load;
+                    accel = i;
+                }
+            }
+        }
+
+        DPRINTF(AccelJobQueue, "Job %d: trace %#x size %d priority %d "
+                "queued on accel %d\n", job.tag, job.vaddr, job.size,
+                job.priority, accel);
+
+        enqueue(accel, job);
+        pending++;
+        stats.jobsSubmitted++;
+    }
+}
+
+void
+AccelJobQueue::enqueue(int accel, const Job &job)
+{
+    auto &queue = accels[accel].queue;
+    auto it = std::find_if(queue.begin(), queue.end(),
+        [&job](const Job &j) { return j.priority < job.priority; });
+    queue.insert(it, job);
+}
+
+bool
+AccelJobQueue::nextJob(int accel, Job &job)
+{
+    int victim = accel;
+    if (accels[accel].queue.empty()) {
+        if (!workStealing)
+            return false;
+
+        // steal the best job of the longest queue, its accelerator is
+        // busy and would not start it before finishing the current one
+        size_t longest = 0;
+        for (int i = 0; i < accels.size(); i++) {
+            if (accels[i].queue.size() > longest) {
+                longest = accels[i].queue.size();
+                victim = i;
+            }
+        }
+        if (longest == 0)
+            return false;
+
+        DPRINTF(AccelJobQueue, "Accel %d steals job %d from accel %d\n",
+                accel, accels[victim].queue.front().tag, victim);
+        stats.jobsStolen++;
+    }
+
+    job = accels[victim].queue.front();
+    accels[victim].queue.pop_front();
+    return true;
+}
+
+void
+AccelJobQueue::dispatch()
+{
+    for (int i = 0; i < accels.size(); i++) {
+        Accel &accel = accels[i];
+        if (accel.busy || !nextJob(i, accel.running))
+            continue;
+
+        const Job &job = accel.running;
+        accel.busy = true;
+        accel.started = curTick();
+        stats.queueingDelay.sample(curTick() - job.submitted);
+
+        DPRINTF(AccelJobQueue, "Job %d starts on accel %d\n", job.tag, i);
+
+        RequestPtr req = std::make_shared<Request>(job.vaddr, job.size,
+                                  0, requestorId, 0, 0);
+        accel.port->sendPacket(new Packet(req, MemCmd::ReadReq, job.size));
+    }
+}
+
+void
+AccelJobQueue::jobFinished(int accel_id)
+{
+    Accel &accel = accels[accel_id];
+    panic_if(!accel.busy, "%s: completion from idle accel %d\n",
+             name(), accel_id);
+
+    DPRINTF(AccelJobQueue, "Job %d finished on accel %d\n",
+            accel.running.tag, accel_id);
+
+    accel.busy = false;
+    stats.serviceTime.sample(curTick() - accel.started);
+    stats.busyTicks[accel_id] += curTick() - accel.started;
+    stats.jobsCompleted++;
+    pending--;
+
+    overflow.emplace_back(accel.running.tag, accel_id);
+    drainOverflow();
+
+    dispatch();
+}
+
+void
+AccelJobQueue::drainOverflow()
+{
+    while (!overflow.empty() && cqTail - cqHead < ringSize) {
+        uint64_t entry[2] = { htole(overflow.front().first),
+                              htole(overflow.front().second) };
+        std::memcpy(&cqRing[(cqTail % ringSize) * CQ_ENTRY_SIZE], entry,
+                    sizeof(entry));
+        overflow.pop_front();
+        cqTail++;
+    }
+}
+
+void
+AccelJobQueue::AccelPort::sendPacket(PacketPtr pkt)
+{
+    panic_if(blockedPacket != nullptr, "Should never try to send if blocked!");
+
+    if (!sendTimingReq(pkt))
+        blockedPacket = pkt;
+}
+
+bool
+AccelJobQueue::AccelPort::recvTimingResp(PacketPtr pkt)
+{
+    // the accelerator answers with a packet of its own once the whole
+    // trace has run
+    delete pkt;
+    owner->jobFinished(index);
+    return true;
+}
+
+void
+AccelJobQueue::AccelPort::recvReqRetry()
+{
+    assert(blockedPacket != nullptr);
+
+    PacketPtr pkt = blockedPacket;
+    blockedPacket = nullptr;
+    sendPacket(pkt);
+}
+
+void
+AccelJobQueue::regStats()
+{
+    BasicPioDevice::regStats();
+
+    using namespace statistics;
+
+    stats.jobsSubmitted
+        .name(name() + ".jobsSubmitted")
+        .desc("Number of jobs taken from the submission ring");
+
+    stats.jobsCompleted
+        .name(name() + ".jobsCompleted")
+        .desc("Number of jobs finished by the accelerators");
+
+    stats.jobsStolen
+        .name(name() + ".jobsStolen")
+        .desc("Number of jobs run by an accelerator other than the "
+              "one they were queued on");
+
+    stats.queueingDelay
+        .init(16)
+        .name(name() + ".queueingDelay")
+        .desc("Ticks from the doorbell to the start of a job")
+        .flags(pdf);
+
+    stats.serviceTime
+        .init(16)
+        .name(name() + ".serviceTime")
+        .desc("Ticks from the start to the completion of a job")
+        .flags(pdf);
+
+    stats.busyTicks
+        .init(std::max<size_t>(accels.size(), 1))
+        .name(name() + ".busyTicks")
+        .desc("Ticks each accelerator spent running jobs");
+
+    stats.utilisation
+        .name(name() + ".utilisation")
+        .desc("Fraction of the time each accelerator was running jobs")
+        .precision(4);
+    stats.utilisation = stats.busyTicks / simTicks;
+}
+
+} // namespace gem5
@@ -0,0 +1,210 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_ACCEL_JOB_QUEUE_HH__
+#define __RTL_ACCEL_JOB_QUEUE_HH__
+
+#include <deque>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "base/statistics.hh"
+#include "dev/io_device.hh"
+#include "mem/packet.hh"
+#include "mem/port.hh"
+#include "params/AccelJobQueue.hh"
+
+namespace gem5
+{
+
+/**
+ * Command processor in front of a pool of rtlNVDLA accelerators.
+ *
+ * The guest writes job descriptors into a submission ring mapped in
+ * the device and rings the doorbell by advancing SQ_TAIL. Jobs are
+ * queued per accelerator, ordered by priority, and handed to an
+ * accelerator as soon as it is idle, using the same start request the
+ * CPU accelerator ports send. An idle accelerator with nothing queued
+ * can steal work from the longest queue of the others. Finished jobs
+ * are reported through a completion ring that the guest drains by
+ * advancing CQ_HEAD, so a batch of jobs needs no CPU round-trip per
+ * job.
+ *
+ * Register map, all registers are 64 bit:
+ *   0x00 SQ_HEAD     next descriptor the device will read (RO)
+ *   0x08 SQ_TAIL     doorbell, one past the last valid descriptor
+ *   0x10 CQ_HEAD     next completion the guest will read
+ *   0x18 CQ_TAIL     one past the last valid completion (RO)
+ *   0x20 RING_SIZE   slots in each ring (RO)
+ *   0x28 NUM_ACCELS  accelerators attached (RO)
+ *   0x30 PENDING     jobs accepted and not finished yet (RO)
+ *
+ * Ring indices run freely, slot = index % RING_SIZE. The submission
+ * ring starts at 0x1000 with 32 byte descriptors:
+ *   0x00 trace virtual address
+ *   0x08 trace size in bytes
+ *   0x10 tag, copied to the completion
+ *   0x18 bits 31:0 priority (higher first), bits 63:32 preferred
+ *        accelerator plus one, 0 for any
+ * The completion ring follows it with 16 byte entries holding the tag
+ * and the accelerator that ran the job.
+ */
+class AccelJobQueue : public BasicPioDevice
+{
+  public:
+    enum Register
+    {
+        SQ_HEAD = 0x00,
+        SQ_TAIL = 0x08,
+        CQ_HEAD = 0x10,
+        CQ_TAIL = 0x18,
+        RING_SIZE = 0x20,
+        NUM_ACCELS = 0x28,
+        PENDING = 0x30,
+    };
+
+    static const Addr SQ_BASE = 0x1000;
+    static const unsigned SQ_ENTRY_SIZE = 32;
+    static const unsigned CQ_ENTRY_SIZE = 16;
+
+  private:
+    struct Job
+    {
+        Addr vaddr;
+        unsigned size;
+        uint32_t priority;
+        uint64_t tag;
+        Tick submitted;
+    };
+
+    /** Port towards the cpu_side of one accelerator */
+    class AccelPort : public RequestPort
+    {
+      private:
+        AccelJobQueue *owner;
+        const int index;
+
+      public:
+        /// Start request refused by the accelerator, sent on retry
+        PacketPtr blockedPacket;
+
+        AccelPort(const std::string &name, AccelJobQueue *owner, int index)
+            : RequestPort(name, owner), owner(owner), index(index),
+              blockedPacket(nullptr)
+        { }
+
+        void sendPacket(PacketPtr pkt);
+
+      protected:
+        bool recvTimingResp(PacketPtr pkt) override;
+        void recvReqRetry() override;
+    };
+
+    /** State of one accelerator of the pool */
+    struct Accel
+    {
+        std::unique_ptr<AccelPort> port;
+        /// Jobs waiting for this accelerator, highest priority first
+        std::deque<Job> queue;
+        bool busy = false;
+        Job running;
+        Tick started = 0;
+    };
+
+    std::vector<Accel> accels;
+
+    const unsigned ringSize;
+    const bool workStealing;
+    const RequestorID requestorId;
+
+    /// Submission ring, read from the device side on doorbell
+    std::vector<uint8_t> sqRing;
+    uint64_t sqHead;
+    uint64_t sqTail;
+
+    /// Completion ring, (tag, accelerator) pairs
+    std::vector<uint8_t> cqRing;
+    uint64_t cqHead;
+    uint64_t cqTail;
+
+    /// Completions waiting for room in the completion ring
+    std::deque<std::pair<uint64_t, uint64_t>> overflow;
+
+    /// Jobs accepted and not completed
+    uint64_t pending;
+
+    /** Take the descriptors up to sqTail into the accelerator queues */
+    void consumeDescriptors();
+
+    /** Queue a job on an accelerator keeping priority order */
+    void enqueue(int accel, const Job &job);
+
+    /** Start the next job on every idle accelerator */
+    void dispatch();
+
+    /** Pick the job for an idle accelerator, stealing if allowed */
+    bool nextJob(int accel, Job &job);
+
+    /** Called when an accelerator reports it has finished */
+    void jobFinished(int accel);
+
+    /** Move completions into the ring while there is room */
+    void drainOverflow();
+
+    /** Whether an access at daddr stays within one of the rings */
+    bool ringAccess(Addr daddr, unsigned size) const;
+
+    struct JobQueueStats
+    {
+        statistics::Scalar jobsSubmitted;
+        statistics::Scalar jobsCompleted;
+        statistics::Scalar jobsStolen;
+        statistics::Histogram queueingDelay;
+        statistics::Histogram serviceTime;
+        statistics::Vector busyTicks;
+        statistics::Formula utilisation;
+    };
+    JobQueueStats stats;
+
+  public:
+    PARAMS(AccelJobQueue);
+    AccelJobQueue(const Params &p);
+
+    Port &getPort(const std::string &if_name,
+                  PortID idx=InvalidPortID) override;
+
+    Tick read(PacketPtr pkt) override;
+    Tick write(PacketPtr pkt) override;
+
+    void regStats() override;
+};
+
+} // namespace gem5
+
+#endif // __RTL_ACCEL_JOB_QUEUE_HH__
@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/axi4Bridge.hh"
+
+namespace gem5
+{
+
+Axi4BridgePort::Axi4BridgePort(const std::string &name, SimObject *owner,
+                               RespFunc resp) :
+    RequestPort(name, owner),
+    respFunc(resp)
+{
+}
+
+void
+Axi4BridgePort::sendPacket(PacketPtr pkt, bool timing)
+{
+    if (!timing) {
+        sendAtomic(pkt);
+        respFunc(pkt);
+        return;
+    }
+
+    // keep the order, nothing overtakes a blocked packet
+    if (!blocked.empty() || !sendTimingReq(pkt))
+        blocked.push_back(pkt);
+}
+
+bool
+Axi4BridgePort::recvTimingResp(PacketPtr pkt)
+{
+    respFunc(pkt);
+    return true;
+}
+
+void
+Axi4BridgePort::recvReqRetry()
+{
+    while (!blocked.empty() && sendTimingReq(blocked.front()))
+        blocked.pop_front();
+}
+
+} // namespace gem5
@@ -0,0 +1,703 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_AXI4_BRIDGE_HH__
+#define __RTL_AXI4_BRIDGE_HH__
+
+#include <algorithm>
+#include <array>
+#include <bitset>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <functional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "base/intmath.hh"
+#include "base/logging.hh"
+#include "base/types.hh"
+#include "mem/packet.hh"
+#include "mem/port.hh"
+#include "mem/request.hh"
+#include "rtl/packetPool.hh"
+
+namespace gem5
+{
+
+/**
+ * Values of the AXI4 signals between a Verilated model, the AXI
+ * master, and an Axi4Bridge. The glue of the model copies the outputs
+ * of the RTL in after evaluating it and the inputs back before the
+ * next evaluation, so the bridge does not depend on the widths
+ * Verilator picked for each signal. Only the signals needed to move
+ * data are modelled: no lock, cache, prot, qos or user.
+ */
+template <unsigned DataBits>
+struct Axi4Pins
+{
+    static constexpr unsigned bytes = DataBits / 8;
+    static constexpr unsigned strbWords = (bytes + 63) / 64;
+
+    // driven by the RTL
+    bool arvalid = false;
+    uint32_t arid = 0;
+    uint64_t araddr = 0;
+    uint8_t arlen = 0;
+    uint8_t arsize = 0;
+    uint8_t arburst = 0;
+    bool rready = false;
+
+    bool awvalid = false;
+    uint32_t awid = 0;
+    uint64_t awaddr = 0;
+    uint8_t awlen = 0;
+    uint8_t awsize = 0;
+    uint8_t awburst = 0;
+
+    bool wvalid = false;
+    bool wlast = false;
+    uint8_t wdata[bytes] = {};
+    uint64_t wstrb[strbWords] = {};
+
+    bool bready = false;
+
+    // driven by the bridge
+    bool arready = false;
+    bool rvalid = false;
+    uint32_t rid = 0;
+    bool rlast = false;
+    uint8_t rresp = 0;
+    uint8_t rdata[bytes] = {};
+
+    bool awready = false;
+    bool wready = false;
+
+    bool bvalid = false;
+    uint32_t bid = 0;
+    uint8_t bresp = 0;
+};
+
+/**
+ * AXI4 slave in front of the gem5 memory system, for the AXI master
+ * interfaces of Verilated models.
+ *
+ * cycle() is called once per RTL cycle with the pins seen after the
+ * evaluation. It takes every handshake of the cycle and drives the
+ * ready, R and B signals for the next one. Bursts are turned into as
+ * few packets as possible: the bytes of all the beats are gathered
+ * and split only at maxPacket boundaries and at the end of the address
+ * windows, so a 16-beat burst of a 32-bit master is a single 64-byte
+ * packet. Write strobes become byte enables, bytes not enabled in a
+ * whole chunk are trimmed, and reads of a chunk that is already being
+ * read are merged with it. Packets come from a PacketPool, and their
+ * buffers keep their capacity. The maps of the packets in flight are
+ * reserved up front, so they do not rehash, but still allocate a node
+ * per packet.
+ *
+ * Responses go back in order per ID, and out of order between IDs,
+ * as soon as all the data of a burst is there. Writes are answered
+ * once all of their packets have been acknowledged. A FIXED burst
+ * accesses its address once, like memory would for the repeated
+ * beats. Write data must come after its address: wready stays low
+ * until there is an accepted AW waiting for data.
+ *
+ * @tparam DataBits width of the data bus
+ * @tparam IdBits width of the ID signals
+ * @tparam Outstanding read and write bursts in flight, each
+ */
+template <unsigned DataBits, unsigned IdBits, unsigned Outstanding>
+class Axi4Bridge
+{
+  public:
+    typedef Axi4Pins<DataBits> Pins;
+    /// Hands a packet to the memory system
+    typedef std::function<void(PacketPtr)> SendFunc;
+
+    static constexpr unsigned bytes = DataBits / 8;
+    static constexpr unsigned numIds = 1u << IdBits;
+
+    enum BurstType
+    {
+        BURST_FIXED = 0,
+        BURST_INCR = 1,
+        BURST_WRAP = 2
+    };
+
+    static_assert(DataBits >= 8 && isPowerOf2(DataBits),
+                  "AXI4 data width must be a power of 2 bytes");
+    static_assert(IdBits <= 12, "too many AXI4 IDs");
+    static_assert(Outstanding > 0 && Outstanding < 0x8000,
+                  "bad number of outstanding bursts");
+
+    /**
+     * @param max_packet biggest packet sent, a power of 2 up to 64
+     * @param flags request flags of every packet
+     */
+    Axi4Bridge(RequestorID id, SendFunc send, unsigned max_packet = 64,
+               Request::Flags flags = 0) :
+        pool(id, max_packet),
+        sendFunc(send),
+        maxPacket(max_packet),
+        flags(flags),
+        rSlot(-1),
+        rBeat(0),
+        bSlot(-1),
+        wSlot(-1),
+        seq(0)
+    {
+        fatal_if(!isPowerOf2(max_packet) || max_packet > 64,
+                 "AXI4 bridge packets must be a power of 2 up to 64 "
+                 "bytes, not %d\n", max_packet);
+        for (auto *list : {&reads, &writes}) {
+            list->head.fill(-1);
+            list->tail.fill(-1);
+        }
+        inflight.reserve(4 * Outstanding);
+        merge.reserve(4 * Outstanding);
+    }
+
+    /**
+     * Map the RTL addresses [base, base + size) to target onwards.
+     * Without windows addresses are used as they are.
+     */
+    void
+    addWindow(Addr base, Addr size, Addr target)
+    {
+        windows.push_back({base, size, target});
+    }
+
+    /**
+     * Take the handshakes of the RTL cycle just evaluated and drive
+     * the signals for the next one.
+     */
+    void
+    cycle(Pins &pins)
+    {
+        if (pins.arvalid && pins.arready)
+            acceptAddr(reads, pins.arid, pins.araddr, pins.arlen,
+                       pins.arsize, pins.arburst);
+        if (pins.awvalid && pins.awready) {
+            int slot = acceptAddr(writes, pins.awid, pins.awaddr,
+                                  pins.awlen, pins.awsize, pins.awburst);
+            awQueue.push_back(slot);
+        }
+        if (pins.wvalid && pins.wready)
+            acceptData(pins);
+        if (pins.rvalid && pins.rready)
+            retireReadBeat();
+        if (pins.bvalid && pins.bready) {
+            release(writes, bSlot);
+            bSlot = -1;
+        }
+
+        // send what this cycle produced in one go, a synchronous
+        // (atomic) memory can answer from within sendFunc
+        for (size_t i = 0; i < outbox.size(); i++)
+            sendFunc(outbox[i]);
+        outbox.clear();
+
+        drive(pins);
+    }
+
+    /**
+     * Response to a packet handed to sendFunc. The packet goes back
+     * to the pool.
+     */
+    void
+    recvResponse(PacketPtr pkt)
+    {
+        auto it = inflight.find(pkt);
+        panic_if(it == inflight.end(),
+                 "AXI4 bridge got a response it did not ask for\n");
+        const InFlight &f = it->second;
+
+        if (f.write) {
+            writes.slots[f.targets[0].slot].pending--;
+        } else {
+            const uint8_t *data = pkt->getConstPtr<uint8_t>();
+            for (unsigned t = 0; t < f.num; t++) {
+                const Target &tgt = f.targets[t];
+                Burst &b = reads.slots[tgt.slot];
+                memcpy(&b.data[tgt.bufOff], data + tgt.pktOff, tgt.len);
+                b.pending--;
+            }
+            auto m = merge.find(f.chunk);
+            if (m != merge.end() && m->second == pkt)
+                merge.erase(m);
+        }
+
+        inflight.erase(it);
+        pool.release(pkt);
+    }
+
+    /// Nothing accepted from the RTL is left to do
+    bool
+    idle() const
+    {
+        return reads.used == 0 && writes.used == 0 && outbox.empty();
+    }
+
+    /// Packets waiting for their response
+    size_t packetsInFlight() const { return inflight.size(); }
+
+    /// Bursts accepted from the RTL
+    uint64_t bursts = 0;
+    /// Packets sent to memory
+    uint64_t packets = 0;
+    /// Read chunks served by a packet already in flight
+    uint64_t merged = 0;
+    /// Data beats moved on the R and W channels
+    uint64_t beats = 0;
+
+    /// Packets handed to sendFunc, also needed to size the port queue
+    PacketPool pool;
+
+  private:
+    struct Window
+    {
+        Addr base;
+        Addr size;
+        Addr target;
+    };
+
+    struct Burst
+    {
+        bool valid = false;
+        uint32_t id = 0;
+        uint64_t seq = 0;
+        Addr addr = 0;
+        unsigned beatsTotal = 0;
+        unsigned size = 0;
+        uint8_t type = 0;
+        /// first byte covered by data
+        Addr lo = 0;
+        std::vector<uint8_t> data;
+        /// byte enables of a write
+        std::vector<uint8_t> enable;
+        /// W beats received, or R beats returned
+        unsigned beatsDone = 0;
+        /// packets of the burst waiting for their response
+        unsigned pending = 0;
+        /// all the packets of the burst have been sent
+        bool issued = false;
+        /// next burst with the same ID
+        int next = -1;
+    };
+
+    /// The bursts of one direction, in a list per ID
+    struct BurstTable
+    {
+        std::array<Burst, Outstanding> slots;
+        std::array<int, numIds> head;
+        std::array<int, numIds> tail;
+        std::vector<int> freeSlots;
+        unsigned used = 0;
+
+        BurstTable()
+        {
+            for (int i = Outstanding - 1; i >= 0; i--)
+                freeSlots.push_back(i);
+        }
+    };
+
+    /// Where the data of a read packet goes
+    struct Target
+    {
+        uint16_t slot;
+        uint16_t pktOff;
+        uint16_t len;
+        uint32_t bufOff;
+    };
+
+    struct InFlight
+    {
+        bool write;
+        unsigned num;
+        Addr chunk;
+        std::array<Target, 4> targets;
+    };
+
+    const SendFunc sendFunc;
+    const unsigned maxPacket;
+    const Request::Flags flags;
+    std::vector<Window> windows;
+
+    BurstTable reads;
+    BurstTable writes;
+    /// write bursts waiting for data, in AW order
+    std::deque<int> awQueue;
+
+    /// read burst being returned on R and its next beat
+    int rSlot;
+    unsigned rBeat;
+    /// write burst being answered on B
+    int bSlot;
+    /// write burst the W beats go to
+    int wSlot;
+    uint64_t seq;
+
+    std::vector<PacketPtr> outbox;
+    std::unordered_map<PacketPtr, InFlight> inflight;
+    /// read packets in flight by chunk address, for merging
+    std::unordered_map<Addr, PacketPtr> merge;
+
+    /** Address of beat i of a burst */
+    static Addr
+    beatAddr(const Burst &b, unsigned i)
+    {
+        Addr aligned = b.addr & ~(Addr)(b.size - 1);
+        switch (b.type) {
+          case BURST_FIXED:
+            return b.addr;
+          case BURST_WRAP: {
+            Addr wrap = (Addr)b.size * b.beatsTotal;
+            Addr lower = b.addr & ~(wrap - 1);
+            Addr a = aligned + (Addr)i * b.size;
+            return a >= lower + wrap ? a - wrap : a;
+          }
+          default:
+            return i == 0 ? b.addr : aligned + (Addr)i * b.size;
+        }
+    }
+
+    /** Data bus lanes [lo, hi) used by beat i */
+    static void
+    beatLanes(const Burst &b, unsigned i, unsigned &lo, unsigned &hi)
+    {
+        Addr a = beatAddr(b, i);
+        lo = a & (bytes - 1);
+        hi = ((a & ~(Addr)(b.size - 1)) & (bytes - 1)) + b.size;
+    }
+
+    /** Window of an RTL address, end is where the next packet starts */
+    Addr
+    translate(Addr addr, Addr &end) const
+    {
+        if (windows.empty()) {
+            end = MaxAddr;
+            return addr;
+        }
+        for (const Window &w : windows) {
+            if (addr >= w.base && addr - w.base < w.size) {
+                end = w.base + w.size;
+                return w.target + (addr - w.base);
+            }
+        }
+        panic("AXI4 bridge: address %#x is not in any window\n", addr);
+    }
+
+    int
+    acceptAddr(BurstTable &table, uint32_t id, Addr addr, uint8_t len,
+               uint8_t size_log, uint8_t type)
+    {
+        panic_if(table.freeSlots.empty(),
+                 "AXI4 bridge accepted too many bursts\n");
+        panic_if(type > BURST_WRAP, "AXI4 reserved burst type\n");
+        panic_if((1u << size_log) > bytes,
+                 "AXI4 beat of %d bytes on a %d byte bus\n",
+                 1u << size_log, bytes);
+
+        int slot = table.freeSlots.back();
+        table.freeSlots.pop_back();
+        table.used++;
+
+        Burst &b = table.slots[slot];
+        b.valid = true;
+        b.id = id & (numIds - 1);
+        b.seq = seq++;
+        b.addr = addr;
+        b.beatsTotal = (unsigned)len + 1;
+        b.size = 1u << size_log;
+        b.type = type;
+        b.beatsDone = 0;
+        b.pending = 0;
+        b.issued = false;
+        b.next = -1;
+
+        Addr hi;
+        if (type == BURST_FIXED) {
+            b.lo = addr;
+            hi = (addr & ~(Addr)(b.size - 1)) + b.size;
+        } else if (type == BURST_WRAP) {
+            Addr wrap = (Addr)b.size * b.beatsTotal;
+            b.lo = addr & ~(wrap - 1);
+            hi = b.lo + wrap;
+        } else {
+            b.lo = addr;
+            hi = (addr & ~(Addr)(b.size - 1)) + (Addr)b.size * b.beatsTotal;
+        }
+        // keeps its capacity from the previous bursts of the slot
+        b.data.resize(hi - b.lo);
+
+        if (table.tail[b.id] >= 0)
+            table.slots[table.tail[b.id]].next = slot;
+        else
+            table.head[b.id] = slot;
+        table.tail[b.id] = slot;
+
+        bursts++;
+        if (&table == &reads)
+            issueRead(slot);
+        else
+            b.enable.assign(b.data.size(), 0);
+        return slot;
+    }
+
+    /** Free a burst, it must be the oldest of its ID */
+    void
+    release(BurstTable &table, int slot)
+    {
+        Burst &b = table.slots[slot];
+        assert(table.head[b.id] == slot);
+        table.head[b.id] = b.next;
+        if (b.next < 0)
+            table.tail[b.id] = -1;
+        b.valid = false;
+        table.freeSlots.push_back(slot);
+        table.used--;
+    }
+
+    void
+    issueRead(int slot)
+    {
+        Burst &b = reads.slots[slot];
+        Addr hi = b.lo + b.data.size();
+        for (Addr a = b.lo; a < hi; ) {
+            Addr win_end;
+            Addr target = translate(a, win_end);
+            Addr next = std::min({hi, roundDown(a, maxPacket) + maxPacket,
+                                  win_end});
+            unsigned len = next - a;
+            Addr chunk = roundDown(target, maxPacket);
+
+            Target tgt;
+            tgt.slot = slot;
+            tgt.len = len;
+            tgt.bufOff = a - b.lo;
+
+            auto m = merge.find(chunk);
+            if (m != merge.end()) {
+                PacketPtr pkt = m->second;
+                InFlight &f = inflight[pkt];
+                if (target >= pkt->getAddr() &&
+                    target + len <= pkt->getAddr() + pkt->getSize() &&
+                    f.num < f.targets.size()) {
+                    tgt.pktOff = target - pkt->getAddr();
+                    f.targets[f.num++] = tgt;
+                    b.pending++;
+                    merged++;
+                    a = next;
+                    continue;
+                }
+            }
+
+            PacketPtr pkt = pool.getRead(target, len, flags);
+            tgt.pktOff = 0;
+            InFlight &f = inflight[pkt];
+            f.write = false;
+            f.num = 1;
+            f.chunk = chunk;
+            f.targets[0] = tgt;
+            merge[chunk] = pkt;
+            b.pending++;
+            outbox.push_back(pkt);
+            packets++;
+            a = next;
+        }
+        b.issued = true;
+    }
+
+    void
+    issueWrite(int slot)
+    {
+        Burst &b = writes.slots[slot];
+        Addr hi = b.lo + b.data.size();
+        for (Addr a = b.lo; a < hi; ) {
+            Addr win_end;
+            Addr target = translate(a, win_end);
+            Addr next = std::min({hi, roundDown(a, maxPacket) + maxPacket,
+                                  win_end});
+
+            // trim the chunk to the bytes enabled in it
+            unsigned first = a - b.lo;
+            unsigned last = next - b.lo;
+            while (first < last && !b.enable[first])
+                first++;
+            while (last > first && !b.enable[last - 1])
+                last--;
+            if (first < last) {
+                uint64_t mask = 0;
+                for (unsigned i = first; i < last; i++)
+                    mask |= (uint64_t)(b.enable[i] != 0) << (i - first);
+                Addr start = target + (first - (a - b.lo));
+                PacketPtr pkt = pool.getWrite(start, last - first, flags,
+                                              &b.data[first], mask);
+                InFlight &f = inflight[pkt];
+                f.write = true;
+                f.num = 1;
+                f.chunk = roundDown(start, maxPacket);
+                f.targets[0].slot = slot;
+                // later reads of the chunk must see the write
+                merge.erase(f.chunk);
+                b.pending++;
+                outbox.push_back(pkt);
+                packets++;
+            }
+            a = next;
+        }
+        b.issued = true;
+    }
+
+    void
+    acceptData(const Pins &pins)
+    {
+        assert(wSlot >= 0);
+        Burst &b = writes.slots[wSlot];
+        unsigned lo, hi;
+        beatLanes(b, b.beatsDone, lo, hi);
+        Addr base = beatAddr(b, b.beatsDone);
+        for (unsigned l = lo; l < hi; l++) {
+            if (!((pins.wstrb[l / 64] >> (l % 64)) & 1))
+                continue;
+            unsigned off = base + (l - lo) - b.lo;
+            b.data[off] = pins.wdata[l];
+            b.enable[off] = 1;
+        }
+        b.beatsDone++;
+        beats++;
+
+        if (pins.wlast != (b.beatsDone == b.beatsTotal))
+            warn_once("AXI4 bridge: wlast does not match awlen\n");
+        if (b.beatsDone == b.beatsTotal) {
+            int slot = wSlot;
+            awQueue.pop_front();
+            wSlot = -1;
+            issueWrite(slot);
+        }
+    }
+
+    void
+    retireReadBeat()
+    {
+        assert(rSlot >= 0);
+        rBeat++;
+        beats++;
+        if (rBeat == reads.slots[rSlot].beatsTotal) {
+            release(reads, rSlot);
+            rSlot = -1;
+            rBeat = 0;
+        }
+    }
+
+    /** Oldest burst of the table that is ready to be answered */
+    int
+    pickReady(const BurstTable &table, bool write) const
+    {
+        int best = -1;
+        for (unsigned id = 0; id < numIds; id++) {
+            int slot = table.head[id];
+            if (slot < 0)
+                continue;
+            const Burst &b = table.slots[slot];
+            bool ready = b.issued && b.pending == 0 &&
+                (!write || b.beatsDone == b.beatsTotal);
+            if (ready && (best < 0 || b.seq < table.slots[best].seq))
+                best = slot;
+        }
+        return best;
+    }
+
+    void
+    drive(Pins &pins)
+    {
+        pins.arready = reads.used < Outstanding;
+        pins.awready = writes.used < Outstanding;
+
+        if (wSlot < 0 && !awQueue.empty())
+            wSlot = awQueue.front();
+        pins.wready = wSlot >= 0;
+
+        if (rSlot < 0)
+            rSlot = pickReady(reads, false);
+        pins.rvalid = rSlot >= 0;
+        if (pins.rvalid) {
+            const Burst &b = reads.slots[rSlot];
+            unsigned lo, hi;
+            beatLanes(b, rBeat, lo, hi);
+            Addr base = beatAddr(b, rBeat);
+            memset(pins.rdata, 0, bytes);
+            memcpy(pins.rdata + lo, &b.data[base - b.lo], hi - lo);
+            pins.rid = b.id;
+            pins.rlast = rBeat + 1 == b.beatsTotal;
+            pins.rresp = 0;
+        }
+
+        if (bSlot < 0)
+            bSlot = pickReady(writes, true);
+        pins.bvalid = bSlot >= 0;
+        if (pins.bvalid) {
+            pins.bid = writes.slots[bSlot].id;
+            pins.bresp = 0;
+        }
+    }
+};
+
+/**
+ * Request port of an Axi4Bridge. Packets are sent as they come, or
+ * queued while the peer asks to retry, and responses are handed to
+ * the bridge. In atomic mode every packet gets its response at once.
+ */
+class Axi4BridgePort : public RequestPort
+{
+  public:
+    typedef std::function<void(PacketPtr)> RespFunc;
+
+    Axi4BridgePort(const std::string &name, SimObject *owner,
+                   RespFunc resp);
+
+    /** Send a packet, in timing or atomic mode */
+    void sendPacket(PacketPtr pkt, bool timing);
+
+    /// Packets waiting for a retry
+    size_t queued() const { return blocked.size(); }
+
+  protected:
+    bool recvTimingResp(PacketPtr pkt) override;
+    void recvReqRetry() override;
+    void recvRangeChange() override { }
+
+  private:
+    RespFunc respFunc;
+    std::deque<PacketPtr> blocked;
+};
+
+} // namespace gem5
+
+#endif // __RTL_AXI4_BRIDGE_HH__
@@ -0,0 +1,346 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+#include <deque>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "rtl/axi4Bridge.hh"
+
+using namespace gem5;
+
+// The Request constructor needs a valid current tick
+GTestTickHandler tickHandler;
+
+namespace
+{
+
+/**
+ * Memory behind the bridge. Packets are kept until respond() is
+ * called, reads return the low byte of the address of every byte.
+ */
+template <class Bridge>
+struct FakeMemory
+{
+    Bridge *bridge = nullptr;
+    std::deque<PacketPtr> pending;
+    std::vector<PacketPtr> seen;
+    std::vector<std::vector<bool>> enables;
+    uint8_t bytes[0x10000] = {};
+
+    void
+    send(PacketPtr pkt)
+    {
+        seen.push_back(pkt);
+        enables.push_back(pkt->req->getByteEnable());
+        pending.push_back(pkt);
+    }
+
+    void
+    access(PacketPtr pkt)
+    {
+        Addr a = pkt->getAddr() & 0xffff;
+        if (pkt->isRead()) {
+            uint8_t *d = pkt->getPtr<uint8_t>();
+            for (unsigned i = 0; i < pkt->getSize(); i++)
+                d[i] = (a + i) & 0xff;
+        } else {
+            const uint8_t *d = pkt->getConstPtr<uint8_t>();
+            const std::vector<bool> &be = pkt->req->getByteEnable();
+            for (unsigned i = 0; i < pkt->getSize(); i++) {
+                if (be.empty() || be[i])
+                    bytes[a + i] = d[i];
+            }
+        }
+        pkt->makeResponse();
+    }
+
+    /** Answer the pending packet i, 0 being the oldest */
+    void
+    respond(size_t i = 0)
+    {
+        PacketPtr pkt = pending[i];
+        pending.erase(pending.begin() + i);
+        access(pkt);
+        bridge->recvResponse(pkt);
+    }
+
+    void
+    respondAll()
+    {
+        while (!pending.empty())
+            respond();
+    }
+};
+
+typedef Axi4Bridge<32, 4, 8> NarrowBridge;
+typedef Axi4Bridge<512, 4, 8> WideBridge;
+
+template <class Bridge>
+struct Harness
+{
+    FakeMemory<Bridge> mem;
+    Bridge bridge;
+    typename Bridge::Pins pins;
+
+    Harness() :
+        bridge(0, [this](PacketPtr pkt) { mem.send(pkt); })
+    {
+        mem.bridge = &bridge;
+        bridge.cycle(pins);
+    }
+
+    void
+    read(uint32_t id, Addr addr, unsigned beats, unsigned size_log,
+         uint8_t burst = Bridge::BURST_INCR)
+    {
+        ASSERT_TRUE(pins.arready);
+        pins.arvalid = true;
+        pins.arid = id;
+        pins.araddr = addr;
+        pins.arlen = beats - 1;
+        pins.arsize = size_log;
+        pins.arburst = burst;
+        bridge.cycle(pins);
+        pins.arvalid = false;
+    }
+
+    /** Answer every packet and let the bridge see the responses */
+    void
+    respondAll()
+    {
+        mem.respondAll();
+        bridge.cycle(pins);
+    }
+
+    /** Take one R beat, false if there was none */
+    bool
+    takeBeat(std::vector<uint8_t> &data, uint32_t &id, bool &last)
+    {
+        pins.rready = true;
+        bool valid = pins.rvalid;
+        if (valid) {
+            data.assign(pins.rdata, pins.rdata + Bridge::bytes);
+            id = pins.rid;
+            last = pins.rlast;
+        }
+        bridge.cycle(pins);
+        pins.rready = false;
+        return valid;
+    }
+};
+
+} // anonymous namespace
+
+/** The beats of a narrow burst become a single line-sized packet. */
+TEST(Axi4BridgeTest, BurstCoalescing)
+{
+    Harness<NarrowBridge> h;
+    h.read(1, 0x1000, 16, 2);
+
+    ASSERT_EQ(h.mem.seen.size(), 1);
+    ASSERT_EQ(h.mem.seen[0]->getAddr(), 0x1000);
+    ASSERT_EQ(h.mem.seen[0]->getSize(), 64);
+    h.respondAll();
+
+    for (unsigned beat = 0; beat < 16; beat++) {
+        std::vector<uint8_t> data;
+        uint32_t id;
+        bool last;
+        ASSERT_TRUE(h.takeBeat(data, id, last));
+        ASSERT_EQ(id, 1);
+        ASSERT_EQ(last, beat == 15);
+        for (unsigned i = 0; i < 4; i++)
+            ASSERT_EQ(data[i], (beat * 4 + i) & 0xff);
+    }
+    ASSERT_TRUE(h.bridge.idle());
+}
+
+/** A burst crossing lines is split at the line boundaries. */
+TEST(Axi4BridgeTest, BurstSplitting)
+{
+    Harness<WideBridge> h;
+    h.read(0, 0x1020, 4, 6);
+
+    // 0x1020 is not aligned to the bus, the first beat is shorter
+    ASSERT_EQ(h.mem.seen.size(), 4);
+    ASSERT_EQ(h.mem.seen[0]->getAddr(), 0x1020);
+    ASSERT_EQ(h.mem.seen[0]->getSize(), 32);
+    ASSERT_EQ(h.mem.seen[3]->getAddr(), 0x10c0);
+    ASSERT_EQ(h.mem.seen[3]->getSize(), 64);
+    h.respondAll();
+
+    std::vector<uint8_t> data;
+    uint32_t id;
+    bool last;
+    ASSERT_TRUE(h.takeBeat(data, id, last));
+    ASSERT_EQ(data[0x20], 0x20);
+    ASSERT_EQ(data[0], 0);
+}
+
+/** Strobes become byte enables and empty chunks are not sent. */
+TEST(Axi4BridgeTest, WriteStrobes)
+{
+    Harness<WideBridge> h;
+    auto &p = h.pins;
+
+    p.awvalid = true;
+    p.awid = 2;
+    p.awaddr = 0x2000;
+    p.awlen = 1;
+    p.awsize = 6;
+    p.awburst = WideBridge::BURST_INCR;
+    h.bridge.cycle(p);
+    p.awvalid = false;
+    ASSERT_TRUE(p.wready);
+
+    // first beat: bytes 4 and 6, second beat: nothing
+    for (unsigned i = 0; i < 64; i++)
+        p.wdata[i] = 0xa0 + i;
+    p.wvalid = true;
+    p.wstrb[0] = 0x50;
+    p.wlast = false;
+    h.bridge.cycle(p);
+    p.wstrb[0] = 0;
+    p.wlast = true;
+    h.bridge.cycle(p);
+    p.wvalid = false;
+
+    ASSERT_EQ(h.mem.seen.size(), 1);
+    PacketPtr pkt = h.mem.seen[0];
+    ASSERT_EQ(pkt->getAddr(), 0x2004);
+    ASSERT_EQ(pkt->getSize(), 3);
+    std::vector<bool> expected = {true, false, true};
+    ASSERT_EQ(h.mem.enables[0], expected);
+
+    ASSERT_FALSE(p.bvalid);
+    h.respondAll();
+    ASSERT_TRUE(p.bvalid);
+    ASSERT_EQ(p.bid, 2);
+    ASSERT_EQ(h.mem.bytes[0x2004], 0xa4);
+    ASSERT_EQ(h.mem.bytes[0x2005], 0);
+    ASSERT_EQ(h.mem.bytes[0x2006], 0xa6);
+
+    p.bready = true;
+    h.bridge.cycle(p);
+    ASSERT_FALSE(p.bvalid);
+    ASSERT_TRUE(h.bridge.idle());
+}
+
+/** Responses are in order per ID and out of order between IDs. */
+TEST(Axi4BridgeTest, ReorderById)
+{
+    Harness<WideBridge> h;
+    h.read(1, 0x1000, 1, 6);
+    h.read(1, 0x2000, 1, 6);
+    h.read(2, 0x3000, 1, 6);
+    ASSERT_EQ(h.mem.pending.size(), 3);
+
+    // memory answers the youngest first
+    h.mem.respond(2);
+    h.mem.respond(1);
+    h.bridge.cycle(h.pins);
+
+    std::vector<uint32_t> order;
+    std::vector<uint8_t> data;
+    uint32_t id;
+    bool last;
+    while (h.takeBeat(data, id, last))
+        order.push_back(id);
+    // the second read of ID 1 waits for the first one
+    ASSERT_EQ(order, std::vector<uint32_t>({2}));
+
+    h.mem.respond(0);
+    h.bridge.cycle(h.pins);
+    while (h.takeBeat(data, id, last))
+        order.push_back(id);
+    ASSERT_EQ(order, std::vector<uint32_t>({2, 1, 1}));
+    ASSERT_TRUE(h.bridge.idle());
+}
+
+/** Reads of a chunk being read are served by the same packet. */
+TEST(Axi4BridgeTest, ReadMerging)
+{
+    Harness<NarrowBridge> h;
+    h.read(0, 0x1000, 4, 2);
+    h.read(1, 0x1008, 2, 2);
+    ASSERT_EQ(h.mem.seen.size(), 1);
+    ASSERT_EQ(h.bridge.merged, 1);
+
+    h.respondAll();
+    std::vector<uint8_t> data;
+    uint32_t id;
+    bool last;
+    unsigned beats = 0;
+    while (h.takeBeat(data, id, last)) {
+        if (beats == 4) {
+            ASSERT_EQ(id, 1);
+            ASSERT_EQ(data[0], 0x08);
+        }
+        beats++;
+    }
+    ASSERT_EQ(beats, 6);
+    ASSERT_EQ(h.bridge.pool.allocs, 1);
+}
+
+/** Windows translate the RTL addresses and split the bursts. */
+TEST(Axi4BridgeTest, AddressWindows)
+{
+    Harness<NarrowBridge> h;
+    h.bridge.addWindow(0x50000000, 0x20, 0x80000000);
+    h.bridge.addWindow(0x50000020, 0x20, 0x90000000);
+    h.read(0, 0x50000010, 8, 2);
+
+    ASSERT_EQ(h.mem.seen.size(), 2);
+    ASSERT_EQ(h.mem.seen[0]->getAddr(), 0x80000010);
+    ASSERT_EQ(h.mem.seen[0]->getSize(), 16);
+    ASSERT_EQ(h.mem.seen[1]->getAddr(), 0x90000000);
+    ASSERT_EQ(h.mem.seen[1]->getSize(), 16);
+}
+
+/** WRAP bursts start at the critical word and wrap in their window. */
+TEST(Axi4BridgeTest, WrapBurst)
+{
+    Harness<NarrowBridge> h;
+    h.read(0, 0x1038, 4, 2, NarrowBridge::BURST_WRAP);
+    ASSERT_EQ(h.mem.seen.size(), 1);
+    ASSERT_EQ(h.mem.seen[0]->getAddr(), 0x1030);
+    ASSERT_EQ(h.mem.seen[0]->getSize(), 16);
+    h.respondAll();
+
+    std::vector<uint8_t> data;
+    uint32_t id;
+    bool last;
+    std::vector<unsigned> words;
+    while (h.takeBeat(data, id, last))
+        words.push_back(data[0]);
+    ASSERT_EQ(words, std::vector<unsigned>({0x38, 0x3c, 0x30, 0x34}));
+}
@@ -0,0 +1,104 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/axiTraceRecorder.hh"
+
+#include "base/logging.hh"
+#include "config/have_protobuf.hh"
+#include "sim/core.hh"
+
+#if HAVE_PROTOBUF
+#include "proto/packet.pb.h"
+#include "proto/protoio.hh"
+#endif
+
+namespace gem5
+{
+
+AxiTraceRecorder::AxiTraceRecorder(const std::string &filename,
+                                   const std::string &obj_id, Tick period) :
+    stream(nullptr),
+    period(period),
+    firstCycle(0),
+    nextId(1),
+    lastResponse(0)
+{
+#if HAVE_PROTOBUF
+    stream = new ProtoOutputStream(filename);
+
+    ProtoMessage::PacketHeader header_msg;
+    header_msg.set_obj_id(obj_id);
+    header_msg.set_tick_freq(sim_clock::Frequency);
+    stream->write(header_msg);
+#else
+    fatal("Recording %s needs gem5 built with protobuf\n", filename);
+#endif
+}
+
+AxiTraceRecorder::~AxiTraceRecorder()
+{
+    close();
+}
+
+uint64_t
+AxiTraceRecorder::request(uint64_t cycle, MemCmd cmd, Addr addr,
+                          unsigned size, Request::FlagsType flags)
+{
+    if (nextId == 1)
+        firstCycle = cycle;
+    uint64_t id = nextId++;
+
+#if HAVE_PROTOBUF
+    if (stream) {
+        ProtoMessage::Packet pkt_msg;
+        pkt_msg.set_tick((cycle - firstCycle) * period);
+        pkt_msg.set_cmd(cmd.toInt());
+        pkt_msg.set_addr(addr);
+        pkt_msg.set_size(size);
+        pkt_msg.set_flags(flags);
+        pkt_msg.set_pkt_id(id);
+        if (lastResponse != 0)
+            pkt_msg.set_dep_id(lastResponse);
+        stream->write(pkt_msg);
+    }
+#endif
+
+    return id;
+}
+
+void
+AxiTraceRecorder::close()
+{
+#if HAVE_PROTOBUF
+    // deleting the stream flushes it
+    delete stream;
+#endif
+    stream = nullptr;
+}
+
+} // namespace gem5
@@ -0,0 +1,102 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_AXI_TRACE_RECORDER_HH__
+#define __RTL_AXI_TRACE_RECORDER_HH__
+
+#include <cstdint>
+#include <string>
+
+#include "base/types.hh"
+#include "mem/packet.hh"
+#include "mem/request.hh"
+
+class ProtoOutputStream;
+
+namespace gem5
+{
+
+/**
+ * Writes the AXI requests of an NVDLA to a packet trace (see
+ * proto/packet.proto) that TraceGen can replay.
+ *
+ * The time of a request is the NVDLA cycle it was issued in,
+ * counted from the first recorded request and converted to ticks
+ * with the NVDLA clock period. Cycles in which the NVDLA was not
+ * running a trace do not show up, so back to back traces are
+ * replayed back to back. Every request gets a sequential pkt_id and,
+ * as dep_id, the pkt_id of the last response the NVDLA had received
+ * when it was issued.
+ */
+class AxiTraceRecorder
+{
+  private:
+    ProtoOutputStream *stream;
+
+    /// Ticks per NVDLA cycle
+    const Tick period;
+
+    /// Cycle of the first request, time zero of the trace
+    uint64_t firstCycle;
+
+    /// pkt_id of the next request, ids start at 1
+    uint64_t nextId;
+
+    /// pkt_id of the last response seen, 0 for none
+    uint64_t lastResponse;
+
+  public:
+    /**
+     * Open filename, compressed if it ends in .gz, and write the
+     * header with obj_id.
+     */
+    AxiTraceRecorder(const std::string &filename, const std::string &obj_id,
+                     Tick period);
+    ~AxiTraceRecorder();
+
+    /**
+     * Record a request issued at the given NVDLA cycle.
+     *
+     * @return The pkt_id of the request, to pass to response()
+     */
+    uint64_t request(uint64_t cycle, MemCmd cmd, Addr addr, unsigned size,
+                     Request::FlagsType flags);
+
+    /** The response to request id reached the NVDLA */
+    void response(uint64_t id) { lastResponse = id; }
+
+    /** Flush and close the file, nothing is recorded after this */
+    void close();
+
+    /// Number of requests recorded
+    uint64_t records() const { return nextId - 1; }
+};
+
+} // namespace gem5
+
+#endif // __RTL_AXI_TRACE_RECORDER_HH__
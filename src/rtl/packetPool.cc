@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/packetPool.hh"
+
+#include <new>
+
+#include "base/logging.hh"
+
+namespace gem5
+{
+
+PacketPool::PacketPool(RequestorID id, unsigned max_size) :
+    requestorId(id),
+    maxSize(max_size),
+    allocs(0),
+    reqAllocs(0),
+    reuses(0)
+{
+    byteEnable.reserve(maxSize);
+}
+
+PacketPool::~PacketPool()
+{
+    // packets still in flight belong to the memory system by now,
+    // we can only free the ones that came back
+    for (auto entry : freeList) {
+        delete entry->pkt;
+        delete entry;
+    }
+}
+
+PacketPtr
+PacketPool::get(MemCmd cmd, Addr paddr, unsigned size, Request::Flags flags)
+{
+    if (size > maxSize) {
+        // too big for the pool, fall back to a regular packet
+        RequestPtr req = std::make_shared<Request>(paddr, size, flags,
+                                                   requestorId);
+        PacketPtr pkt = new Packet(req, cmd);
+        pkt->allocate();
+        allocs++;
+        reqAllocs++;
+        return pkt;
+    }
+
+    PoolEntry *entry;
+    if (freeList.empty()) {
+        entry = new PoolEntry;
+        entry->data.resize(maxSize);
+        allocs++;
+    } else {
+        entry = freeList.back();
+        freeList.pop_back();
+        // drop the reference the old packet holds to the request
+        entry->pkt->~Packet();
+        reuses++;
+    }
+
+    if (entry->req && entry->req.use_count() == 1) {
+        entry->req->setVirt(paddr, size, flags, requestorId, 0);
+        entry->req->setPaddr(paddr);
+        byteEnable.assign(size, true);
+        entry->req->setByteEnable(byteEnable);
+    } else {
+        // first use, or somebody in the memory system still holds it
+        entry->req = std::make_shared<Request>(paddr, size, flags,
+                                               requestorId);
+        reqAllocs++;
+    }
+
+    if (entry->pkt)
+        new (entry->pkt) Packet(entry->req, cmd);
+    else
+        entry->pkt = new Packet(entry->req, cmd);
+
+    entry->pkt->dataStatic(entry->data.data());
+    entry->pkt->pushSenderState(entry);
+
+    return entry->pkt;
+}
+
+PacketPtr
+PacketPool::getRead(Addr paddr, unsigned size, Request::Flags flags)
+{
+    return get(MemCmd::ReadReq, paddr, size, flags);
+}
+
+PacketPtr
+PacketPool::getWrite(Addr paddr, unsigned size, Request::Flags flags,
+                     const uint8_t *data, uint64_t mask)
+{
+    PacketPtr pkt = get(MemCmd::WriteReq, paddr, size, flags);
+    // copy the data before masking, masked writes can't be accessed
+    pkt->setData(data);
+
+    uint64_t full_mask = size >= 64 ? ~(uint64_t)0 :
+                                      (((uint64_t)1 << size) - 1);
+    if ((mask & full_mask) != full_mask) {
+        byteEnable.resize(size);
+        for (int i = 0; i < size; i++)
+            byteEnable[i] = (mask >> i) & 1;
+        pkt->req->setByteEnable(byteEnable);
+    }
+
+    return pkt;
+}
+
+void
+PacketPool::release(PacketPtr pkt)
+{
+    PoolEntry *entry = pkt->findNextSenderState<PoolEntry>();
+    if (!entry) {
+        delete pkt;
+        return;
+    }
+
+    panic_if(pkt->popSenderState() != entry,
+             "Pooled packet returned with foreign sender state\n");
+    freeList.push_back(entry);
+}
+
+} // namespace gem5
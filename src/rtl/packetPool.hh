@@ -0,0 +1,110 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_PACKET_POOL_HH__
+#define __RTL_PACKET_POOL_HH__
+
+#include <cstdint>
+#include <vector>
+
+#include "mem/packet.hh"
+#include "mem/request.hh"
+
+namespace gem5
+{
+
+/**
+ * Free list of Packet + Request + payload triples used by the RTL
+ * memory ports.
+ *
+ * Every packet handed out carries a PoolEntry as its sender state,
+ * which owns the Request and a payload buffer of maxSize bytes.
+ * Once the owner is done with the response it gives the packet back
+ * with release(), and the next get call rebuilds it in place. After
+ * the pool has grown to the number of packets in flight no more heap
+ * allocations are done.
+ */
+class PacketPool
+{
+  private:
+    struct PoolEntry : public Packet::SenderState
+    {
+        PacketPtr pkt = nullptr;
+        RequestPtr req;
+        std::vector<uint8_t> data;
+    };
+
+    /// Requestor id given to every request
+    const RequestorID requestorId;
+
+    /// Payload size of each entry, bigger packets are not pooled
+    const unsigned maxSize;
+
+    std::vector<PoolEntry *> freeList;
+
+    /// Scratch byte enable mask, kept to avoid reallocating it
+    std::vector<bool> byteEnable;
+
+    PacketPtr get(MemCmd cmd, Addr paddr, unsigned size,
+                  Request::Flags flags);
+
+  public:
+    PacketPool(RequestorID id, unsigned max_size);
+    ~PacketPool();
+
+    /**
+     * Get a read packet with its payload already set.
+     */
+    PacketPtr getRead(Addr paddr, unsigned size, Request::Flags flags);
+
+    /**
+     * Get a write packet, copying size bytes from data. A bit cleared
+     * in mask disables the corresponding byte.
+     */
+    PacketPtr getWrite(Addr paddr, unsigned size, Request::Flags flags,
+                       const uint8_t *data, uint64_t mask = ~(uint64_t)0);
+
+    /**
+     * Give back a packet once its response has been handled. Packets
+     * not created by this pool are deleted.
+     */
+    void release(PacketPtr pkt);
+
+    /// Number of packets allocated on the heap
+    uint64_t allocs;
+
+    /// Number of requests allocated on the heap
+    uint64_t reqAllocs;
+
+    /// Number of packets served from the free list
+    uint64_t reuses;
+};
+
+} // namespace gem5
+
+#endif // __RTL_PACKET_POOL_HH__
@@ -0,0 +1,244 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "base/gtest/cur_tick_fake.hh"
+#include "rtl/packetPool.hh"
+
+using namespace gem5;
+
+// The Request constructor needs a valid current tick
+GTestTickHandler tickHandler;
+
+/** A released packet is handed out again without new allocations. */
+TEST(PacketPoolTest, ReuseAfterRelease)
+{
+    PacketPool pool(0, 64);
+
+    PacketPtr pkt = pool.getRead(0x1000, 64, 0);
+    ASSERT_TRUE(pkt->isRead());
+    ASSERT_EQ(pkt->getAddr(), 0x1000);
+    ASSERT_EQ(pkt->getSize(), 64);
+    pool.release(pkt);
+
+    PacketPtr pkt2 = pool.getWrite(0x2000, 4, 0,
+                                   (const uint8_t *)"\x01\x02\x03\x04");
+    ASSERT_EQ(pkt, pkt2);
+    ASSERT_TRUE(pkt2->isWrite());
+    ASSERT_EQ(pkt2->getAddr(), 0x2000);
+    ASSERT_EQ(pkt2->getSize(), 4);
+    ASSERT_FALSE(pkt2->req->isMasked());
+    ASSERT_EQ(pkt2->getConstPtr<uint8_t>()[3], 0x04);
+    pool.release(pkt2);
+
+    ASSERT_EQ(pool.allocs, 1);
+    ASSERT_EQ(pool.reqAllocs, 1);
+    ASSERT_EQ(pool.reuses, 1);
+}
+
+/** Cleared mask bits become disabled bytes in the request. */
+TEST(PacketPoolTest, WriteMask)
+{
+    PacketPool pool(0, 64);
+    uint8_t data[3] = {0xaa, 0xbb, 0xcc};
+
+    PacketPtr pkt = pool.getWrite(0x40, 3, 0, data, 0x5);
+    ASSERT_TRUE(pkt->req->isMasked());
+    std::vector<bool> expected = {true, false, true};
+    ASSERT_EQ(pkt->req->getByteEnable(), expected);
+    pool.release(pkt);
+
+    // the mask must not leak into the next user of the entry
+    pkt = pool.getWrite(0x80, 3, 0, data);
+    ASSERT_FALSE(pkt->req->isMasked());
+    pool.release(pkt);
+}
+
+/** A request still referenced elsewhere is not recycled. */
+TEST(PacketPoolTest, SharedRequestNotReused)
+{
+    PacketPool pool(0, 64);
+
+    PacketPtr pkt = pool.getRead(0x1000, 64, 0);
+    RequestPtr held = pkt->req;
+    pool.release(pkt);
+
+    pkt = pool.getRead(0x2000, 64, 0);
+    ASSERT_NE(pkt->req, held);
+    ASSERT_EQ(held->getPaddr(), 0x1000);
+    ASSERT_EQ(pool.reqAllocs, 2);
+    pool.release(pkt);
+}
+
+/** Oversized and foreign packets are simply deleted on release. */
+TEST(PacketPoolTest, NonPooledPackets)
+{
+    PacketPool pool(0, 64);
+
+    PacketPtr big = pool.getRead(0x1000, 128, 0);
+    ASSERT_EQ(big->getSize(), 128);
+    pool.release(big);
+
+    RequestPtr req = std::make_shared<Request>(0x1000, 4, 0, 0);
+    PacketPtr foreign = Packet::createRead(req);
+    foreign->allocate();
+    pool.release(foreign);
+
+    ASSERT_EQ(pool.reuses, 0);
+}
+
+/**
+ * Replay of a DBBIF stream. Each entry is the NVDLA cycle and the
+ * request seen on the AXI interface, either taken from the log that
+ * AXIResponder::eval_timing prints (set NVDLA_DBBIF_LOG to it) or
+ * generated following the streaming pattern of a convolution layer.
+ * Responses come back after a fixed latency and are released, as the
+ * rtlNVDLA ports do. In steady state the pool must not allocate.
+ */
+struct DbbifBeat
+{
+    uint64_t cycle;
+    bool write;
+    uint32_t addr;
+    uint32_t beats;
+};
+
+static std::vector<DbbifBeat>
+loadDbbifStream()
+{
+    std::vector<DbbifBeat> stream;
+
+    const char *log = std::getenv("NVDLA_DBBIF_LOG");
+    if (log) {
+        std::ifstream in(log);
+        std::string line;
+        while (std::getline(in, line)) {
+            unsigned long tick, addr;
+            int id, burst;
+            const char *p = line.c_str();
+            if (std::sscanf(p, "(%lu) nvdla#%*d DBB: read request from dla, "
+                            "addr %lx burst %d id %d",
+                            &tick, &addr, &burst, &id) == 4) {
+                stream.push_back({tick / 2, false, (uint32_t)addr,
+                                  (uint32_t)burst + 1});
+            } else if (std::sscanf(p, "(%lu) nvdla#%*d DBB: write request "
+                                   "from dla, addr %lx id %d",
+                                   &tick, &addr, &id) == 3) {
+                stream.push_back({tick / 2, true, (uint32_t)addr, 1});
+            }
+        }
+    }
+
+    if (stream.empty()) {
+        // weights and activations streamed in, one output beat every
+        // eight reads
+        uint32_t rd_addr = 0x80000000;
+        uint32_t wr_addr = 0x90000000;
+        for (uint64_t cycle = 0; cycle < 200000; cycle++) {
+            stream.push_back({cycle, false, rd_addr, 1});
+            rd_addr += 64;
+            if (cycle % 8 == 0) {
+                stream.push_back({cycle, true, wr_addr, 1});
+                wr_addr += 64;
+            }
+        }
+    }
+
+    return stream;
+}
+
+// Takes a while, run it with --gtest_also_run_disabled_tests
+TEST(PacketPoolTest, DISABLED_DbbifReplay)
+{
+    const uint64_t latency = 120;
+    const uint64_t warmup = 10000;
+
+    std::vector<DbbifBeat> stream = loadDbbifStream();
+    ASSERT_FALSE(stream.empty());
+
+    PacketPool pool(0, 64);
+    std::deque<std::pair<uint64_t, PacketPtr>> inflight;
+    uint8_t data[64];
+    std::memset(data, 0x55, sizeof(data));
+
+    uint64_t first_cycle = stream.front().cycle;
+    uint64_t last_cycle = stream.back().cycle + latency;
+    uint64_t warm_allocs = 0;
+    bool warm = false;
+
+    auto start = std::chrono::steady_clock::now();
+    auto it = stream.begin();
+    for (uint64_t cycle = first_cycle; cycle <= last_cycle; cycle++) {
+        while (!inflight.empty() && inflight.front().first <= cycle) {
+            pool.release(inflight.front().second);
+            inflight.pop_front();
+        }
+
+        for (; it != stream.end() && it->cycle == cycle; it++) {
+            for (uint32_t b = 0; b < it->beats; b++) {
+                uint32_t addr = it->addr + b * 64;
+                PacketPtr pkt = it->write ?
+                    pool.getWrite(addr, 64, 0, data) :
+                    pool.getRead(addr, 64, 0);
+                inflight.emplace_back(cycle + latency, pkt);
+            }
+        }
+
+        if (!warm && cycle - first_cycle >= warmup) {
+            warm = true;
+            warm_allocs = pool.allocs + pool.reqAllocs;
+        }
+    }
+    auto stop = std::chrono::steady_clock::now();
+
+    uint64_t cycles = last_cycle - first_cycle + 1;
+    uint64_t allocs = pool.allocs + pool.reqAllocs;
+    double secs = std::chrono::duration<double>(stop - start).count();
+
+    std::cout << "DBBIF replay: " << stream.size() << " requests, "
+              << cycles << " cycles, "
+              << (double)allocs / cycles << " allocations/cycle, "
+              << (double)(allocs - warm_allocs) / cycles
+              << " allocations/cycle after warm-up, "
+              << cycles / secs << " cycles/s" << std::endl;
+
+    // a recorded stream may keep growing its window after warm-up
+    if (warm && !std::getenv("NVDLA_DBBIF_LOG"))
+        ASSERT_EQ(allocs, warm_allocs);
+}
@@ -0,0 +1,163 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/parallelEval.hh"
+
+#include "base/logging.hh"
+#include "sim/cur_tick.hh"
+
+namespace gem5
+{
+
+namespace
+{
+
+/// Polls before a waiting thread blocks, a new cycle usually comes
+/// within a few microseconds
+const unsigned spinLimit = 20000;
+
+inline void
+relax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#endif
+}
+
+} // anonymous namespace
+
+ParallelEval &
+ParallelEval::instance()
+{
+    // never destroyed, the workers are blocked waiting at exit
+    static ParallelEval *inst = new ParallelEval;
+    return *inst;
+}
+
+ParallelEval::ParallelEval() :
+    remaining(0),
+    em(nullptr),
+    runEvent([this]{ run(); }, "ParallelEval batch", false,
+             Event::CPU_Tick_Pri)
+{
+}
+
+unsigned
+ParallelEval::add(EventManager *_em, Job eval, Job finish)
+{
+    panic_if(em && em->eventQueue() != _em->eventQueue(),
+             "Parallel RTL evaluation needs a single event queue\n");
+    em = _em;
+
+    workers.emplace_back(new Worker);
+    Worker *w = workers.back().get();
+    w->eval = eval;
+    w->finish = finish;
+    w->thread = std::thread(&ParallelEval::workerLoop, this, w);
+    return workers.size() - 1;
+}
+
+void
+ParallelEval::post(unsigned member)
+{
+    assert(member < workers.size());
+    pending.push_back(member);
+    if (!runEvent.scheduled())
+        em->schedule(runEvent, curTick());
+}
+
+void
+ParallelEval::call(unsigned member, const Job &job)
+{
+    assert(member < workers.size());
+    remaining.store(1);
+    start(workers[member].get(), &job);
+    wait();
+}
+
+void
+ParallelEval::start(Worker *w, const Job *job)
+{
+    w->job = job;
+    w->go.fetch_add(1);
+    if (w->waiting.load()) {
+        // taking the lock orders the notify after the worker waits
+        std::lock_guard<std::mutex> lock(w->mtx);
+        w->cv.notify_one();
+    }
+}
+
+void
+ParallelEval::wait()
+{
+    for (unsigned i = 0; remaining.load(std::memory_order_acquire); i++) {
+        if (i < spinLimit)
+            relax();
+        else
+            std::this_thread::yield();
+    }
+}
+
+void
+ParallelEval::run()
+{
+    remaining.store(pending.size());
+    for (unsigned member : pending)
+        start(workers[member].get(), &workers[member]->eval);
+    wait();
+
+    for (unsigned member : pending)
+        workers[member]->finish();
+    pending.clear();
+}
+
+void
+ParallelEval::workerLoop(Worker *w)
+{
+    uint64_t seen = 0;
+    while (true) {
+        for (unsigned i = 0; w->go.load() == seen; i++) {
+            if (i < spinLimit) {
+                relax();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(w->mtx);
+            w->waiting.store(true);
+            w->cv.wait(lock, [w, seen]{ return w->go.load() != seen; });
+            w->waiting.store(false);
+        }
+        seen++;
+
+        (*w->job)();
+        remaining.fetch_sub(1, std::memory_order_release);
+    }
+}
+
+} // namespace gem5
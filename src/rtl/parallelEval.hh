@@ -0,0 +1,120 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_PARALLEL_EVAL_HH__
+#define __RTL_PARALLEL_EVAL_HH__
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+/**
+ * Evaluates the Verilated models of several RTL objects in parallel.
+ *
+ * Every member owns a host thread that runs all of its evaluations.
+ * A member posts its evaluation when it ticks; all the members that
+ * post in the same tick are released together by a single event that
+ * runs after them, and the event waits for all of them to finish.
+ * The finish step of each member then runs on the event queue in
+ * posting order, so everything that touches the memory system stays
+ * single threaded and deterministic.
+ *
+ * The evaluation must only touch the model and state owned by the
+ * member. The requests it generates are left in the model output
+ * buffers and picked up by the finish step after the barrier.
+ */
+class ParallelEval
+{
+  public:
+    typedef std::function<void()> Job;
+
+    static ParallelEval &instance();
+
+    /**
+     * Add a member with a thread of its own.
+     *
+     * @param em Event manager used to schedule the batch event
+     * @param eval Run on the member thread
+     * @param finish Run on the event queue once the batch is done
+     * @return Member index used to post
+     */
+    unsigned add(EventManager *em, Job eval, Job finish);
+
+    /** Evaluate member together with the others posting in this tick */
+    void post(unsigned member);
+
+    /** Run job on the thread of member and wait for it */
+    void call(unsigned member, const Job &job);
+
+  private:
+    struct Worker
+    {
+        Job eval;
+        Job finish;
+        const Job *job = nullptr;
+        /// Generation requested by the event queue
+        std::atomic<uint64_t> go{0};
+        std::atomic<bool> waiting{false};
+        std::mutex mtx;
+        std::condition_variable cv;
+        std::thread thread;
+    };
+
+    ParallelEval();
+
+    /** Hand job to worker w */
+    void start(Worker *w, const Job *job);
+
+    /** Wait until every started job is done */
+    void wait();
+
+    void run();
+
+    void workerLoop(Worker *w);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<unsigned> pending;
+    std::atomic<unsigned> remaining;
+
+    EventManager *em;
+    EventFunctionWrapper runEvent;
+};
+
+} // namespace gem5
+
+#endif // __RTL_PARALLEL_EVAL_HH__
@@ -30,6 +30,12 @@
 
 #include "rtl/rtlNVDLA.hh"
 
+#include "base/bitfield.hh"
+#include "base/output.hh"
+#include "debug/Drain.hh"
+#include "sim/sim_exit.hh"
+#include "sim/stat_control.hh"
+
 namespace gem5
 {
 
@@ -48,20 +54,84 @@ rtlNVDLA::rtlNVDLA(const rtlNVDLAParams &params) :
     id_nvdla(params.id_nvdla),
     baseAddrDRAM(params.base_addr_dram),
     baseAddrSRAM(params.base_addr_sram),
+    traceEnable(params.enableWaveform),
+    writeCombine(params.write_combine),
+    backdoorTraceLoad(params.backdoor_trace_load),
+    traceIngest(INGEST_TIMING),
+    ingestPending(0),
+    parallelEval(params.parallel_eval),
+    evalMember(0),
+    skipIdle(params.skip_idle),
+    skipIdleThreshold(params.skip_idle_threshold),
+    idleStreak(0),
+    sleeping(false),
+    sleepTick(0),
+    evalPosted(false),
+    drainPaused(false),
+    recorder(nullptr),
+    layerStats(params.layer_stats),
+    bwWindow(params.bw_window),
+    curCmd(SIZE_MAX),
+    curOpcode(0),
+    rtlLayerEnd(0),
+    layerCycles(0),
+    layerPhaseCycles{},
+    layerBytes{0, 0},
+    windowCycles(0),
+    windowBytes{0, 0},
+    sleepPhase(PHASE_COMPUTE),
     waiting_for_gem5_mem(0),
     flushing_spm(0),
     prefetch_enable(params.prefetch_enable),
     spm_latency(params.spm_latency),
     spm_line_size(params.spm_line_size),
     spm_line_num(params.spm_line_num),
+    spm_assoc(params.spm_assoc),
+    spm_repl_policy(params.spm_repl_policy),
+    spm_write_allocate(params.spm_write_allocate),
+    spm_eager_writeback(params.spm_eager_writeback),
     dma_enable(params.dma_enable),
     dmaPort(this, params.system),
-    dma_try_get_length(spm_line_size / params.dma_try_get_fraction),
-    last_dma_actual_size(0),
-    last_dma_got_size(0)
+    dma_channels(params.dma_channels),
+    dma_engine(nullptr),
+    dma_try_get_length(spm_line_size / params.dma_try_get_fraction)
 {
+    if (params.trace_ingest == "functional")
+        traceIngest = INGEST_FUNCTIONAL;
+    else if (params.trace_ingest == "backdoor")
+        traceIngest = INGEST_BACKDOOR;
+    else
+        fatal_if(params.trace_ingest != "timing",
+                 "%s: unknown trace ingest mode %s\n", name(),
+                 params.trace_ingest);
+
+    int format = WaveTracer::parseFormat(params.waveform_format);
+    fatal_if(format < 0, "%s: unknown waveform format %s\n", name(),
+             params.waveform_format);
+    traceConfig.format = traceEnable ? format : WaveTracer::TRACE_NONE;
+    traceConfig.path = simout.resolve(csprintf("nvdla%d", id_nvdla));
+    traceConfig.start = params.waveform_start;
+    traceConfig.cycles = params.waveform_cycles;
+    traceConfig.trigger_addr = params.waveform_trigger;
+    traceConfig.threaded = params.waveform_threaded;
+
+    streamPftConfig.entries = params.stream_pft_entries;
+    streamPftConfig.degree = params.stream_pft_degree;
+    streamPftConfig.max_delta = params.stream_pft_distance;
+    streamPftConfig.conf_threshold = params.stream_pft_confidence;
+    streamPftConfig.conf_max = params.stream_pft_conf_max;
 
     initNVDLA();
+    if (params.dump_mem) {
+        trace->set_dump_files(true);
+        // the files are written in the background, finish them on exit
+        registerExitCallback([]() { TraceLoaderGem5::flush_dumps(); });
+    }
+    if (parallelEval) {
+        evalMember = ParallelEval::instance().add(this,
+            [this]() { evalNVDLA(); },
+            [this]() { finishParallelTick(); });
+    }
     startMemRegion = 0xC0000000;
     cyclesNVDLA = 0;
     std::cout << std::hex << "NVDLA " << id_nvdla
@@ -71,23 +141,28 @@ rtlNVDLA::rtlNVDLA(const rtlNVDLAParams &params) :
     memset(&input, 0, sizeof(inputNVDLA));
 
     if (dma_enable) {
-        dma_rd_engine = new DmaReadFifo(dmaPort, spm_line_size * spm_line_num,
-                                    spm_line_size, spm_line_num, Request::UNCACHEABLE);
-        dma_wr_engine = new DmaNvdla(dmaPort, true, spm_line_size * spm_line_num,
-                                     spm_line_size, spm_line_num, Request::UNCACHEABLE);
-    } else {
-        dma_rd_engine = nullptr;
-        dma_wr_engine = nullptr;
+        dma_engine = new DmaNvdlaChannels(name() + ".dma", dmaPort,
+                                          dma_channels,
+                                          Request::UNCACHEABLE);
+        dma_engine->setDoneCallback([this]() { wakeUp(); });
+    }
+
+    if (params.record_axi) {
+        std::string file = params.axi_trace_file.empty() ?
+            name() + ".axi.trc.gz" : params.axi_trace_file;
+        recorder = new AxiTraceRecorder(simout.resolve(file), name(),
+                                        clockPeriod());
+        // the destructor is not called on exit, flush the file there
+        registerExitCallback([this]() { recorder->close(); });
     }
 }
 
 
 rtlNVDLA::~rtlNVDLA() {
     delete wr;
-    if (dma_rd_engine != nullptr)
-        delete dma_rd_engine;
-    if (dma_wr_engine != nullptr)
-        delete dma_wr_engine;
+    if (dma_engine != nullptr)
+        delete dma_engine;
+    delete recorder;
 }
 
 Port &
@@ -121,6 +196,10 @@ rtlNVDLA::handleRequest(PacketPtr pkt)
         return false;
     }
 
+    // the loader replays from the trace buffer until the trace finishes
+    if (!traceBuf.acquire(pkt->getSize()))
+        return false;
+
     blocked = true;
 
     DPRINTF(rtlNVDLA, "Got request for size: %d, addr: %#x\n",
@@ -130,19 +209,104 @@ rtlNVDLA::handleRequest(PacketPtr pkt)
     bytesToRead = pkt->getSize();   // it works as a counter
     trace->trace_and_rd_log_size = bytesToRead;
 
-    ptrTrace = (char *) malloc(bytesToRead);
+    if (traceIngest == INGEST_TIMING) {
+        startTranslate(pkt->req->getVaddr(), 0);
+        return true;
+    }
 
-    startTranslate(pkt->req->getVaddr(), 0);
+    // translate every page at once, translations may finish right away
+    Addr page = system->getPageBytes();
+    Addr vaddr = pkt->req->getVaddr();
+    Addr end = vaddr + bytesToRead;
+    ingestChunks.clear();
+    for (Addr a = vaddr; a < end; a = roundDown(a, page) + page) {
+        unsigned size = std::min(end, roundDown(a, page) + page) - a;
+        ingestChunks.push_back({a, 0, size});
+    }
+    ingestPending = ingestChunks.size();
+    for (int i = 0; i < ingestChunks.size(); i++)
+        startTranslate(ingestChunks[i].vaddr, 0, ingestChunks[i].size);
 
     return true;
 }
 
+uint8_t *
+rtlNVDLA::hostAddr(Addr paddr, unsigned size) {
+    for (auto &entry : system->getPhysMem().getBackingStore()) {
+        if (entry.range.contains(paddr) &&
+            entry.range.contains(paddr + size - 1) &&
+            !entry.range.interleaved()) {
+            return entry.pmem + (paddr - entry.range.start());
+        }
+    }
+    return nullptr;
+}
+
+void
+rtlNVDLA::ingestTrace() {
+    // the trace is always copied, the guest may reuse its buffer as soon
+    // as the start request completes
+    bool contiguous = traceIngest == INGEST_BACKDOOR && !ingestChunks.empty();
+    for (int i = 1; contiguous && i < ingestChunks.size(); i++) {
+        contiguous = ingestChunks[i].paddr == ingestChunks[i - 1].paddr +
+                                              ingestChunks[i - 1].size;
+    }
+    uint8_t *whole = contiguous ?
+                     hostAddr(ingestChunks[0].paddr, bytesToRead) : nullptr;
+
+    if (whole) {
+        memcpy(traceBuf.data(), whole, bytesToRead);
+    } else {
+        char *dst = traceBuf.data();
+        for (auto &chunk : ingestChunks) {
+            uint8_t *src = traceIngest == INGEST_BACKDOOR ?
+                           hostAddr(chunk.paddr, chunk.size) : nullptr;
+            if (src) {
+                memcpy(dst, src, chunk.size);
+                dst += chunk.size;
+                continue;
+            }
+            // caches only satisfy functional reads within one block
+            const unsigned block = AXI_WIDTH / 8;
+            for (unsigned off = 0; off < chunk.size; ) {
+                Addr paddr = chunk.paddr + off;
+                unsigned size = std::min<unsigned>(chunk.size - off,
+                                    block - (paddr & (block - 1)));
+                RequestPtr req = std::make_shared<Request>(paddr, size, 0,
+                                                 Request::funcRequestorId);
+                Packet pkt(req, MemCmd::ReadReq);
+                pkt.dataStatic((uint8_t *) dst);
+                memPort.sendFunctional(&pkt);
+                dst += size;
+                off += size;
+            }
+        }
+    }
+
+    DPRINTF(rtlNVDLA, "Ingested trace of %d bytes in %d pages%s\n",
+            bytesToRead, ingestChunks.size(),
+            whole ? " with a single copy" : "");
+
+    bytesToRead = 0;
+    ingestChunks.clear();
+
+    // Load the trace and reset NVDLA
+    loadTraceNVDLA(traceBuf.data());
+    // the next start still waits for this trace to finish
+    blocked = false;
+}
+
 void
 rtlNVDLA::initNVDLA() {
     // Wrapper
-    wr = new Wrapper_nvdla(id_nvdla, traceEnable, "trace.vcd", max_req_inflight, dma_enable, spm_latency, spm_line_size, spm_line_num, prefetch_enable);
+    wr = new Wrapper_nvdla(id_nvdla, traceConfig, max_req_inflight, dma_enable, spm_latency, spm_line_size, spm_line_num, prefetch_enable,
+                           spm_assoc, spm_repl_policy, spm_write_allocate,
+                           spm_eager_writeback, streamPftConfig);
     // wrapper trace from nvidia
     trace = new TraceLoaderGem5(wr->csb, wr->axi_dbb, wr->axi_cvsram);
+    // the wrapper is never destroyed, flush the waveform on exit
+    if (wr->tracer)
+        registerExitCallback([this]() { wr->tracer->close(); });
 }
 
 void
@@ -167,12 +331,25 @@ rtlNVDLA::loadTraceNVDLA(char *ptr) {
             "Base Addr: %#x \n",
             trace->getBaseAddr());
     // reset NVDLA
-    wr->init();
+    if (parallelEval)
+        ParallelEval::instance().call(evalMember, [this]() { wr->init(); });
+    else
+        wr->init();
     // init some variable before exec of trace
     quiesc_timer = 200;
     waiting = 0;
-
-    schedule(tickEvent, nextCycle());
+    curCmd = SIZE_MAX;
+    rtlLayerEnd = 0;
+    layerCycles = 0;
+    for (auto &c : layerPhaseCycles)
+        c = 0;
+    layerBytes[0] = layerBytes[1] = 0;
+
+    // the trace starts once the checkpoint is taken
+    if (drainState() == DrainState::Draining)
+        drainPaused = true;
+    else
+        schedule(tickEvent, nextCycle());
 }
 
 void
@@ -184,6 +361,9 @@ rtlNVDLA::processOutput(outputNVDLA& out) {
             // printf("read req addr: %08x, size %d\n", aux.read_addr, aux.read_bytes);
             // std::cout << std::hex << "read req: " \
             // << aux.read_addr << std::endl;
+            if (aux.read_timing)
+                observeAXI(aux.read_addr, aux.read_sram, false,
+                           aux.read_bytes);
             readAXIVariable(aux.read_addr,
                             aux.read_sram,
                             aux.read_timing,
@@ -193,8 +373,13 @@ rtlNVDLA::processOutput(outputNVDLA& out) {
     }
 
     if (out.write_valid) {
+        if (writeCombine)
+            combineWrites(out.write_buffer);
+
         while (!out.write_buffer.empty()) {     // this buffer outputs in 1-byte granularity
             write_req_entry_t aux = out.write_buffer.front();
+            if (aux.write_timing)
+                observeAXI(aux.write_addr, aux.write_sram, true, 1);
             writeAXI(aux.write_addr,
                      aux.write_data,
                      aux.write_sram,
@@ -204,52 +389,107 @@ rtlNVDLA::processOutput(outputNVDLA& out) {
 
         while (!out.long_write_buffer.empty()) { // this buffer outputs in 1-64 bytes granularity
             auto& aux = out.long_write_buffer.front();
+            if (aux.write_timing)
+                observeAXI(aux.write_addr, aux.write_sram, true,
+                           aux.length);
             writeAXILong(aux.write_addr, aux.length, aux.write_data, aux.write_mask, aux.write_sram, aux.write_timing);
             out.long_write_buffer.pop();
         }
+
+        while (!out.bulk_write_buffer.empty()) {
+            auto& aux = out.bulk_write_buffer.front();
+            writeAXIBulk(aux.write_addr, aux.length, aux.write_data, aux.write_sram);
+            out.bulk_write_buffer.pop();
+        }
     }
 
-    //! use dma_rd_engine to process reading requests
+    //! hand the DMA requests to the channels, they are issued as channels become free
     // memory requests already in spm is dealt with in wrapper_nvdla
-    // only one DMA request can be tackled at once
-    if (!out.dma_read_buffer.empty()) {
+    // reads and writes share the descriptor queue, and the engine holds a read
+    // of a line until its write back has completed at memory
+    while (!out.dma_read_buffer.empty()) {
         auto& aux = out.dma_read_buffer.front();
-
         uint32_t real_addr = getRealAddr(aux.first, false);      // always suppose dram DMA fetch
-        // if DMA request not sent, have to stop here
-        if (!dma_rd_engine->atEndOfBlock()) {
-            // printf("DMA engine busy, can't deal with req: addr 0x%08lx, len %d, try again later!\n", aux.first, aux.second);
-        // } else if(last_dma_got_size < last_dma_actual_size) {
-            // printf("DMA get too slow! Waiting for previous Get (addr 0x%08lx) to read the dma buffer.\n", last_dma_nvdla_addr);
-            // printf("last_dma_got_size = %d, last_dma_actual_size = %d\n", last_dma_got_size, last_dma_actual_size);
-        } else {
-            last_dma_nvdla_addr = aux.first;
-            last_dma_actual_size = aux.second;
-            // last_dma_got_size = 0;
-
-            dma_rd_engine->startFill(real_addr, aux.second);
-            printf("nvdla#%d DMA read req is issued: addr %08x, len %d\n", id_nvdla, aux.first, aux.second);
-            // after successfully calling DMA, pop aux
-            out.dma_read_buffer.pop();
-        }
+        observeAXI(aux.first, false, false, aux.second);
+        if (recorder)
+            recordDma(aux.first, false, aux.second);
+        portRequest(false, aux.second);
+        dma_engine->read(real_addr, aux.second, aux.first);
+        printf("nvdla#%d DMA read req is queued: addr %08lx, len %d\n", id_nvdla, aux.first, aux.second);
+        out.dma_read_buffer.pop();
     }
 
-
-    //! use dma_wr_engine to process writing requests
-    if(!out.dma_write_buffer.empty()) {
+    while (!out.dma_write_buffer.empty()) {
         auto& aux = out.dma_write_buffer.front();
-        if (dma_wr_engine->atEndOfBlock()) {                    // previous DMA write has been sent
-            uint32_t real_addr = getRealAddr(aux.first, false);     // always suppose dram DMA write
-            dma_wr_engine->startFill(real_addr, aux.second.size(), aux.second.data());
-            printf("nvdla#%d DMA write req is issued: addr %08x, len %d\n", id_nvdla, aux.first, aux.second.size());
-            out.dma_write_buffer.pop();
+        uint32_t real_addr = getRealAddr(aux.first, false);     // always suppose dram DMA write
+        observeAXI(aux.first, false, true, aux.second.size());
+        if (recorder)
+            recordDma(aux.first, true, aux.second.size());
+        portRequest(false, aux.second.size());
+        printf("nvdla#%d DMA write req is queued: addr %08lx, len %lu\n", id_nvdla, aux.first, aux.second.size());
+        dma_engine->write(real_addr, std::move(aux.second));
+        out.dma_write_buffer.pop();
+    }
+}
+
+void
+rtlNVDLA::combineWrites(std::queue<write_req_entry_t>& buffer) {
+    const uint32_t beat_size = AXI_WIDTH / 8;
+
+    uint8_t beat_data[AXI_WIDTH / 8];
+    uint64_t beat_mask = 0;
+    uint32_t beat_addr = 0;
+    uint32_t beat_bytes = 0;
+    bool beat_sram = false;
+    bool beat_timing = false;
+
+    // send the bytes gathered so far as the smallest span covering them
+    auto flush_beat = [&]() {
+        if (beat_mask == 0)
+            return;
+        int first = findLsbSet(beat_mask);
+        int last = findMsbSet(beat_mask);
+        writeAXILong(beat_addr + first, last - first + 1,
+                     beat_data + first, beat_mask >> first,
+                     beat_sram, beat_timing);
+        stats.nvdla_writesCoalesced += beat_bytes - 1;
+        beat_mask = 0;
+        beat_bytes = 0;
+    };
+
+    while (!buffer.empty()) {
+        const write_req_entry_t& aux = buffer.front();
+        uint32_t line = aux.write_addr & ~(beat_size - 1);
+        uint32_t offset = aux.write_addr & (beat_size - 1);
+
+        if (beat_mask != 0 && (line != beat_addr ||
+                               aux.write_sram != beat_sram ||
+                               aux.write_timing != beat_timing)) {
+            flush_beat();
         }
+
+        beat_addr = line;
+        beat_sram = aux.write_sram;
+        beat_timing = aux.write_timing;
+        beat_data[offset] = aux.write_data;
+        beat_mask |= (uint64_t)1 << offset;
+        beat_bytes++;
+
+        buffer.pop();
     }
+    flush_beat();
 }
 
 void
 rtlNVDLA::runIterationNVDLA() {
+    evalNVDLA();
+    finishIterationNVDLA();
+}
+
+void
+rtlNVDLA::evalNVDLA() {
     wr->clearOutput();
+    trace->feed();
 
     int extevent;
 
@@ -283,15 +523,20 @@ rtlNVDLA::runIterationNVDLA() {
         }
     }
 
-    outputNVDLA& output = wr->tick(input);
+    wr->tick(input);
+}
+
+void
+rtlNVDLA::finishIterationNVDLA() {
+    outputNVDLA& output = wr->output;
 
     if (dma_enable) {
         try_get_dma_read_data(dma_try_get_length);
-        if (wr->csb->done()) {
+        if (traceDone()) {
             // write back dirty data in spm to main memory
             wr->flush_spm();    // if it is called for a second time, no more items will be flushed
             flushing_spm = 1;
-            if(flushing_spm && output.dma_write_buffer.empty()) {   // all items have been flushed to dma write engine
+            if(flushing_spm && output.dma_write_buffer.empty() && !dma_engine->writesPending()) {   // all items have been written back
                 flushing_spm = 0;
                 printf("nvdla#%d spm flush complete!\n", id_nvdla);
             }
@@ -303,47 +548,69 @@ rtlNVDLA::runIterationNVDLA() {
 void
 rtlNVDLA::tick() {
     DPRINTF(rtlNVDLADebug, "Tick NVDLA \n");
+    if (drainState() == DrainState::Draining) {
+        drainTick();
+        return;
+    }
     // if we are still running trace
     // runIteration
     // schedule new iteration
-    if (!wr->csb->done() || (quiesc_timer-- > 0) || waiting_for_gem5_mem || flushing_spm) {
+    if (!traceDone() || (quiesc_timer-- > 0) || waiting_for_gem5_mem || flushing_spm) {
         // Update stats
         // stats.nvdla_avgReqCVSRAM.sample(wr->axi_cvsram->getRequestsOnFlight());
         stats.nvdla_avgReqDBBIF.sample(wr->axi_dbb->getRequestsOnFlight());
         stats.nvdla_cycles++;
+        accountCycles(1, currentPhase());
         cyclesNVDLA++;
+        if (parallelEval) {
+            // evaluated with the other NVDLAs of this cycle, the rest
+            // is done in finishParallelTick
+            evalPosted = true;
+            ParallelEval::instance().post(evalMember);
+            return;
+        }
         runIterationNVDLA();
-        schedule(tickEvent,nextCycle());
+        scheduleNextTick();
     }
     else {
         // we have finished running the trace
         printf("done at %lu ticks\n", wr->tickcount);
-
-        if (!trace->test_passed()) {
-            printf("*** FAIL: test failed due to output mismatch\n");
-
-        } else if (!wr->csb->test_passed()) {
-            printf("*** FAIL: test failed due to CSB read mismatch\n");
-        } else {
-            std::cout << "NVDLA " << id_nvdla;
-            printf(" *** PASS\n");
-        }
-
-        // we send a null packet telling we have finished
-        RequestPtr req = std::make_shared<Request>(id_nvdla, 1,
-                                               Request::UNCACHEABLE, 0);
-        PacketPtr packet = nullptr;
-        // we create the real packet, write request
-        packet = Packet::createRead(req);
-        packet->allocate();
-        packet->makeResponse();
-        cpuPort.sendPacket(packet);
+        if (layerCycles > 0)
+            endLayer();
+        finishTrace();
     }
     // check DRAM Ports
     dramPort.tick();
     sramPort.tick();
 }
 
+void
+rtlNVDLA::finishTrace() {
+    if (!trace->test_passed()) {
+        printf("*** FAIL: test failed due to output mismatch\n");
+
+    } else if (!wr->csb->test_passed()) {
+        printf("*** FAIL: test failed due to CSB read mismatch\n");
+    } else {
+        std::cout << "NVDLA " << id_nvdla;
+        printf(" *** PASS\n");
+    }
+
+    // we send a null packet telling we have finished
+    RequestPtr req = std::make_shared<Request>(id_nvdla, 1,
+                                           Request::UNCACHEABLE, 0);
+    PacketPtr packet = nullptr;
+    // we create the real packet, write request
+    packet = Packet::createRead(req);
+    packet->allocate();
+    packet->makeResponse();
+    cpuPort.sendPacket(packet);
+
+    // a start refused while the trace ran can be retried now
+    traceBuf.release();
+    cpuPort.trySendRetry();
+}
+
 
 bool
 rtlNVDLA::handleResponse(PacketPtr pkt)
@@ -356,7 +623,7 @@ rtlNVDLA::handleResponse(PacketPtr pkt)
                          64 : (bytesToRead - bytesReaded);
 
         for (int i=0;i<maxRead;i++) {
-            ptrTrace[bytesReaded+i] = data_ptr[i];
+            traceBuf.data()[bytesReaded+i] = data_ptr[i];
             //DPRINTF(rtlNVDLA, "Got response for addr %x %02x\n",
             //                        pkt->getAddr()+(i),
             //                        data_ptr[i]);
@@ -369,14 +636,18 @@ rtlNVDLA::handleResponse(PacketPtr pkt)
         } else {
             //for (int i=0;i<bytesToRead;i++) {
             //    DPRINTF(rtlNVDLA, "Trace: %02x\n",
-            //                        ptrTrace[i]);
+            //                        traceBuf.data()[i]);
             //}
 
             bytesReaded = 0;
             bytesToRead = 0;
 
             // Load the trace and reset NVDLA
-            loadTraceNVDLA(ptrTrace);
+            loadTraceNVDLA(traceBuf.data());
+
+            // The trace is in, the next start still waits for it to
+            // finish
+            blocked = false;
         }
     }
     else {
@@ -386,18 +657,14 @@ rtlNVDLA::handleResponse(PacketPtr pkt)
     }
 
 
-    // The packet is now done. We're about to put it in the port, no need for
-    // this object to continue to stall.
-    // We need to free the resource before sending the packet in case the CPU
-    // tries to send another request immediately (e.g., in the same callchain).
-    blocked = false;
-
     return true;
 }
 
 bool
 rtlNVDLA::handleResponseNVDLA(PacketPtr pkt, bool sram)
 {
+    wakeUp();
+
     if (pkt->hasData()){
         if (pkt->isRead()){
             // Get data from gem5 memory system
@@ -457,6 +724,20 @@ rtlNVDLA::finishTranslation(WholeTranslationState *state) {
 
     RequestPtr req = state->mainReq;
 
+    if (traceIngest != INGEST_TIMING) {
+        panic_if(!req->hasPaddr(), "%s: trace page %#x not translated\n",
+                 name(), req->getVaddr());
+        Addr page = system->getPageBytes();
+        int idx = (roundDown(req->getVaddr(), page) -
+                   roundDown(ingestChunks[0].vaddr, page)) / page;
+        ingestChunks[idx].paddr = req->getPaddr();
+        delete [] state->data;
+        delete state;
+        if (--ingestPending == 0)
+            ingestTrace();
+        return;
+    }
+
     if (req->hasPaddr()) {
         DPRINTF(rtlNVDLA,
                 "Finished translation step: Got request for addr %#x %#x\n",
@@ -488,16 +769,29 @@ rtlNVDLA::MemNVDLAPort::sendPacket(PacketPtr pkt, bool timing)
             pkt->getAddr(), pkt->getSize(), pending_req.size());
         // we add as a pending request, we deal later
         pending_req.push(pkt);
+        if (pkt->needsResponse())
+            outstanding++;
+        if (owner->recorder)
+            owner->recordRequest(pkt);
+        owner->portRequest(sram, pkt->getSize());
     }
     else {
         DPRINTF(rtlNVDLA, "Send Mem Req to DRAM %#x size: %d functional\n",
             pkt->getAddr(), pkt->getSize());
         // send Atomic
         sendAtomic(pkt);
-        // Update all the pointers
-        recentData32 = *pkt->getConstPtr<uint32_t>();
-        recentData = *pkt->getConstPtr<uint8_t>();
-        recentDataptr = pkt->getConstPtr<uint8_t>();
+        // Update all the pointers, the data is copied out since the
+        // packet goes straight back to the pool
+        if (pkt->isRead()) {
+            unsigned size = std::min<unsigned>(pkt->getSize(),
+                                               sizeof(recentBuffer));
+            memcpy(recentBuffer, pkt->getConstPtr<uint8_t>(), size);
+            recentData32 = 0;
+            memcpy(&recentData32, recentBuffer, std::min(size, 4u));
+            recentData = recentBuffer[0];
+            recentDataptr = recentBuffer;
+        }
+        pool.release(pkt);
     }
 }
 
@@ -511,7 +805,17 @@ bool
 rtlNVDLA::MemNVDLAPort::recvTimingResp(PacketPtr pkt)
 {
     DPRINTF(rtlNVDLA, "Got response SRAM?: %d\n", sram);
-    return owner->handleResponseNVDLA(pkt,sram);
+    bool handled = owner->handleResponseNVDLA(pkt,sram);
+    // we are done with the response, recycle the packet
+    if (handled) {
+        assert(outstanding > 0);
+        outstanding--;
+        if (owner->recorder)
+            owner->recordResponse(pkt);
+        owner->portResponse(pkt, sram);
+        pool.release(pkt);
+    }
+    return handled;
 }
 
 void
@@ -549,6 +853,39 @@ rtlNVDLA::MemNVDLAPort::tick()
     }
 }
 
+void
+rtlNVDLA::writeAXIBulk(uint32_t addr, uint32_t length, const uint8_t* data, bool sram) {
+    stats.nvdla_traceLoadBytes += length;
+
+    uint32_t real_addr = getRealAddr(addr,sram);
+    DPRINTF(rtlNVDLA, "Bulk write addr: %#x, real_addr %#x, size %d\n",
+            addr, real_addr, length);
+
+    if (backdoorTraceLoad) {
+        // one copy into the backing store, cached copies are not updated
+        RequestPtr req = std::make_shared<Request>(real_addr, length, 0,
+                                                   Request::funcRequestorId);
+        Packet pkt(req, MemCmd::WriteReq);
+        pkt.dataStatic(const_cast<uint8_t*>(data));
+        system->getPhysMem().functionalAccess(&pkt);
+        return;
+    }
+
+    // functional accesses are looked up in the caches a block at a time
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    const uint32_t block = AXI_WIDTH / 8;
+    uint32_t offset = 0;
+    while (offset < length) {
+        uint32_t size = std::min(length - offset,
+                                 block - ((real_addr + offset) & (block - 1)));
+        PacketPtr pkt = port.pool.getWrite(real_addr + offset, size, 0,
+                                           data + offset);
+        port.sendFunctional(pkt);
+        port.pool.release(pkt);
+        offset += size;
+    }
+}
+
 uint32_t
 rtlNVDLA::getRealAddr(uint32_t addr, bool sram) {
 
@@ -589,22 +926,12 @@ rtlNVDLA::readAXI(uint32_t addr, bool sram, bool timing) {
     stats.nvdla_reads++;
     // calculate the addr
     uint32_t real_addr = getRealAddr(addr,sram);
-    // Create packet
-    RequestPtr req = std::make_shared<Request>(real_addr, 1,
-                                               Request::UNCACHEABLE, 0);
-    PacketPtr packet = nullptr;
-    // we create the real packet, write request
-    packet = Packet::createRead(req);
-    packet->allocate();
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    // we get a read packet from the port pool
+    PacketPtr packet = port.pool.getRead(real_addr, 1, Request::UNCACHEABLE);
     // send the packet in timing?
-    if (sram) {
-        sramPort.sendPacket(packet, timing);
-        return sramPort.recentData;
-    } else {
-        dramPort.sendPacket(packet, timing);
-        return dramPort.recentData;
-    }
-    return 1;
+    port.sendPacket(packet, timing);
+    return port.recentData;
 }
 
 uint32_t
@@ -614,22 +941,12 @@ rtlNVDLA::readAXI32(uint32_t addr, bool sram, bool timing) {
     stats.nvdla_reads++;
 
     uint32_t real_addr = getRealAddr(addr,sram);
-
-    RequestPtr req = std::make_shared<Request>(real_addr, 4,
-                                               Request::UNCACHEABLE, 0);
-    PacketPtr packet = nullptr;
-    // we create the real packet, write request
-    packet = Packet::createRead(req);
-    packet->allocate();
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    // we get a read packet from the port pool
+    PacketPtr packet = port.pool.getRead(real_addr, 4, Request::UNCACHEABLE);
     // send the packet in timing?
-    if (sram) {
-        sramPort.sendPacket(packet, timing);
-        return sramPort.recentData32;
-    } else {
-        dramPort.sendPacket(packet, timing);
-        return dramPort.recentData32;
-    }
-    return 1;
+    port.sendPacket(packet, timing);
+    return port.recentData32;
 }
 
 const uint8_t *
@@ -645,21 +962,12 @@ rtlNVDLA::readAXIVariable(uint32_t addr, bool sram,
             "Read AXI Variable addr: %#x, real_addr %#x, size %d\n",
             addr, real_addr, size);
 
-    RequestPtr req = std::make_shared<Request>(real_addr, size,
-                                               0, 0);
-    PacketPtr packet = nullptr;
-    // we create the real packet, write request
-    packet = Packet::createRead(req);
-    packet->allocate();
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    // we get a read packet from the port pool
+    PacketPtr packet = port.pool.getRead(real_addr, size, 0);
     // send the packet in timing?
-    if (sram) {
-        sramPort.sendPacket(packet, timing);
-        return sramPort.recentDataptr;
-    } else {
-        dramPort.sendPacket(packet, timing);
-        return dramPort.recentDataptr;
-    }
-    return nullptr;
+    port.sendPacket(packet, timing);
+    return port.recentDataptr;
 }
 
 void
@@ -672,26 +980,13 @@ rtlNVDLA::writeAXI(uint32_t addr, uint8_t data, bool sram, bool timing) {
     DPRINTF(rtlNVDLA,
             "Write AXI Variable addr: %#x, real_addr %#x, data_to_write 0x%02x\n",
             addr, real_addr, data);
-    //Request(Addr paddr, unsigned size, Flags flags, MasterID mid)
     // addr is the physical addr
     // size is one byte
-    // flags is physical (vaddr is also the physical one)
-    RequestPtr req = std::make_shared<Request>(real_addr, 1,
-                                               0, 0);
-    PacketPtr packet = nullptr;
-    // we create the real packet, write request
-    packet = Packet::createWrite(req);
     // always in Little Endian
-    PacketDataPtr dataAux = new uint8_t[1];
-    dataAux[0] = data;
-
-    packet->dataDynamic(dataAux);
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    PacketPtr packet = port.pool.getWrite(real_addr, 1, 0, &data);
     // send the packet in timing?
-    if (sram) {
-        sramPort.sendPacket(packet, timing);
-    } else {
-        dramPort.sendPacket(packet, timing);
-    }
+    port.sendPacket(packet, timing);
 }
 
 void
@@ -699,50 +994,348 @@ rtlNVDLA::writeAXILong(uint32_t addr, uint32_t length, uint8_t* data, uint64_t m
     stats.nvdla_writes++;
 
     uint32_t real_addr = getRealAddr(addr,sram);
-    RequestPtr req = std::make_shared<Request>(real_addr, length, 0, 0);
-    std::vector<bool> byte_enable_vec(length);
+    MemNVDLAPort &port = sram ? sramPort : dramPort;
+    // always in Little Endian, disabled bytes are masked out
+    PacketPtr packet = port.pool.getWrite(real_addr, length, 0, data, mask);
+    // send the packet in timing?
+    port.sendPacket(packet, timing);
+}
+
+void
+rtlNVDLA::scheduleNextTick() {
+    idleStreak = (skipIdle && quiescent()) ? idleStreak + 1 : 0;
+    if (idleStreak >= skipIdleThreshold) {
+        // nothing will change until memory answers, stop ticking
+        DPRINTF(rtlNVDLADebug, "NVDLA quiescent, stop ticking\n");
+        sleeping = true;
+        sleepTick = nextCycle();
+        sleepPhase = currentPhase();
+    } else {
+        schedule(tickEvent,nextCycle());
+    }
+}
 
-    for (int i = 0; i < length; i++)
-        byte_enable_vec[i] = ((mask >> i) & 1);
+void
+rtlNVDLA::finishParallelTick() {
+    evalPosted = false;
+    finishIterationNVDLA();
+    scheduleNextTick();
+    dramPort.tick();
+    sramPort.tick();
+}
+
+bool
+rtlNVDLA::quiescent() {
+    if (!timingMode || traceDone() || flushing_spm)
+        return false;
 
-    req->setByteEnable(byte_enable_vec);
+    // the csb master must not drive or sample the interface
+    if (!waiting_for_gem5_mem && !(waiting && wr->csb->idle(waiting)))
+        return false;
 
-    PacketPtr packet = nullptr;
-    packet = Packet::createWrite(req);
-    // always in Little Endian
-    PacketDataPtr dataAux = new uint8_t[length];
-    for (int i = 0; i < length; i++)
-        dataAux[i] = data[i];
+    if (!dramPort.pending_req.empty() || !sramPort.pending_req.empty())
+        return false;
 
-    packet->dataDynamic(dataAux);
-    // send the packet in timing?
-    if (sram) {
-        sramPort.sendPacket(packet, timing);
+    // somebody has to wake us up
+    bool dma_busy = dma_enable && dma_engine->busyChannels() > 0;
+    if (dramPort.outstanding + sramPort.outstanding == 0 && !dma_busy)
+        return false;
+    if (dma_enable && dma_engine->readsCompleted())
+        return false;
+
+    return wr->axi_dbb->idle();
+}
+
+void
+rtlNVDLA::wakeUp() {
+    if (!sleeping)
+        return;
+    sleeping = false;
+    idleStreak = 0;
+
+    Tick when = std::max(clockEdge(), sleepTick);
+    int skipped = (when - sleepTick) / clockPeriod();
+    DPRINTF(rtlNVDLADebug, "NVDLA wakes up after %d cycles\n", skipped);
+
+    // the RTL state did not change, only time went by
+    stats.nvdla_cycles += skipped;
+    stats.nvdla_skippedCycles += skipped;
+    accountCycles(skipped, sleepPhase);
+    if (skipped)
+        stats.nvdla_avgReqDBBIF.sample(wr->axi_dbb->getRequestsOnFlight(),
+                                       skipped);
+    cyclesNVDLA += skipped;
+    wr->skipTicks(skipped);
+
+    schedule(tickEvent, when);
+}
+
+bool
+rtlNVDLA::drainQuiet() {
+    if (blocked || evalPosted || memPort.blockedPacket)
+        return false;
+    if (dramPort.outstanding + sramPort.outstanding != 0 ||
+        !dramPort.pending_req.empty() || !sramPort.pending_req.empty())
+        return false;
+    return !dma_enable || dma_engine->busyChannels() == 0;
+}
+
+void
+rtlNVDLA::drainTick() {
+    dramPort.tick();
+    sramPort.tick();
+    // what the DMA engine brings is kept by the AXI responder
+    if (dma_enable && dma_engine->readsCompleted())
+        try_get_dma_read_data(dma_try_get_length);
+
+    if (drainQuiet()) {
+        DPRINTF(Drain, "NVDLA drained\n");
+        signalDrainDone();
     } else {
-        dramPort.sendPacket(packet, timing);
+        schedule(tickEvent, nextCycle());
+    }
+}
+
+DrainState
+rtlNVDLA::drain() {
+    // account the skipped cycles, the RTL is not evaluated anyway
+    wakeUp();
+
+    drainPaused = tickEvent.scheduled() || evalPosted;
+    if (drainQuiet()) {
+        if (tickEvent.scheduled())
+            deschedule(tickEvent);
+        return DrainState::Drained;
     }
+
+    // keep ticking to serve the memory side, the posted evaluation
+    // reschedules it when it finishes
+    if (!tickEvent.scheduled() && !evalPosted)
+        schedule(tickEvent, nextCycle());
+    return DrainState::Draining;
+}
+
+void
+rtlNVDLA::drainResume() {
+    if (tickEvent.scheduled())
+        deschedule(tickEvent);
+    if (drainPaused) {
+        drainPaused = false;
+        schedule(tickEvent, clockEdge());
+    }
+}
+
+void
+rtlNVDLA::serialize(CheckpointOut &cp) const {
+    SERIALIZE_SCALAR(drainPaused);
+    SERIALIZE_SCALAR(cyclesNVDLA);
+    SERIALIZE_SCALAR(quiesc_timer);
+    SERIALIZE_SCALAR(waiting);
+    SERIALIZE_SCALAR(waiting_for_gem5_mem);
+    SERIALIZE_SCALAR(flushing_spm);
+    SERIALIZE_SCALAR(startBaseTrace);
+    bool trace_running = traceBuf.inUse();
+    SERIALIZE_SCALAR(trace_running);
+
+    // the RTL only holds state worth keeping while a trace runs, the
+    // next start resets it, so an idle NVDLA needs no savable model
+    std::string rtl_file;
+    if (drainPaused) {
+        rtl_file = name() + ".rtl";
+        std::string rtl_path = CheckpointIn::dir() + "/" + rtl_file;
+        fatal_if(!wr->save(rtl_path.c_str()),
+                 "%s: could not save the RTL state of the running trace "
+                 "to %s\n", name(), rtl_path);
+    }
+    SERIALIZE_SCALAR(rtl_file);
+
+    trace->serializeSection(cp, "trace");
+    if (dma_enable)
+        dma_engine->serializeSection(cp, "dma");
+}
+
+void
+rtlNVDLA::unserialize(CheckpointIn &cp) {
+    UNSERIALIZE_SCALAR(drainPaused);
+    UNSERIALIZE_SCALAR(cyclesNVDLA);
+    UNSERIALIZE_SCALAR(quiesc_timer);
+    UNSERIALIZE_SCALAR(waiting);
+    UNSERIALIZE_SCALAR(waiting_for_gem5_mem);
+    UNSERIALIZE_SCALAR(flushing_spm);
+    UNSERIALIZE_SCALAR(startBaseTrace);
+    // the loader replays its restored copy, starts still wait for it
+    bool trace_running;
+    UNSERIALIZE_SCALAR(trace_running);
+    if (trace_running)
+        traceBuf.hold();
+
+    std::string rtl_file;
+    UNSERIALIZE_SCALAR(rtl_file);
+    if (!rtl_file.empty()) {
+        std::string rtl_path = cp.getCptDir() + "/" + rtl_file;
+        fatal_if(!wr->restore(rtl_path.c_str()),
+                 "%s: could not restore the RTL state from %s\n", name(),
+                 rtl_path);
+    }
+
+    trace->unserializeSection(cp, "trace");
+    if (dma_enable)
+        dma_engine->unserializeSection(cp, "dma");
+
+    // find the layer being run again, its cycles so far are lost
+    curCmd = SIZE_MAX;
+    rtlLayerEnd = 0;
 }
 
 void
 rtlNVDLA::try_get_dma_read_data(uint32_t size) {
-    uint8_t dma_temp_buffer[size];
-    bool get_success = dma_rd_engine->tryGet(dma_temp_buffer, size);
-    // int get_result = get_success;
-    // printf("Get result:%d\n\n", get_result);
-    if(get_success) {
-        // last_dma_got_size += size;
-        // todo: remember whether this DMA request comes from CVSRAM or DBBIF
-        // if ((last_dma_nvdla_addr & 0xF0000000) >= 0x80000000)   // check traceLoaderGem5.cc to see why offset can be greater than 0x8
-            wr->axi_dbb->inflight_dma_resp(dma_temp_buffer, size);
-        // else if ((last_dma_nvdla_addr & 0xF0000000) == 0x50000000)
-            // wr->axi_cvsram->inflight_dma_resp(dma_temp_buffer, size);
-        // else {
-            // printf("Unexpected address offset, aborting...\n");
-            // abort();
-        // }
+    stats.nvdla_dmaChannelsBusy.sample(dma_engine->busyChannels());
+    dma_engine->deliver(size,
+        [this](uint64_t addr, unsigned offset, const uint8_t *data, unsigned len) {
+            // todo: remember whether this DMA request comes from CVSRAM or DBBIF
+            // if ((addr & 0xF0000000) >= 0x80000000)   // check traceLoaderGem5.cc to see why offset can be greater than 0x8
+            if (recorder && offset == 0) {
+                auto it = recordedDma.find(addr);
+                if (it != recordedDma.end()) {
+                    recorder->response(it->second);
+                    recordedDma.erase(it);
+                }
+            }
+            wr->axi_dbb->inflight_dma_resp(addr, data, len);
+        });
+}
+
+void
+rtlNVDLA::recordRequest(PacketPtr pkt) {
+    uint64_t id = recorder->request(cyclesNVDLA, pkt->cmd, pkt->getAddr(),
+                                    pkt->getSize(), pkt->req->getFlags());
+    if (pkt->needsResponse())
+        recordedReqs[pkt] = id;
+}
+
+void
+rtlNVDLA::recordResponse(PacketPtr pkt) {
+    auto it = recordedReqs.find(pkt);
+    if (it != recordedReqs.end()) {
+        // only reads carry data the RTL can depend on
+        if (pkt->isRead())
+            recorder->response(it->second);
+        recordedReqs.erase(it);
     }
 }
 
+void
+rtlNVDLA::recordDma(uint32_t addr, bool write, unsigned len) {
+    // the channels split the transfer, replay it as a single request
+    uint64_t id = recorder->request(cyclesNVDLA,
+                                    write ? MemCmd::WriteReq : MemCmd::ReadReq,
+                                    getRealAddr(addr, false), len,
+                                    Request::UNCACHEABLE);
+    if (!write)
+        recordedDma[addr] = id;
+}
+
+rtlNVDLA::Phase
+rtlNVDLA::currentPhase() {
+    if (flushing_spm)
+        return PHASE_SPM_FLUSH;
+    // dump_mem reads the result back through the ports
+    if (waiting_for_gem5_mem)
+        return PHASE_DBBIF;
+    if (wr->csb->programming())
+        return PHASE_CSB;
+    if (wr->axi_dbb->stalled())
+        return dma_enable ? PHASE_DMA : PHASE_DBBIF;
+    return PHASE_COMPUTE;
+}
+
+void
+rtlNVDLA::accountCycles(uint64_t cycles, Phase phase) {
+    stats.nvdla_phaseCycles[phase] += cycles;
+
+    // the CSB master pops a command once it is done with it, the
+    // waits for the interrupt and for the dump are popped on entry
+    size_t cmd = trace->position() - wr->csb->pending();
+    if ((waiting || waiting_for_gem5_mem) && cmd > 0)
+        cmd--;
+
+    if (cmd != curCmd) {
+        curCmd = cmd;
+        size_t n = trace->num_cmds();
+        curOpcode = cmd < n ? trace->opcode(cmd) : 0;
+
+        // after a load or a restore only look for the current layer
+        bool seek = rtlLayerEnd == 0;
+        uint64_t sig;
+        while (cmd >= rtlLayerEnd && rtlLayerEnd < n) {
+            if (!seek)
+                endLayer();
+            rtlLayerEnd = trace->layer_end(rtlLayerEnd, sig);
+        }
+    }
+
+    if (curOpcode >= 1 && curOpcode <= 7)
+        stats.nvdla_cmdCycles[curOpcode - 1] += cycles;
+    layerCycles += cycles;
+    layerPhaseCycles[phase] += cycles;
+
+    if (bwWindow == 0)
+        return;
+    windowCycles += cycles;
+    if (windowCycles >= bwWindow) {
+        // whole windows skipped while asleep did not move any data
+        uint64_t empty = windowCycles / bwWindow - 1;
+        stats.nvdla_bwDRAM.sample(windowBytes[0]);
+        stats.nvdla_bwSRAM.sample(windowBytes[1]);
+        if (empty) {
+            stats.nvdla_bwDRAM.sample(0, empty);
+            stats.nvdla_bwSRAM.sample(0, empty);
+        }
+        windowCycles %= bwWindow;
+        windowBytes[0] = windowBytes[1] = 0;
+    }
+}
+
+void
+rtlNVDLA::endLayer() {
+    DPRINTF(rtlNVDLA, "Layer done in %lu cycles\n", layerCycles);
+    stats.nvdla_layers++;
+    stats.nvdla_layerCycles.sample(layerCycles);
+
+    // the stats of the whole simulator are dumped, but only the last
+    // layer ones are set per layer, the rest keep accumulating
+    stats.nvdla_lastLayerCycles = layerCycles;
+    for (int p = 0; p < NUM_PHASES; p++) {
+        stats.nvdla_lastLayerPhaseCycles[p] = layerPhaseCycles[p];
+        layerPhaseCycles[p] = 0;
+    }
+    stats.nvdla_lastLayerBytesDRAM = layerBytes[0];
+    stats.nvdla_lastLayerBytesSRAM = layerBytes[1];
+    layerCycles = 0;
+    layerBytes[0] = layerBytes[1] = 0;
+    if (layerStats)
+        statistics::schedStatEvent(true, false, curTick());
+}
+
+void
+rtlNVDLA::portRequest(bool sram, unsigned size) {
+    if (sram)
+        stats.nvdla_bytesSRAM += size;
+    else
+        stats.nvdla_bytesDRAM += size;
+    windowBytes[sram] += size;
+    layerBytes[sram] += size;
+}
+
+void
+rtlNVDLA::portResponse(PacketPtr pkt, bool sram) {
+    Cycles lat = ticksToCycles(curTick() - pkt->req->time());
+    if (sram)
+        stats.nvdla_latencySRAM.sample(lat);
+    else
+        stats.nvdla_latencyDRAM.sample(lat);
+}
+
 void
 rtlNVDLA::regStats()
 {
@@ -762,6 +1355,15 @@ rtlNVDLA::regStats()
     stats.nvdla_writes
         .name(name() + ".nvdla_writes")
         .desc("Number of writes performed");
+
+    stats.nvdla_traceLoadBytes
+        .name(name() + ".nvdla_traceLoadBytes")
+        .desc("Bytes of trace data loaded into memory");
+
+    stats.nvdla_writesCoalesced
+        .name(name() + ".nvdla_writesCoalesced")
+        .desc("Number of write packets saved by write combining");
+
     stats.nvdla_avgReqCVSRAM
         .init(256)
         .name(name() + ".nvdla_avgReqCVSRAM")
@@ -774,6 +1376,228 @@ rtlNVDLA::regStats()
         .desc("Histogram Requests onflight DBBIF")
         .flags(pdf);
 
+    stats.nvdla_pktAllocsDRAM
+        .scalar(dramPort.pool.allocs)
+        .name(name() + ".nvdla_pktAllocsDRAM")
+        .desc("Packets allocated on the heap by the DRAM port pool");
+
+    stats.nvdla_pktAllocsSRAM
+        .scalar(sramPort.pool.allocs)
+        .name(name() + ".nvdla_pktAllocsSRAM")
+        .desc("Packets allocated on the heap by the SRAM port pool");
+
+    stats.nvdla_pktReuses
+        .functor([this]() {
+            return dramPort.pool.reuses + sramPort.pool.reuses; })
+        .name(name() + ".nvdla_pktReuses")
+        .desc("Packets recycled from the port pools");
+
+    stats.nvdla_pktAllocsPerCycle
+        .name(name() + ".nvdla_pktAllocsPerCycle")
+        .desc("Packet allocations per NVDLA cycle");
+    stats.nvdla_pktAllocsPerCycle =
+        (stats.nvdla_pktAllocsDRAM + stats.nvdla_pktAllocsSRAM) /
+        stats.nvdla_cycles;
+
+    stats.nvdla_spmHits
+        .scalar(wr->spm.hits)
+        .name(name() + ".nvdla_spmHits")
+        .desc("Reads served by the scratchpad");
+
+    stats.nvdla_spmMisses
+        .scalar(wr->spm.misses)
+        .name(name() + ".nvdla_spmMisses")
+        .desc("Reads that missed in the scratchpad");
+
+    stats.nvdla_spmEvictions
+        .scalar(wr->spm.evictions)
+        .name(name() + ".nvdla_spmEvictions")
+        .desc("Scratchpad lines replaced");
+
+    stats.nvdla_spmWritebacks
+        .scalar(wr->spm.writebacks)
+        .name(name() + ".nvdla_spmWritebacks")
+        .desc("Scratchpad lines written back to memory");
+
+    stats.nvdla_spmWriteArounds
+        .scalar(wr->spm.write_arounds)
+        .name(name() + ".nvdla_spmWriteArounds")
+        .desc("Scratchpad write misses sent straight to memory");
+
+    stats.nvdla_dmaReads
+        .functor([this]() {
+            return dma_engine ? dma_engine->readsIssued : 0; })
+        .name(name() + ".nvdla_dmaReads")
+        .desc("DMA line reads issued");
+
+    stats.nvdla_dmaWrites
+        .functor([this]() {
+            return dma_engine ? dma_engine->writesIssued : 0; })
+        .name(name() + ".nvdla_dmaWrites")
+        .desc("DMA line writes issued");
+
+    stats.nvdla_dmaChannelsBusy
+        .init(dma_channels + 1)
+        .name(name() + ".nvdla_dmaChannelsBusy")
+        .desc("Histogram of busy DMA channels per NVDLA cycle")
+        .flags(pdf);
+
+    stats.nvdla_skippedCycles
+        .name(name() + ".nvdla_skippedCycles")
+        .desc("Quiescent cycles in which the RTL was not evaluated");
+
+    // summed over both AXI interfaces, zero without a prefetcher
+    auto pf_stat = [this](uint64_t AXIPrefetcher::*stat) {
+        return [this, stat]() {
+            uint64_t sum = 0;
+            for (AXIResponder *axi : {wr->axi_dbb, wr->axi_cvsram}) {
+                if (axi->prefetcher)
+                    sum += axi->prefetcher.get()->*stat;
+            }
+            return sum;
+        };
+    };
+
+    stats.nvdla_pfIssued
+        .functor(pf_stat(&AXIPrefetcher::pf_issued))
+        .name(name() + ".nvdla_pfIssued")
+        .desc("Blocks prefetched");
+
+    stats.nvdla_pfUseful
+        .functor(pf_stat(&AXIPrefetcher::pf_useful))
+        .name(name() + ".nvdla_pfUseful")
+        .desc("Prefetched blocks later read by the RTL");
+
+    stats.nvdla_pfLate
+        .functor(pf_stat(&AXIPrefetcher::pf_late))
+        .name(name() + ".nvdla_pfLate")
+        .desc("Useful prefetches still in flight when the RTL read them");
+
+    stats.nvdla_pfUnused
+        .functor(pf_stat(&AXIPrefetcher::pf_unused))
+        .name(name() + ".nvdla_pfUnused")
+        .desc("Prefetched blocks forgotten before being read");
+
+    stats.nvdla_pfDemandMisses
+        .functor(pf_stat(&AXIPrefetcher::demand_misses))
+        .name(name() + ".nvdla_pfDemandMisses")
+        .desc("Blocks read from memory that were not prefetched");
+
+    stats.nvdla_pfAccuracy
+        .name(name() + ".nvdla_pfAccuracy")
+        .desc("Fraction of the prefetched blocks that were used");
+    stats.nvdla_pfAccuracy = stats.nvdla_pfUseful / stats.nvdla_pfIssued;
+
+    stats.nvdla_pfCoverage
+        .name(name() + ".nvdla_pfCoverage")
+        .desc("Fraction of the blocks needed from memory that were prefetched");
+    stats.nvdla_pfCoverage = stats.nvdla_pfUseful /
+        (stats.nvdla_pfUseful + stats.nvdla_pfDemandMisses);
+
+    stats.nvdla_pfLateness
+        .name(name() + ".nvdla_pfLateness")
+        .desc("Fraction of the useful prefetches that were late");
+    stats.nvdla_pfLateness = stats.nvdla_pfLate / stats.nvdla_pfUseful;
+
+    stats.nvdla_phaseCycles
+        .init(NUM_PHASES)
+        .name(name() + ".nvdla_phaseCycles")
+        .desc("NVDLA cycles by what held the accelerator up")
+        .subname(PHASE_CSB, "csb")
+        .subname(PHASE_COMPUTE, "compute")
+        .subname(PHASE_DBBIF, "dbbif")
+        .subname(PHASE_DMA, "dmaWait")
+        .subname(PHASE_SPM_FLUSH, "spmFlush")
+        .flags(total | pdf);
+
+    stats.nvdla_cmdCycles
+        .init(7)
+        .name(name() + ".nvdla_cmdCycles")
+        .desc("NVDLA cycles by the trace command being executed")
+        .subname(0, "wait")
+        .subname(1, "writeReg")
+        .subname(2, "readReg")
+        .subname(3, "dumpMem")
+        .subname(4, "loadMem")
+        .subname(5, "waitUntil")
+        .subname(6, "reset")
+        .flags(total | nozero);
+
+    stats.nvdla_layers
+        .name(name() + ".nvdla_layers")
+        .desc("Layers of the trace completed");
+
+    stats.nvdla_layerCycles
+        .init(20)
+        .name(name() + ".nvdla_layerCycles")
+        .desc("Histogram of NVDLA cycles per layer");
+
+    stats.nvdla_lastLayerCycles
+        .name(name() + ".nvdla_lastLayerCycles")
+        .desc("NVDLA cycles of the last layer completed");
+
+    stats.nvdla_lastLayerPhaseCycles
+        .init(NUM_PHASES)
+        .name(name() + ".nvdla_lastLayerPhaseCycles")
+        .desc("NVDLA cycles of the last layer completed by what held "
+              "the accelerator up")
+        .subname(PHASE_CSB, "csb")
+        .subname(PHASE_COMPUTE, "compute")
+        .subname(PHASE_DBBIF, "dbbif")
+        .subname(PHASE_DMA, "dmaWait")
+        .subname(PHASE_SPM_FLUSH, "spmFlush");
+
+    stats.nvdla_lastLayerBytesDRAM
+        .name(name() + ".nvdla_lastLayerBytesDRAM")
+        .desc("Bytes requested from DRAM in the last layer completed");
+
+    stats.nvdla_lastLayerBytesSRAM
+        .name(name() + ".nvdla_lastLayerBytesSRAM")
+        .desc("Bytes requested from SRAM in the last layer completed");
+
+    stats.nvdla_bytesDRAM
+        .name(name() + ".nvdla_bytesDRAM")
+        .desc("Bytes requested from DRAM, DMA included");
+
+    stats.nvdla_bytesSRAM
+        .name(name() + ".nvdla_bytesSRAM")
+        .desc("Bytes requested from SRAM");
+
+    stats.nvdla_bytesPerCycleDRAM
+        .name(name() + ".nvdla_bytesPerCycleDRAM")
+        .desc("DRAM bytes per NVDLA cycle");
+    stats.nvdla_bytesPerCycleDRAM = stats.nvdla_bytesDRAM /
+        stats.nvdla_cycles;
+
+    stats.nvdla_bytesPerCycleSRAM
+        .name(name() + ".nvdla_bytesPerCycleSRAM")
+        .desc("SRAM bytes per NVDLA cycle");
+    stats.nvdla_bytesPerCycleSRAM = stats.nvdla_bytesSRAM /
+        stats.nvdla_cycles;
+
+    stats.nvdla_bwDRAM
+        .init(32)
+        .name(name() + ".nvdla_bwDRAM")
+        .desc("Histogram of DRAM bytes per bw_window cycles")
+        .flags(pdf);
+
+    stats.nvdla_bwSRAM
+        .init(32)
+        .name(name() + ".nvdla_bwSRAM")
+        .desc("Histogram of SRAM bytes per bw_window cycles")
+        .flags(pdf);
+
+    stats.nvdla_latencyDRAM
+        .init(32)
+        .name(name() + ".nvdla_latencyDRAM")
+        .desc("Histogram of DRAM port latency in NVDLA cycles")
+        .flags(pdf);
+
+    stats.nvdla_latencySRAM
+        .init(32)
+        .name(name() + ".nvdla_latencySRAM")
+        .desc("Histogram of SRAM port latency in NVDLA cycles")
+        .flags(pdf);
 }
 
 } //End namespace gem5
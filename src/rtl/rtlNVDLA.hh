@@ -32,6 +32,7 @@
 #define __RTL_NVDLA_VERILATOR_HH__
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
@@ -43,7 +44,11 @@
 #include "debug/rtlNVDLA.hh"
 #include "debug/rtlNVDLADebug.hh"
 #include "params/rtlNVDLA.hh"
+#include "rtl/axiTraceRecorder.hh"
+#include "rtl/packetPool.hh"
+#include "rtl/parallelEval.hh"
 #include "rtl/rtlObject.hh"
+#include "rtl/traceBuffer.hh"
 #include "rtl/traceLoaderGem5.hh"
 #include "sim/system.hh"
 #include "wrapper_nvdla.hh"
@@ -58,7 +63,7 @@ class TraceLoaderGem5;
  */
 class rtlNVDLA : public rtlObject
 {
-  private:
+  protected:
 
     /**
      * Port on the memory-side that receives responses.
@@ -81,7 +86,9 @@ class rtlNVDLA : public rtlObject
             RequestPort(name, owner),
             owner(owner),
             sram(sram_),
-            blockedRetry(false)
+            blockedRetry(false),
+            outstanding(0),
+            pool(0, AXI_WIDTH / 8)
         { }
 
         uint8_t recentData;
@@ -90,12 +97,21 @@ class rtlNVDLA : public rtlObject
 
         const uint8_t *recentDataptr;
 
+        /// Copy of the last atomic response, the packet is recycled
+        uint8_t recentBuffer[AXI_WIDTH / 8];
+
         std::queue<PacketPtr> pending_req;
 
         bool sram;
         // if we are blocked due to a req retry
         bool blockedRetry;
 
+        /// Timing packets sent and still waiting for their response
+        unsigned outstanding;
+
+        /// Packets sent through this port, recycled on response
+        PacketPool pool;
+
         /**
          * Send a packet across this port. This is called by the owner and
          * all of the flow control is hanled in this function.
@@ -157,7 +173,7 @@ class rtlNVDLA : public rtlObject
      * @return true if we can handle the response this cycle, false if the
      *         responder needs to retry later
      */
-    bool handleResponseNVDLA(PacketPtr pkt, bool sram);
+    virtual bool handleResponseNVDLA(PacketPtr pkt, bool sram);
 
     /**
      * Handle a packet functionally. Update the data on a write and get the
@@ -210,20 +226,255 @@ class rtlNVDLA : public rtlObject
 
     uint32_t startMemRegion;
     uint32_t startBaseTrace;
-    char *ptrTrace;
+    /// The trace being run, held until its completion is sent
+    TraceBuffer traceBuf;
     bool traceEnable;
+    /// Waveform settings handed to the wrapper
+    WaveTraceConfig traceConfig;
 
     struct nvdla_stats
     {
         statistics::Scalar nvdla_cycles;
         statistics::Scalar nvdla_reads;
         statistics::Scalar nvdla_writes;
+        statistics::Scalar nvdla_writesCoalesced;
+        statistics::Scalar nvdla_traceLoadBytes;
         statistics::Histogram nvdla_avgReqCVSRAM;
         statistics::Histogram nvdla_avgReqDBBIF;
+        statistics::Value nvdla_pktAllocsDRAM;
+        statistics::Value nvdla_pktAllocsSRAM;
+        statistics::Value nvdla_pktReuses;
+        statistics::Formula nvdla_pktAllocsPerCycle;
+        statistics::Value nvdla_spmHits;
+        statistics::Value nvdla_spmMisses;
+        statistics::Value nvdla_spmEvictions;
+        statistics::Value nvdla_spmWritebacks;
+        statistics::Value nvdla_spmWriteArounds;
+        statistics::Value nvdla_dmaReads;
+        statistics::Value nvdla_dmaWrites;
+        statistics::Histogram nvdla_dmaChannelsBusy;
+        statistics::Scalar nvdla_skippedCycles;
+        statistics::Value nvdla_pfIssued;
+        statistics::Value nvdla_pfUseful;
+        statistics::Value nvdla_pfLate;
+        statistics::Value nvdla_pfUnused;
+        statistics::Value nvdla_pfDemandMisses;
+        statistics::Formula nvdla_pfAccuracy;
+        statistics::Formula nvdla_pfCoverage;
+        statistics::Formula nvdla_pfLateness;
+        statistics::Vector nvdla_phaseCycles;
+        statistics::Vector nvdla_cmdCycles;
+        statistics::Scalar nvdla_layers;
+        statistics::Histogram nvdla_layerCycles;
+        statistics::Scalar nvdla_lastLayerCycles;
+        statistics::Vector nvdla_lastLayerPhaseCycles;
+        statistics::Scalar nvdla_lastLayerBytesDRAM;
+        statistics::Scalar nvdla_lastLayerBytesSRAM;
+        statistics::Scalar nvdla_bytesDRAM;
+        statistics::Scalar nvdla_bytesSRAM;
+        statistics::Formula nvdla_bytesPerCycleDRAM;
+        statistics::Formula nvdla_bytesPerCycleSRAM;
+        statistics::Histogram nvdla_bwDRAM;
+        statistics::Histogram nvdla_bwSRAM;
+        statistics::Histogram nvdla_latencyDRAM;
+        statistics::Histogram nvdla_latencySRAM;
     };
     nvdla_stats stats;
     void processOutput(outputNVDLA& out);
 
+    /**
+     * Called for every timing request the RTL sends to memory, with
+     * the NVDLA address. Lets a derived model record the traffic.
+     */
+    virtual void observeAXI(uint32_t addr, bool sram, bool write,
+                            unsigned size) { }
+
+    /**
+     * Report the result of the trace and tell the requestor that the
+     * NVDLA is done.
+     */
+    void finishTrace();
+
+    /**
+     * Drain the byte-granular write buffer merging contiguous bytes
+     * that fall in the same AXI beat into a single masked packet.
+     * Only the beat being built can absorb new bytes, so the order
+     * of the writes seen by memory is preserved.
+     */
+    void combineWrites(std::queue<write_req_entry_t>& buffer);
+
+    /// Merge byte writes into AXI beats (see combineWrites)
+    const bool writeCombine;
+
+    /// Write load_mem data directly into the physical memory
+    const bool backdoorTraceLoad;
+
+    /**
+     * How the trace is read from the guest. In timing mode it is read
+     * a line at a time through memPort. Otherwise all its pages are
+     * translated at once and read functionally, a block at a time so
+     * that dirty data in the caches is seen, or straight from the
+     * physical memory backing store. The trace is always copied into
+     * traceBuf, with a single memcpy when the backdoor finds its pages
+     * physically contiguous; the guest must have written it back from
+     * its caches, but may reuse the buffer once the start completes.
+     */
+    enum TraceIngest
+    {
+        INGEST_TIMING,
+        INGEST_FUNCTIONAL,
+        INGEST_BACKDOOR
+    };
+    TraceIngest traceIngest;
+
+    /// One page of the trace being ingested
+    struct IngestChunk
+    {
+        Addr vaddr;
+        Addr paddr;
+        unsigned size;
+    };
+    std::vector<IngestChunk> ingestChunks;
+    /// Translations of ingestChunks still in flight
+    unsigned ingestPending;
+
+    /** Read the translated trace and start running it */
+    void ingestTrace();
+
+    /** Host pointer to size bytes at paddr, nullptr if not backed */
+    uint8_t *hostAddr(Addr paddr, unsigned size);
+
+    /**
+     * Can the RTL stop being evaluated? True when the CSB master is
+     * parked (waiting for an interrupt or for AXI_DUMPMEM data), no
+     * AXI handshake is in progress and the only thing left is data
+     * that memory or the DMA engine will deliver later.
+     */
+    bool quiescent();
+
+    /**
+     * Restart ticking after a memory response or a DMA completion,
+     * accounting the cycles skipped while asleep.
+     */
+    void wakeUp();
+
+    /**
+     * Idle accounting and scheduling of the next cycle, at the end
+     * of an iteration.
+     */
+    void scheduleNextTick();
+
+    /**
+     * End of a cycle evaluated by ParallelEval: the part of the
+     * iteration that talks to gem5, run on the event queue.
+     */
+    void finishParallelTick();
+
+    /// Evaluate the model on a host thread (see ParallelEval)
+    const bool parallelEval;
+    unsigned evalMember;
+
+    /// Stop ticking the RTL while it is quiescent
+    const bool skipIdle;
+    const unsigned skipIdleThreshold;
+    /// Consecutive quiescent cycles seen so far
+    unsigned idleStreak;
+    /// tickEvent is not scheduled, waiting for wakeUp()
+    bool sleeping;
+    /// First cycle that was not ticked
+    Tick sleepTick;
+    /// An evaluation was posted to ParallelEval and is not finished
+    bool evalPosted;
+
+    /// A trace was running when the drain started
+    bool drainPaused;
+
+    /// Packet trace of the AXI traffic, nullptr unless record_axi
+    AxiTraceRecorder *recorder;
+    /// pkt_id of the recorded port requests waiting for their response
+    std::unordered_map<PacketPtr, uint64_t> recordedReqs;
+    /// pkt_id of the recorded DMA reads, by NVDLA address
+    std::unordered_map<uint64_t, uint64_t> recordedDma;
+
+    /** Record a timing request sent through sramPort or dramPort */
+    void recordRequest(PacketPtr pkt);
+    /** Record the response to a request seen by recordRequest() */
+    void recordResponse(PacketPtr pkt);
+    /** Record a DMA transfer of len bytes at the NVDLA address addr */
+    void recordDma(uint32_t addr, bool write, unsigned len);
+
+    /**
+     * What holds the NVDLA up in a cycle. Every cycle counted in
+     * nvdla_cycles is attributed to one of them.
+     */
+    enum Phase
+    {
+        PHASE_CSB,          ///< the CSB master programs registers
+        PHASE_COMPUTE,      ///< the engines run and memory keeps up
+        PHASE_DBBIF,        ///< waiting for data through the AXI ports
+        PHASE_DMA,          ///< waiting for a line the DMA brings to the spm
+        PHASE_SPM_FLUSH,    ///< writing the spm back after the trace
+        NUM_PHASES
+    };
+
+    /** Phase of the cycle about to be evaluated */
+    Phase currentPhase();
+
+    /**
+     * Attribute cycles to a phase and to the trace command and layer
+     * being executed, closing the layers left behind.
+     */
+    void accountCycles(uint64_t cycles, Phase phase);
+
+    /**
+     * The current layer is over, publish its cycles and bytes in the
+     * last layer stats and dump the stats with layerStats.
+     */
+    void endLayer();
+
+    /** Account size bytes sent to memory for the bandwidth stats */
+    void portRequest(bool sram, unsigned size);
+
+    /**
+     * A timing response came back, sample its latency. It is counted
+     * from the creation of the request, so it includes the time spent
+     * queued in the port.
+     */
+    void portResponse(PacketPtr pkt, bool sram);
+
+    /// Dump the stats every time a layer ends
+    const bool layerStats;
+    /// NVDLA cycles in each sample of the bandwidth histograms
+    const uint64_t bwWindow;
+    /// Trace command being executed and its opcode
+    size_t curCmd;
+    unsigned char curOpcode;
+    /// First command of the next layer, 0 if not known yet
+    size_t rtlLayerEnd;
+    /// Cycles spent in the current layer, by phase and in total
+    uint64_t layerCycles;
+    uint64_t layerPhaseCycles[NUM_PHASES];
+    /// Bytes (DRAM, SRAM) requested in the current layer
+    uint64_t layerBytes[2];
+    /// Cycles and bytes (DRAM, SRAM) of the current bandwidth sample
+    uint64_t windowCycles;
+    uint64_t windowBytes[2];
+    /// Phase the RTL was in when it went to sleep
+    Phase sleepPhase;
+
+    /**
+     * Nothing of the NVDLA is in the memory system: no trace being
+     * read, no request queued or waiting for its response and no DMA
+     * transfer left to consume.
+     */
+    bool drainQuiet();
+
+    /**
+     * Tick while draining: the RTL is not evaluated, only the ports
+     * and the DMA engine are served until drainQuiet().
+     */
+    void drainTick();
+
 public:
 
     // NVDLA pointers
@@ -235,10 +486,14 @@ public:
 
     ~rtlNVDLA();
     void runIterationNVDLA();
+    /** Evaluate the CSB master, the AXI responders and the RTL */
+    void evalNVDLA();
+    /** Feed DMA data and send the requests of the last evaluation */
+    void finishIterationNVDLA();
     void initNVDLA();
     void initRTLModel() override;
     void endRTLModel() override;
-    void loadTraceNVDLA(char *ptr);
+    virtual void loadTraceNVDLA(char *ptr);
 
     // variables for the NVDLA
     int quiesc_timer;
@@ -262,6 +517,15 @@ public:
                                     bool timing, unsigned int size);
     void writeAXI(uint32_t addr, uint8_t data, bool sram, bool timing);
     void writeAXILong(uint32_t addr, uint32_t length, uint8_t* data, uint64_t mask, bool sram, bool timing);
+    /**
+     * Functional write of a whole buffer, used to load the trace data.
+     * Goes through the port a block at a time, or straight to physical
+     * memory with backdoorTraceLoad.
+     */
+    void writeAXIBulk(uint32_t addr, uint32_t length, const uint8_t* data, bool sram);
+
+    /// All the trace commands have been executed
+    bool traceDone() { return trace->done() && wr->csb->done(); }
 
     uint32_t getRealAddr(uint32_t addr, bool sram);
     uint32_t getAddrNVDLA(uint32_t addr, bool sram);
@@ -271,21 +535,34 @@ public:
     void regStats() override;
 
     int prefetch_enable;
+    StreamPrefetchConfig streamPftConfig;
 
     uint32_t spm_latency;
     uint32_t spm_line_size;
     uint32_t spm_line_num;
+    uint32_t spm_assoc;
+    uint32_t spm_repl_policy;
+    uint32_t spm_write_allocate;
+    bool spm_eager_writeback;
 
     int dma_enable;
     DmaPort dmaPort;
-    DmaReadFifo* dma_rd_engine;
-    DmaNvdla* dma_wr_engine;
+    uint32_t dma_channels;
+    DmaNvdlaChannels* dma_engine;
     uint32_t dma_try_get_length;
-    uint64_t last_dma_nvdla_addr;
-    uint32_t last_dma_actual_size;
-    uint32_t last_dma_got_size;
 
     void try_get_dma_read_data(uint32_t size);
+
+    DrainState drain() override;
+    void drainResume() override;
+
+    /**
+     * The Verilated model is saved with Wrapper_nvdla::save() to a
+     * file of its own when a trace is running, which needs the RTL
+     * built with --savable. An idle NVDLA checkpoints without it.
+     */
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 } //End namespace gem5
@@ -46,13 +46,65 @@ class rtlNVDLA(rtlObject):
 
     dma_try_get_fraction = Param.UInt64(1, "Every NVDLA tick, try get (dma_line_length / dma_try_get_fraction) bytes from DMA")
 
+    dma_channels = Param.UInt64(8, "Number of DMA channels, i.e. SPM lines transferred concurrently")
+
     spm_latency = Param.UInt64(12, "Latency for NVDLA private scratchpad memory")
 
     spm_line_size = Param.UInt64(1024, "The minimal granularity to copy data from memory to SPM")
 
     spm_line_num = Param.UInt64(64, "Capacity of SPM, counted in spm line numbers")
 
-    prefetch_enable = Param.UInt64(0, "Whether to issue software prefetch when inflight read queue is under-fed")
+    spm_assoc = Param.UInt64(8, "Associativity of the SPM, 0 for fully associative")
+
+    spm_repl_policy = Param.UInt64(0, "SPM replacement policy: 0 LRU, 1 FIFO, 2 random")
+
+    spm_write_allocate = Param.UInt64(7, "Address classes in which a SPM write miss allocates the line, the others write around to memory: bit 0 0x8 (read-only), bit 1 0x9 (write-only), bit 2 0xa (read-write)")
+
+    spm_eager_writeback = Param.Bool(True, "Write a SPM line back as soon as all of its bytes are dirty, not when it is evicted or at the end of the trace")
+
+    prefetch_enable = Param.UInt64(0, "Prefetch when the inflight read queue is under-fed: 0 off, 1 the regions logged by the compiler, 2 streams learnt online")
+
+    stream_pft_entries = Param.Unsigned(16, "Streams tracked at once by the stream prefetcher")
+
+    stream_pft_degree = Param.Unsigned(4, "Strides the stream prefetcher runs ahead of the last demand block")
+
+    stream_pft_distance = Param.Unsigned(64, "Largest distance in blocks between two reads of the same stream")
+
+    stream_pft_confidence = Param.Unsigned(2, "Stride repeats before a stream is prefetched")
+
+    stream_pft_conf_max = Param.Unsigned(3, "Saturation value of the stream confidence counter")
+
+    trace_ingest = Param.String("timing", "How the trace is read from the guest: timing (one line at a time), functional or backdoor")
+
+    backdoor_trace_load = Param.Bool(False, "Copy load_mem data straight into physical memory, bypassing caches")
+
+    write_combine = Param.Bool(True, "Merge contiguous byte writes into AXI beats before sending them to memory")
+
+    parallel_eval = Param.Bool(False, "Evaluate the RTL on a host thread of its own, in parallel with the other NVDLAs")
+
+    skip_idle = Param.Bool(False, "Stop evaluating the RTL while it only waits for memory responses")
+
+    skip_idle_threshold = Param.UInt64(16, "Consecutive quiescent cycles before the RTL stops being ticked")
+
+    dump_mem = Param.Bool(False, "Write the dump_mem data of the trace to the files it names, besides checking it against the golden answer")
+
+    record_axi = Param.Bool(False, "Record the timing AXI requests as a packet trace that TrafficGen can replay")
+
+    axi_trace_file = Param.String("", "Packet trace file for record_axi, in the output directory; <name>.axi.trc.gz by default")
+
+    layer_stats = Param.Bool(False, "Dump the stats every time the trace finishes a layer, its cycles and bytes are in the last layer stats")
+
+    bw_window = Param.UInt64(1000, "NVDLA cycles in each sample of the bandwidth histograms, 0 to disable them")
+
+    waveform_format = Param.String("vcd", "Waveform format when enableWaveform is set: vcd or fst")
+
+    waveform_start = Param.UInt64(0, "First NVDLA cycle in the waveform, counted from the trigger if any")
+
+    waveform_cycles = Param.UInt64(0, "NVDLA cycles in the waveform, 0 for no limit")
+
+    waveform_trigger = Param.UInt32(0, "CSB register whose first write opens the waveform window, 0 for none")
+
+    waveform_threaded = Param.Bool(True, "Compress the VCD waveform from a separate thread")
 
     id_nvdla = Param.UInt64(0, "id of the NVDLA")
 
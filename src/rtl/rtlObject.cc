@@ -31,6 +31,10 @@
 
 #include "rtl/rtlObject.hh"
 
+#include <algorithm>
+
+#include "cpu/base.hh"
+#include "cpu/thread_context.hh"
 #include "params/rtlObject.hh"
 
 namespace gem5
@@ -43,11 +47,37 @@ rtlObject::rtlObject(const rtlObjectParams &params) :
     enableObject(params.enableRTLObject),
     enableWaveform(params.enableWaveform),
     tickEvent([this]{ tick(); }, params.name + " tick"),
-    cyclesStat(0)
+    cyclesStat(0),
+    xlateDoneEvent([this]{ finishXlates(); }, params.name + ".xlateDone")
 {
 
 }
 
+rtlObject::XlateLink::XlateLink(rtlObject *_owner, EventQueue *_queue) :
+    owner(_owner), queue(_queue), reqBox(256), respBox(256),
+    issueEvent([this]{ owner->issueXlates(*this); },
+               _owner->name() + ".xlateIssue")
+{
+}
+
+void
+rtlObject::startup()
+{
+    if (numMainEventQueues == 1)
+        return;
+
+    // the thread contexts may move to CPUs of any queue when switching
+    for (uint32_t i = 0; i < numMainEventQueues; i++) {
+        EventQueue *q = getEventQueue(i);
+        if (q == eventQueue())
+            continue;
+        xlateLinks.emplace_back(new XlateLink(this, q));
+        XlateLink *link = xlateLinks.back().get();
+        q->addQuantumHandler([this, link]{ collectXlateRequests(*link); });
+    }
+    eventQueue()->addQuantumHandler([this]{ collectXlateResponses(); });
+}
+
 
 void
 rtlObject::CPUSidePort::sendPacket(PacketPtr pkt)
@@ -95,8 +125,6 @@ rtlObject::CPUSidePort::recvTimingReq(PacketPtr pkt)
             pkt->req->getVaddr(),
             pkt->req->getPaddr());
 
-    } else {
-        owner->handleRequest(pkt);
     }
     // Try to handle the request by calling to
     // handleRequest() function to be implemented in
@@ -122,6 +150,9 @@ rtlObject::CPUSidePort::recvRespRetry()
 
     // Try to resend it. It's possible that it fails again.
     sendPacket(pkt);
+
+    // A request refused meanwhile can be retried once the port is free
+    trySendRetry();
 }
 
 void
@@ -168,27 +199,137 @@ rtlObject::MemSidePort::recvRangeChange()
 }
 
 void
-rtlObject::startTranslate(Addr vaddr, ContextID contextId) {
+rtlObject::startTranslate(Addr vaddr, ContextID contextId, unsigned size) {
 
     DPRINTF(rtlObject, "Started translation\n");
 
-    BaseMMU * mmu =
-        system->threads[contextId]->getMMUPtr();
+    ThreadContext *tc = system->threads[contextId];
+    BaseMMU * mmu = tc->getMMUPtr();
     assert(mmu);
 
-    Fault fault;
     BaseMMU::Mode mode = BaseMMU::Write;
     RequestPtr req = std::make_shared<Request>(
-                        vaddr, 64, 0x40, 0, 0, contextId);
+                        vaddr, size, 0x40, 0, 0, contextId);
 
     WholeTranslationState *state =
         new WholeTranslationState(req, new uint8_t[64], NULL, mode);
+
+    EventQueue *cpu_queue = tc->getCpuPtr()->eventQueue();
+    if (cpu_queue != eventQueue()) {
+        auto it = std::find_if(xlateLinks.begin(), xlateLinks.end(),
+            [cpu_queue](const std::unique_ptr<XlateLink> &link) {
+                return link->queue == cpu_queue;
+            });
+        panic_if(it == xlateLinks.end(),
+                 "%s: no link to the event queue of %s\n", name(),
+                 tc->getCpuPtr()->name());
+        DPRINTF(rtlObject, "Translation of %#x posted to %s\n", vaddr,
+                tc->getCpuPtr()->name());
+        postXlate((*it)->reqBox, (*it)->reqBacklog,
+                  {state, contextId, curTick() + simQuantum});
+        return;
+    }
+
     DataTranslation<rtlObject *> *translation
         = new DataTranslation<rtlObject *>(this, state);
 
-    mmu->translateTiming(req, system->threads[contextId],
-                             translation, mode);
+    mmu->translateTiming(req, tc, translation, mode);
+
+}
+
+void
+rtlObject::postXlate(Mailbox<XlateMsg> &box, std::deque<XlateMsg> &backlog,
+                     const XlateMsg &msg)
+{
+    if (!backlog.empty() || !box.push(msg))
+        backlog.push_back(msg);
+}
+
+void
+rtlObject::flushXlates(Mailbox<XlateMsg> &box, std::deque<XlateMsg> &backlog)
+{
+    while (!backlog.empty() && box.push(backlog.front()))
+        backlog.pop_front();
+}
+
+void
+rtlObject::collectXlateRequests(XlateLink &link)
+{
+    flushXlates(link.respBox, link.respBacklog);
+
+    XlateMsg msg;
+    while (link.reqBox.pop(msg))
+        link.reqPending.push_back(msg);
+
+    if (!link.reqPending.empty() && !link.issueEvent.scheduled()) {
+        link.queue->schedule(&link.issueEvent,
+            std::max(link.reqPending.front().tick, curTick()));
+    }
+}
+
+void
+rtlObject::issueXlates(XlateLink &link)
+{
+    while (!link.reqPending.empty() &&
+           link.reqPending.front().tick <= curTick()) {
+        XlateMsg msg = link.reqPending.front();
+        link.reqPending.pop_front();
+
+        ThreadContext *tc = system->threads[msg.contextId];
+        DataTranslation<XlateLink *> *translation
+            = new DataTranslation<XlateLink *>(&link, msg.state);
+        tc->getMMUPtr()->translateTiming(msg.state->mainReq, tc,
+                                         translation, msg.state->mode);
+    }
+
+    if (!link.reqPending.empty())
+        link.queue->schedule(&link.issueEvent, link.reqPending.front().tick);
+}
+
+void
+rtlObject::XlateLink::finishTranslation(WholeTranslationState *state)
+{
+    postXlate(respBox, respBacklog,
+              {state, state->mainReq->contextId(), curTick() + simQuantum});
+}
+
+void
+rtlObject::collectXlateResponses()
+{
+    for (auto &link : xlateLinks) {
+        flushXlates(link->reqBox, link->reqBacklog);
+
+        // each link is in tick order, merge them
+        XlateMsg msg;
+        while (link->respBox.pop(msg)) {
+            auto pos = std::upper_bound(xlateDone.begin(), xlateDone.end(),
+                msg.tick, [](Tick t, const XlateMsg &m) {
+                    return t < m.tick;
+                });
+            xlateDone.insert(pos, msg);
+        }
+    }
+
+    if (xlateDone.empty())
+        return;
+    Tick when = std::max(xlateDone.front().tick, curTick());
+    if (!xlateDoneEvent.scheduled())
+        schedule(xlateDoneEvent, when);
+    else if (xlateDoneEvent.when() > when)
+        reschedule(xlateDoneEvent, when);
+}
+
+void
+rtlObject::finishXlates()
+{
+    while (!xlateDone.empty() && xlateDone.front().tick <= curTick()) {
+        WholeTranslationState *state = xlateDone.front().state;
+        xlateDone.pop_front();
+        finishTranslation(state);
+    }
 
+    if (!xlateDone.empty())
+        schedule(xlateDoneEvent, xlateDone.front().tick);
 }
 
 void
@@ -32,9 +32,12 @@
 #ifndef __RTLOBJECT_VERILATOR_HH__
 #define __RTLOBJECT_VERILATOR_HH__
 
+#include <deque>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "base/mailbox.hh"
 #include "cpu/translation.hh"
 #include "debug/rtlObject.hh"
 #include "mem/packet.hh"
@@ -257,6 +260,68 @@ protected:
 
     uint64_t cyclesStat;
 
+  private:
+    /// A translation crossing between this object and a CPU queue
+    struct XlateMsg
+    {
+        WholeTranslationState *state;
+        ContextID contextId;
+        Tick tick;
+    };
+
+    /**
+     * Translations for the CPUs of one event queue other than ours.
+     * The MMU may only be used from the thread of its CPU, so requests
+     * are posted to that queue and the results posted back, each
+     * crossing taking a simulation quantum like a MailboxBridge does.
+     */
+    class XlateLink
+    {
+      public:
+        rtlObject *owner;
+        EventQueue *queue;
+
+        /// Posted by the owner, collected by the CPU side
+        Mailbox<XlateMsg> reqBox;
+        /// Posted by the CPU side, collected by the owner
+        Mailbox<XlateMsg> respBox;
+        /// Messages that did not fit in a mailbox, on each side
+        std::deque<XlateMsg> reqBacklog;
+        std::deque<XlateMsg> respBacklog;
+        /// Requests collected by the CPU side, waiting to be issued
+        std::deque<XlateMsg> reqPending;
+        /// Issue the requests that are due, on the CPU side
+        EventFunctionWrapper issueEvent;
+
+        XlateLink(rtlObject *owner, EventQueue *queue);
+
+        /// Called by DataTranslation on the CPU side
+        void finishTranslation(WholeTranslationState *state);
+        bool isSquashed() const { return false; }
+    };
+
+    std::vector<std::unique_ptr<XlateLink>> xlateLinks;
+
+    /// Results collected from every link, by tick
+    std::deque<XlateMsg> xlateDone;
+
+    /// Hand the results that are due to finishTranslation()
+    EventFunctionWrapper xlateDoneEvent;
+
+    /// Quantum handlers of each side
+    void collectXlateResponses();
+    void collectXlateRequests(XlateLink &link);
+
+    void issueXlates(XlateLink &link);
+    void finishXlates();
+
+    /// Post a message, or keep it until there is room
+    static void postXlate(Mailbox<XlateMsg> &box,
+                          std::deque<XlateMsg> &backlog,
+                          const XlateMsg &msg);
+    static void flushXlates(Mailbox<XlateMsg> &box,
+                            std::deque<XlateMsg> &backlog);
+
   public:
 
     /** constructor
@@ -265,6 +330,8 @@ protected:
 
     virtual ~rtlObject() { delete system;};
 
+    void startup() override;
+
     /* getPort needs to be implemented in the case
        ports are being used with the rtlObject derived class
       Port &getPort(const std::string &if_name,
@@ -284,10 +351,14 @@ protected:
 
     /*
     * Functions for TLB connection
-    * finishTranslation needs to be override on derived class
+    * finishTranslation needs to be override on derived class. When
+    * the CPU of the thread runs on another event queue the translation
+    * is done there, and finishTranslation is called back on ours two
+    * simulation quanta later at the earliest.
     */
     bool isSquashed() const { return false; }
-    void startTranslate(Addr vaddr, ContextID contextId);
+    void startTranslate(Addr vaddr, ContextID contextId,
+                        unsigned size = 64);
     virtual void finishTranslation(WholeTranslationState *state);
 
     /*
@@ -0,0 +1,536 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "rtl/tlmNVDLA.hh"
+
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <limits>
+#include <sstream>
+
+#include "base/output.hh"
+#include "debug/tlmNVDLA.hh"
+#include "sim/sim_exit.hh"
+
+namespace gem5
+{
+
+// replayRequests() result once every request is issued
+static const Cycles noRequest(std::numeric_limits<uint64_t>::max());
+
+tlmNVDLA::tlmNVDLA(const tlmNVDLAParams &params) :
+    rtlNVDLA(params),
+    sampleLayers(params.sample_layers),
+    sampleCycles(params.sample_cycles),
+    rtlUncalibrated(params.rtl_uncalibrated),
+    maxRuns(params.max_runs_per_layer),
+    calibrationOut(params.calibration_out),
+    rtlSampling(sampleLayers || sampleCycles || rtlUncalibrated),
+    running(false),
+    rtlActive(false),
+    layerClosed(false),
+    layerEnd(0),
+    layerSig(0),
+    layerIndex(0),
+    layerStart(0),
+    tlmSinceRTL(0),
+    predicted(0),
+    replay(&fallback),
+    firstLive(0),
+    tlmReads(0)
+{
+    memset(zeroBeat, 0, sizeof(zeroBeat));
+    fallback.cycles = params.default_layer_cycles;
+
+    if (!params.calibration_in.empty())
+        readShapes(params.calibration_in);
+    if (!calibrationOut.empty()) {
+        registerExitCallback([this]() {
+            writeShapes(simout.resolve(calibrationOut));
+        });
+    }
+}
+
+void
+tlmNVDLA::loadTraceNVDLA(char *ptr)
+{
+    if (rtlSampling) {
+        // reset the RTL, some layer will run on it
+        rtlNVDLA::loadTraceNVDLA(ptr);
+    } else {
+        trace->load(ptr);
+        trace->load_read_var_log(ptr);
+        startBaseTrace = trace->getBaseAddr();
+        quiesc_timer = 200;
+        waiting = 0;
+    }
+
+    running = true;
+    layerIndex = 0;
+    tlmSinceRTL = Cycles(0);
+    startLayer();
+}
+
+void
+tlmNVDLA::startLayer()
+{
+    size_t first = trace->position();
+    layerEnd = trace->layer_end(first, layerSig);
+    layerStart = curCycle();
+    layerClosed = false;
+
+    auto it = shapes.find(layerSig);
+    bool calibrated = it != shapes.end();
+    rtlActive = (sampleLayers && layerIndex % sampleLayers == 0) ||
+                (sampleCycles && tlmSinceRTL >= sampleCycles) ||
+                (!calibrated && rtlUncalibrated);
+    layerIndex++;
+
+    DPRINTF(tlmNVDLA, "Layer %d: commands %d to %d, hash %#x, %s, on "
+            "the %s\n", layerIndex - 1, first, layerEnd - 1, layerSig,
+            calibrated ? "calibrated" : "not calibrated",
+            rtlActive ? "RTL" : "TLM");
+
+    if (rtlActive) {
+        predicted = calibrated ? it->second.cycles : 0;
+        recording = LayerShape();
+        openRuns.clear();
+        trace->set_fence(layerEnd == trace->num_cmds() ? SIZE_MAX :
+                                                         layerEnd);
+    } else {
+        if (!calibrated)
+            tstats.uncalibrated_layers++;
+        replay = calibrated ? &it->second : &fallback;
+        issued.assign(replay->runs.size(), 0);
+        firstLive = 0;
+
+        // there is no CSB master, the commands are done at once
+        TraceLoaderGem5::trace_cmd cmd;
+        while (trace->position() < layerEnd) {
+            trace->pop(cmd);
+            if (cmd.opcode == 5) {
+                writeAXIBulk(cmd.addr, cmd.len, cmd.buf,
+                             (cmd.addr & 0xF0000000) == 0x50000000);
+            } else if (cmd.opcode == 4) {
+                DPRINTF(tlmNVDLA, "dump_mem to %s not checked\n",
+                        cmd.fname);
+            }
+        }
+    }
+
+    if (drainState() == DrainState::Draining)
+        drainPaused = true;
+    else if (!tickEvent.scheduled())
+        schedule(tickEvent, nextCycle());
+}
+
+bool
+tlmNVDLA::portsIdle()
+{
+    if (dramPort.outstanding + sramPort.outstanding != 0 ||
+        !dramPort.pending_req.empty() || !sramPort.pending_req.empty())
+        return false;
+    return !dma_enable || (dma_engine->busyChannels() == 0 &&
+                           !dma_engine->writesPending() &&
+                           wr->output.dma_read_buffer.empty() &&
+                           wr->output.dma_write_buffer.empty());
+}
+
+bool
+tlmNVDLA::rtlLayerDone()
+{
+    return trace->position() == layerEnd && wr->csb->done() &&
+           !waiting && !waiting_for_gem5_mem && portsIdle();
+}
+
+void
+tlmNVDLA::closeRTLLayer()
+{
+    Cycles cycles = curCycle() - layerStart;
+    DPRINTF(tlmNVDLA, "RTL layer done in %d cycles, %d streams, "
+            "predicted %d\n", cycles, recording.runs.size(), predicted);
+
+    tstats.rtl_layers++;
+    tstats.rtl_cycles += cycles;
+    if (predicted && cycles) {
+        tstats.layer_error.sample(100.0 * ((double)predicted - cycles) /
+                                  cycles);
+    }
+
+    recording.cycles = cycles;
+    shapes[layerSig] = std::move(recording);
+    recording = LayerShape();
+    tlmSinceRTL = Cycles(0);
+    layerClosed = true;
+}
+
+void
+tlmNVDLA::observeAXI(uint32_t addr, bool sram, bool write, unsigned size)
+{
+    if (rtlActive && !layerClosed)
+        recordRequest(addr, sram, write, size);
+}
+
+void
+tlmNVDLA::recordRequest(uint32_t addr, bool sram, bool write,
+                        unsigned size)
+{
+    const unsigned beat = AXI_WIDTH / 8;
+    if (size > beat) {
+        // DMA transfers are replayed as AXI beats
+        for (unsigned off = 0; off < size; off += beat)
+            recordRequest(addr + off, sram, write,
+                          std::min(beat, size - off));
+        return;
+    }
+
+    uint32_t now = curCycle() - layerStart;
+    for (size_t k = 0; k < openRuns.size(); k++) {
+        AxiRun &run = recording.runs[openRuns[k]];
+        if (run.write != write || run.sram != sram || run.size != size ||
+            run.addr + run.count * size != addr)
+            continue;
+
+        // a stream that stops for long is a new one, its requests
+        // are replayed evenly spaced
+        uint32_t pace = run.count > 1 ?
+            (run.end - run.start) / (run.count - 1) : 0;
+        if (now - run.end > std::max<uint32_t>(64, 4 * pace))
+            continue;
+
+        run.count++;
+        run.end = now;
+        std::rotate(openRuns.begin(), openRuns.begin() + k,
+                    openRuns.begin() + k + 1);
+        return;
+    }
+
+    if (recording.runs.size() >= maxRuns) {
+        tstats.dropped_requests++;
+        return;
+    }
+    recording.runs.push_back({now, now, addr, size, 1, write, sram});
+    openRuns.insert(openRuns.begin(), recording.runs.size() - 1);
+    if (openRuns.size() > numOpenRuns)
+        openRuns.pop_back();
+}
+
+Cycles
+tlmNVDLA::replayRequests(Cycles now)
+{
+    const std::vector<AxiRun> &runs = replay->runs;
+    while (firstLive < runs.size() &&
+           issued[firstLive] == runs[firstLive].count)
+        firstLive++;
+
+    Cycles next = noRequest;
+    for (size_t r = firstLive; r < runs.size(); r++) {
+        const AxiRun &run = runs[r];
+        // the runs are sorted by their first request
+        if (run.start > now) {
+            next = std::min(next, Cycles(run.start));
+            break;
+        }
+
+        while (issued[r] < run.count) {
+            uint32_t i = issued[r];
+            uint64_t due = run.start;
+            if (run.count > 1)
+                due += (uint64_t)(run.end - run.start) * i / (run.count - 1);
+            if (due > now) {
+                next = std::min(next, Cycles(due));
+                break;
+            }
+            if (!run.write && tlmReads >= max_req_inflight) {
+                // a response will wake us up
+                next = std::min(next, now);
+                break;
+            }
+
+            uint32_t addr = run.addr + i * run.size;
+            if (run.write) {
+                // no byte enabled, the memory keeps its contents
+                writeAXILong(addr, run.size, zeroBeat, 0, run.sram, true);
+            } else {
+                readAXIVariable(addr, run.sram, true, run.size);
+                tlmReads++;
+            }
+            issued[r]++;
+            tstats.tlm_requests++;
+        }
+    }
+    return next;
+}
+
+void
+tlmNVDLA::tick()
+{
+    if (drainState() == DrainState::Draining || !running) {
+        rtlNVDLA::tick();
+        return;
+    }
+
+    if (rtlActive) {
+        if (!layerClosed && rtlLayerDone()) {
+            closeRTLLayer();
+            if (layerEnd < trace->num_cmds()) {
+                startLayer();
+                return;
+            }
+        }
+        rtlNVDLA::tick();
+        return;
+    }
+
+    Cycles now = curCycle() - layerStart;
+    Cycles next = replayRequests(now);
+    dramPort.tick();
+    sramPort.tick();
+
+    if (next == noRequest && now >= replay->cycles && portsIdle()) {
+        tstats.tlm_layers++;
+        tstats.tlm_cycles += now;
+        tlmSinceRTL += now;
+        if (layerEnd < trace->num_cmds()) {
+            startLayer();
+        } else {
+            running = false;
+            printf("nvdla#%lu done, %lu of %lu layers on the TLM, their "
+                   "outputs are not checked\n", id_nvdla,
+                   (uint64_t)tstats.tlm_layers.value(), layerIndex);
+            finishTrace();
+        }
+        return;
+    }
+
+    if (!dramPort.pending_req.empty() || !sramPort.pending_req.empty())
+        schedule(tickEvent, nextCycle());
+    else if (next != noRequest && next > now)
+        schedule(tickEvent, clockEdge(next - now));
+    else if (next == noRequest && now < replay->cycles)
+        schedule(tickEvent, clockEdge(Cycles(replay->cycles - now)));
+    // otherwise a response wakes us up
+}
+
+bool
+tlmNVDLA::handleResponseNVDLA(PacketPtr pkt, bool sram)
+{
+    if (rtlActive)
+        return rtlNVDLA::handleResponseNVDLA(pkt, sram);
+
+    if (pkt->isRead()) {
+        assert(tlmReads > 0);
+        tlmReads--;
+    }
+    if (!tickEvent.scheduled())
+        schedule(tickEvent, nextCycle());
+    return true;
+}
+
+DrainState
+tlmNVDLA::drain()
+{
+    DrainState state = rtlNVDLA::drain();
+    // the TLM may be waiting for a response with nothing scheduled
+    if (running && !rtlActive)
+        drainPaused = true;
+    return state;
+}
+
+void
+tlmNVDLA::writeShape(std::ostream &os, uint64_t sig,
+                     const LayerShape &shape)
+{
+    os << "layer " << std::hex << sig << std::dec << " " << shape.cycles
+       << " " << shape.runs.size() << "\n";
+    for (const AxiRun &run : shape.runs) {
+        os << run.start << " " << run.end << " " << std::hex << run.addr
+           << std::dec << " " << run.size << " " << run.count << " "
+           << run.write << " " << run.sram << "\n";
+    }
+}
+
+void
+tlmNVDLA::writeShapes(const std::string &path) const
+{
+    std::ofstream os(path);
+    os << "# tlmNVDLA layer traffic: layer <hash> <cycles> <streams>,\n"
+       << "# then <start> <end> <addr> <size> <count> <write> <sram>\n";
+    for (const auto &entry : shapes)
+        writeShape(os, entry.first, entry.second);
+    fatal_if(!os, "%s: could not write %s\n", name(), path);
+}
+
+void
+tlmNVDLA::readShapes(const std::string &path)
+{
+    std::ifstream is(path);
+    fatal_if(!is, "%s: could not open %s\n", name(), path);
+
+    std::string line;
+    while (std::getline(is, line)) {
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        std::istringstream ls(line);
+        std::string tag;
+        uint64_t sig;
+        size_t num_runs;
+        ls >> tag >> std::hex >> sig >> std::dec;
+        LayerShape &shape = shapes[sig];
+        ls >> shape.cycles >> num_runs;
+        fatal_if(tag != "layer" || !ls, "%s: bad layer in %s: %s\n",
+                 name(), path, line);
+
+        shape.runs.resize(num_runs);
+        for (AxiRun &run : shape.runs) {
+            is >> run.start >> run.end >> std::hex >> run.addr >> std::dec
+               >> run.size >> run.count >> run.write >> run.sram;
+        }
+        fatal_if(!is, "%s: truncated layer %#x in %s\n", name(), sig,
+                 path);
+        std::getline(is, line);
+    }
+    DPRINTF(tlmNVDLA, "%d layers calibrated from %s\n", shapes.size(),
+            path);
+}
+
+void
+tlmNVDLA::serialize(CheckpointOut &cp) const
+{
+    rtlNVDLA::serialize(cp);
+
+    SERIALIZE_SCALAR(running);
+    SERIALIZE_SCALAR(rtlActive);
+    SERIALIZE_SCALAR(layerClosed);
+    SERIALIZE_SCALAR(layerSig);
+    SERIALIZE_SCALAR(layerIndex);
+    SERIALIZE_SCALAR(predicted);
+    uint64_t layer_end = layerEnd;
+    SERIALIZE_SCALAR(layer_end);
+    uint64_t layer_cycles = curCycle() - layerStart;
+    SERIALIZE_SCALAR(layer_cycles);
+    uint64_t tlm_since_rtl = tlmSinceRTL;
+    SERIALIZE_SCALAR(tlm_since_rtl);
+    bool calibrated = replay != &fallback;
+    SERIALIZE_SCALAR(calibrated);
+    SERIALIZE_CONTAINER(issued);
+
+    // the layers recorded by this run and the one being recorded
+    std::string shapes_file = name() + ".shapes";
+    std::ofstream os(CheckpointIn::dir() + "/" + shapes_file);
+    for (const auto &entry : shapes)
+        writeShape(os, entry.first, entry.second);
+    writeShape(os, 0, recording);
+    fatal_if(!os, "%s: could not write %s\n", name(), shapes_file);
+    SERIALIZE_SCALAR(shapes_file);
+}
+
+void
+tlmNVDLA::unserialize(CheckpointIn &cp)
+{
+    rtlNVDLA::unserialize(cp);
+
+    UNSERIALIZE_SCALAR(running);
+    UNSERIALIZE_SCALAR(rtlActive);
+    UNSERIALIZE_SCALAR(layerClosed);
+    UNSERIALIZE_SCALAR(layerSig);
+    UNSERIALIZE_SCALAR(layerIndex);
+    UNSERIALIZE_SCALAR(predicted);
+    uint64_t layer_end;
+    UNSERIALIZE_SCALAR(layer_end);
+    layerEnd = layer_end;
+    uint64_t layer_cycles;
+    UNSERIALIZE_SCALAR(layer_cycles);
+    layerStart = curCycle() - Cycles(layer_cycles);
+    uint64_t tlm_since_rtl;
+    UNSERIALIZE_SCALAR(tlm_since_rtl);
+    tlmSinceRTL = Cycles(tlm_since_rtl);
+    bool calibrated;
+    UNSERIALIZE_SCALAR(calibrated);
+    UNSERIALIZE_CONTAINER(issued);
+
+    std::string shapes_file;
+    UNSERIALIZE_SCALAR(shapes_file);
+    shapes.clear();
+    readShapes(cp.getCptDir() + "/" + shapes_file);
+    // the recording was saved last, with a hash of 0
+    recording = std::move(shapes[0]);
+    shapes.erase(0);
+    openRuns.clear();
+
+    replay = calibrated ? &shapes[layerSig] : &fallback;
+    firstLive = 0;
+    tlmReads = 0;
+}
+
+void
+tlmNVDLA::regStats()
+{
+    rtlNVDLA::regStats();
+
+    using namespace statistics;
+
+    tstats.tlm_layers
+        .name(name() + ".tlm_layers")
+        .desc("Number of layers run on the TLM");
+
+    tstats.rtl_layers
+        .name(name() + ".rtl_layers")
+        .desc("Number of layers run on the RTL");
+
+    tstats.uncalibrated_layers
+        .name(name() + ".uncalibrated_layers")
+        .desc("Number of TLM layers with no recorded traffic");
+
+    tstats.tlm_cycles
+        .name(name() + ".tlm_cycles")
+        .desc("Cycles of the layers run on the TLM");
+
+    tstats.rtl_cycles
+        .name(name() + ".rtl_cycles")
+        .desc("Cycles of the layers run on the RTL");
+
+    tstats.tlm_requests
+        .name(name() + ".tlm_requests")
+        .desc("Number of memory requests replayed by the TLM");
+
+    tstats.dropped_requests
+        .name(name() + ".dropped_requests")
+        .desc("Number of RTL requests not recorded, too many streams");
+
+    tstats.layer_error
+        .init(-100, 100, 10)
+        .name(name() + ".layer_error")
+        .desc("Error in percent of the calibrated duration of the "
+              "layers sampled on the RTL")
+        .flags(pdf);
+}
+
+} // namespace gem5
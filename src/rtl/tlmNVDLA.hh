@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_TLM_NVDLA_HH__
+#define __RTL_TLM_NVDLA_HH__
+
+#include <iosfwd>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "params/tlmNVDLA.hh"
+#include "rtl/rtlNVDLA.hh"
+
+namespace gem5
+{
+
+/**
+ * Transaction-level NVDLA.
+ *
+ * The trace is split in layers, each one ending with the wait for the
+ * interrupt and the status read and clear that follow it. A layer run
+ * on the RTL has its DBBIF/CVSRAM requests recorded as streams of
+ * sequential requests, together with its duration, and keyed by a
+ * hash of its commands. A layer run on the TLM does not evaluate
+ * anything: its commands are consumed at once (load_mem still writes
+ * memory, register reads and dump_mem are not checked) and the
+ * recorded streams are replayed against memory at their recorded
+ * pace, with the same limit of reads in flight as the RTL. The layer
+ * ends once its requests are done and its recorded duration has
+ * passed.
+ *
+ * Which layers go to the RTL is chosen with sample_layers,
+ * sample_cycles and rtl_uncalibrated. The RTL only sees the commands
+ * of its own layers, so switching relies on the trace programming
+ * every layer completely, as the compiler traces do. Memory written
+ * by TLM layers is left untouched, outputs are only correct when every
+ * layer runs on the RTL.
+ */
+class tlmNVDLA : public rtlNVDLA
+{
+  private:
+    /// Requests of one size to consecutive addresses
+    struct AxiRun
+    {
+        /// Cycles from the start of the layer to the first request
+        uint32_t start;
+        /// and to the last one
+        uint32_t end;
+        uint32_t addr;
+        uint32_t size;
+        uint32_t count;
+        bool write;
+        bool sram;
+    };
+
+    /// Traffic of a layer as seen on the RTL
+    struct LayerShape
+    {
+        uint64_t cycles = 0;
+        std::vector<AxiRun> runs;
+    };
+
+    /// Recorded layers, by hash of their commands
+    std::unordered_map<uint64_t, LayerShape> shapes;
+
+    const uint64_t sampleLayers;
+    const Cycles sampleCycles;
+    const bool rtlUncalibrated;
+    const uint64_t maxRuns;
+    const std::string calibrationOut;
+
+    /// Some layer may go to the RTL, it has to be reset
+    const bool rtlSampling;
+
+    /// A trace is being run
+    bool running;
+    /// The current layer runs on the RTL
+    bool rtlActive;
+    /// The RTL finished the current layer, the trace is finishing
+    bool layerClosed;
+
+    /// First command of the next layer
+    size_t layerEnd;
+    /// Hash of the commands of the current layer
+    uint64_t layerSig;
+    uint64_t layerIndex;
+    Cycles layerStart;
+    /// TLM cycles since a layer ran on the RTL
+    Cycles tlmSinceRTL;
+
+    /// Traffic of the RTL layer being recorded
+    LayerShape recording;
+    /// Recent streams of recording, new requests try to extend them
+    std::vector<size_t> openRuns;
+    static const size_t numOpenRuns = 8;
+    /// Duration predicted for the RTL layer, 0 if not calibrated
+    uint64_t predicted;
+
+    /// Shape replayed by the TLM layer
+    LayerShape fallback;
+    const LayerShape *replay;
+    /// Requests issued of every run of replay
+    std::vector<uint32_t> issued;
+    /// Runs before this one are completely issued
+    size_t firstLive;
+    /// TLM reads waiting for their response
+    unsigned tlmReads;
+    /// Payload of the TLM writes, which have no byte enabled
+    uint8_t zeroBeat[AXI_WIDTH / 8];
+
+    struct tlm_stats
+    {
+        statistics::Scalar tlm_layers;
+        statistics::Scalar rtl_layers;
+        statistics::Scalar uncalibrated_layers;
+        statistics::Scalar tlm_cycles;
+        statistics::Scalar rtl_cycles;
+        statistics::Scalar tlm_requests;
+        statistics::Scalar dropped_requests;
+        statistics::Distribution layer_error;
+    };
+    tlm_stats tstats;
+
+    /** Start the layer at the current command of the trace */
+    void startLayer();
+
+    /** The RTL has run all the commands of its layer */
+    bool rtlLayerDone();
+
+    /** Store what was recorded for the RTL layer */
+    void closeRTLLayer();
+
+    /** Nothing of the NVDLA left in the memory system */
+    bool portsIdle();
+
+    /**
+     * Issue the requests of the TLM layer due by cycle now.
+     *
+     * @return Cycle of the next request, MaxCycles if none is left
+     */
+    Cycles replayRequests(Cycles now);
+
+    void recordRequest(uint32_t addr, bool sram, bool write, unsigned size);
+
+    static void writeShape(std::ostream &os, uint64_t sig,
+                           const LayerShape &shape);
+    void writeShapes(const std::string &path) const;
+    void readShapes(const std::string &path);
+
+  protected:
+    bool handleResponseNVDLA(PacketPtr pkt, bool sram) override;
+
+    void observeAXI(uint32_t addr, bool sram, bool write,
+                    unsigned size) override;
+
+  public:
+    tlmNVDLA(const tlmNVDLAParams &params);
+
+    void tick() override;
+
+    void loadTraceNVDLA(char *ptr) override;
+
+    void regStats() override;
+
+    DrainState drain() override;
+
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
+};
+
+} // namespace gem5
+
+#endif // __RTL_TLM_NVDLA_HH__
@@ -0,0 +1,50 @@
+# -*- coding: utf-8 -*-
+# Copyright (c) 2026 agent
+# All rights reserved.
+#
+# Redistribution and use in source and binary forms, with or without
+# modification, are permitted provided that the following conditions are
+# met: redistributions of source code must retain the above copyright
+# notice, this list of conditions and the following disclaimer;
+# redistributions in binary form must reproduce the above copyright
+# notice, this list of conditions and the following disclaimer in the
+# documentation and/or other materials provided with the distribution;
+# neither the name of the copyright holders nor the names of its
+# contributors may be used to endorse or promote products derived from
+# this software without specific prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+# "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+# LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+# A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+# OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+# SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+# LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+# DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+# THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+# (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+# OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+
+
+from m5.params import *
+from m5.proxy import *
+from m5.objects.rtlNVDLA import rtlNVDLA
+
+class tlmNVDLA(rtlNVDLA):
+    type = 'tlmNVDLA'
+    cxx_header = "rtl/tlmNVDLA.hh"
+    cxx_class = 'gem5::tlmNVDLA'
+
+    sample_layers = Param.UInt64(0, "Run one layer in every sample_layers on the RTL, 0 to disable")
+
+    sample_cycles = Param.UInt64(0, "Run the next layer on the RTL after this many TLM cycles, 0 to disable")
+
+    rtl_uncalibrated = Param.Bool(True, "Run the layers with no calibrated traffic on the RTL")
+
+    default_layer_cycles = Param.UInt64(10000, "Cycles of a layer with no calibrated traffic run on the TLM")
+
+    max_runs_per_layer = Param.UInt64(65536, "Address streams recorded per layer, the requests beyond are dropped")
+
+    calibration_in = Param.String("", "Layer traffic recorded by previous runs")
+
+    calibration_out = Param.String("", "File in the output directory where the recorded layer traffic is written at exit")
@@ -0,0 +1,81 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __RTL_TRACE_BUFFER_HH__
+#define __RTL_TRACE_BUFFER_HH__
+
+#include <cstddef>
+#include <vector>
+
+namespace gem5
+{
+
+/**
+ * Holds the trace an accelerator is running. The trace loader replays
+ * straight from this memory, so it is handed to a single trace at a
+ * time: a new start is refused until the running trace has finished
+ * and its completion has been sent.
+ */
+class TraceBuffer
+{
+  public:
+    /**
+     * Take the buffer for a trace of the given size.
+     *
+     * @return false if the previous trace is still running
+     */
+    bool
+    acquire(size_t size)
+    {
+        if (busy)
+            return false;
+        // the capacity is kept from one trace to the next
+        buf.resize(size);
+        busy = true;
+        return true;
+    }
+
+    /** Mark the buffer as used without filling it, as on a restore. */
+    void hold() { busy = true; }
+
+    /** The running trace has finished, the buffer can be taken again. */
+    void release() { busy = false; }
+
+    bool inUse() const { return busy; }
+
+    char *data() { return buf.data(); }
+    size_t size() const { return buf.size(); }
+
+  private:
+    std::vector<char> buf;
+    bool busy = false;
+};
+
+} // namespace gem5
+
+#endif // __RTL_TRACE_BUFFER_HH__
@@ -0,0 +1,71 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <cstring>
+
+#include "rtl/traceBuffer.hh"
+
+using namespace gem5;
+
+/**
+ * A second start while a trace runs is refused and leaves the running
+ * trace untouched, it is accepted once the first one has finished.
+ */
+TEST(TraceBufferTest, SecondStartWhileRunning)
+{
+    TraceBuffer tb;
+
+    ASSERT_TRUE(tb.acquire(256));
+    memset(tb.data(), 0x11, 256);
+    const char *running = tb.data();
+
+    ASSERT_FALSE(tb.acquire(4096));
+    ASSERT_TRUE(tb.inUse());
+    ASSERT_EQ(tb.data(), running);
+    ASSERT_EQ(tb.size(), 256);
+    for (size_t i = 0; i < 256; i++)
+        ASSERT_EQ(tb.data()[i], 0x11);
+
+    tb.release();
+    ASSERT_FALSE(tb.inUse());
+    ASSERT_TRUE(tb.acquire(4096));
+    ASSERT_EQ(tb.size(), 4096);
+}
+
+/** A restored running trace keeps new starts out until it finishes. */
+TEST(TraceBufferTest, HoldOnRestore)
+{
+    TraceBuffer tb;
+
+    tb.hold();
+    ASSERT_FALSE(tb.acquire(64));
+    tb.release();
+    ASSERT_TRUE(tb.acquire(64));
+}
@@ -10,9 +10,104 @@
 
 #include "rtl/traceLoaderGem5.hh"
 
+#include <algorithm>
+#include <condition_variable>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <mutex>
+#include <thread>
+
+#include "base/logging.hh"
+
 namespace gem5
 {
 
+namespace
+{
+
+/**
+ * Writes the AXI_DUMPMEM data to disk from a host thread of its own,
+ * the simulation only hands the buffers over. One thread serves all
+ * the NVDLAs.
+ */
+class DumpWriter
+{
+  public:
+    static DumpWriter &
+    instance()
+    {
+        static DumpWriter writer;
+        return writer;
+    }
+
+    void
+    post(const std::string &fname, std::vector<uint8_t> &&data)
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!worker.joinable())
+            worker = std::thread([this]() { run(); });
+        jobs.emplace_back(fname, std::move(data));
+        wake.notify_one();
+    }
+
+    void
+    flush()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        idle.wait(guard, [this]() { return jobs.empty() && !busy; });
+    }
+
+    ~DumpWriter()
+    {
+        {
+            std::lock_guard<std::mutex> guard(lock);
+            stop = true;
+            wake.notify_one();
+        }
+        if (worker.joinable())
+            worker.join();
+    }
+
+  private:
+    std::mutex lock;
+    std::condition_variable wake;
+    std::condition_variable idle;
+    std::deque<std::pair<std::string, std::vector<uint8_t>>> jobs;
+    bool busy = false;
+    bool stop = false;
+    std::thread worker;
+
+    void
+    run()
+    {
+        std::unique_lock<std::mutex> guard(lock);
+        while (true) {
+            wake.wait(guard, [this]() { return stop || !jobs.empty(); });
+            if (jobs.empty())
+                return;
+            auto job = std::move(jobs.front());
+            jobs.pop_front();
+            busy = true;
+            guard.unlock();
+
+            std::ofstream out(job.first, std::ios::binary | std::ios::trunc);
+            out.write((const char *)job.second.data(), job.second.size());
+            if (!out)
+                printf("AXI: could not write memory dump to %s\n",
+                       job.first.c_str());
+
+            guard.lock();
+            busy = false;
+            if (jobs.empty())
+                idle.notify_all();
+        }
+    }
+};
+
+} // anonymous namespace
+
 TraceLoaderGem5::TraceLoaderGem5(CSBMaster *_csb,
                                  AXIResponder *_axi_dbb,
                                  AXIResponder *_axi_cvsram) {
@@ -21,138 +116,249 @@ TraceLoaderGem5::TraceLoaderGem5(CSBMaster *_csb,
         axi_cvsram = _axi_cvsram;
         _test_passed = 1;
         base_addr = -1;
+        trace = NULL;
+        next_cmd = 0;
+        fence = SIZE_MAX;
+        dump_files = false;
     }
 
 void
 TraceLoaderGem5::read_local(int &last, const char *buffer_trace,
                             void *buffer, unsigned int nbytes) {
-    char *buffer_char = (char*) buffer;
-
-    for (int i = 0; i < nbytes; i++) {
-        buffer_char[i] = buffer_trace[last+i];
-    }
-
+    memcpy(buffer, buffer_trace + last, nbytes);
     last += nbytes;
 }
 
 void
-TraceLoaderGem5::load(const char *trace) {
+TraceLoaderGem5::load(const char *_trace) {
     int last = 0;
     unsigned char cmd;
+    uint64_t payload = 0;
 
-// original
-//#define VERILY_READ(p, n) do { read_local(last, (trace), (p), (n));
-//} while (0)
-#define VERILY_READ(p, n) {\
-    read_local(last, (trace), (p), (n));\
-}
+    trace = _trace;
+    index.clear();
+    next_cmd = 0;
+    fence = SIZE_MAX;
+
+    // one pass over the command headers, payloads are skipped
     do {
-        VERILY_READ(&cmd, 1);
+        uint32_t pos = last;
+        read_local(last, trace, &cmd, 1);
 
         switch (cmd) {
-        case 1: {
-            printf("CMD: wait\n");
-            csb->ext_event(TRACE_WFI);
+        case 1:
+        case 7:
             break;
-        }
-        case 2: {
-            uint32_t addr;
-            uint32_t data;
-            VERILY_READ(&addr, 4);
-            VERILY_READ(&data, 4);
-            printf("CMD: write_reg %08x %08x\n", addr, data);
-            csb->write(addr, data);
+        case 2:
+        case 6:
+            last += 8;
             break;
-        }
-        case 3: {
-            uint32_t addr;
-            uint32_t mask;
-            uint32_t data;
-            VERILY_READ(&addr, 4);
-            VERILY_READ(&mask, 4);
-            VERILY_READ(&data, 4);
-            printf("CMD: read_reg %08x %08x %08x\n", addr, mask, data);
-            csb->read(addr, mask, data);
+        case 3:
+            last += 12;
             break;
-        }
         case 4: {
-            uint32_t addr;
-            uint32_t len;
-            uint8_t *buf;
-            uint32_t namelen;
-            char *fname;
-            axi_op op;
-
-            VERILY_READ(&addr, 4);
-            VERILY_READ(&len, 4);
-            buf = (uint8_t *)malloc(len);
-            VERILY_READ(buf, len);
-
-            VERILY_READ(&namelen, 4);
-            fname = (char *) malloc(namelen+1);
-            VERILY_READ(fname, namelen);
-            fname[namelen] = 0;
-
-            op.opcode = AXI_DUMPMEM;
-            op.addr = addr;
-            op.len = len;
-            op.buf = buf;
-            op.fname = fname;
-            opq.push(op);
-            csb->ext_event(TRACE_AXIEVENT);
-
-            printf("CMD: dump_mem %08x bytes from %08x -> %s\n",
-                    len, addr, fname);
+            uint32_t len, namelen;
+            last += 4;
+            read_local(last, trace, &len, 4);
+            last += len;
+            read_local(last, trace, &namelen, 4);
+            last += namelen;
             break;
         }
         case 5: {
-            uint32_t addr;
-            uint32_t len;
-            uint8_t *buf;
-            axi_op op;
-
-            VERILY_READ(&addr, 4);
-            VERILY_READ(&len, 4);
-            buf = (uint8_t *)malloc(len);
-            VERILY_READ(buf, len);
-
-            op.opcode = AXI_LOADMEM;
-            op.addr = addr;
-            op.len = len;
-            op.buf = buf;
-            opq.push(op);
-            csb->ext_event(TRACE_AXIEVENT);
+            uint32_t addr, len;
+            read_local(last, trace, &addr, 4);
+            read_local(last, trace, &len, 4);
+            last += len;
+            payload += len;
             base_addr = addr&0xF0000000;
-
-            printf("CMD: load_mem %08x bytes to %08x\n", len, addr);
-            break;
-        }
-        case 6: {
-            uint32_t addr;
-            uint32_t data;
-
-            VERILY_READ(&addr, 4);
-            VERILY_READ(&data, 4);
-            printf("CMD: until %08x %08x\n", addr, data);
-            csb->wait_until(addr, uint32_t(0xffffffff), data);
             break;
         }
-        case 7: {
-            printf("CMD: reset\n");
-            csb->ext_event(TRACE_RESET);
+        case 0xFF:
             break;
-        }
-        case 0xFF: {
-            printf("CMD: done\n");
-            break;
-        }
         default:
             printf("unknown command %c\n", cmd);
             abort();
         }
+
+        if (cmd != 0xFF)
+            index.push_back(pos);
     } while (cmd != 0xFF);
 
     trace_size = last;      // update reg trace size
+    printf("trace: %lu commands, %lu bytes of load_mem data\n",
+           index.size(), payload);
+}
+
+void
+TraceLoaderGem5::feed() {
+    size_t end = std::min(index.size(), fence);
+    while (next_cmd < end && csb->pending() < feed_window)
+        decode(next_cmd++);
+}
+
+void
+TraceLoaderGem5::parse(size_t i, trace_cmd &cmd) const {
+    int last = index[i];
+    uint32_t namelen;
+
+#define VERILY_READ(p, n) {\
+    memcpy((p), trace + last, (n));\
+    last += (n);\
+}
+    VERILY_READ(&cmd.opcode, 1);
+
+    switch (cmd.opcode) {
+    case 1:
+    case 7:
+        break;
+    case 2:
+    case 6:
+        VERILY_READ(&cmd.addr, 4);
+        VERILY_READ(&cmd.data, 4);
+        break;
+    case 3:
+        VERILY_READ(&cmd.addr, 4);
+        VERILY_READ(&cmd.mask, 4);
+        VERILY_READ(&cmd.data, 4);
+        break;
+    case 4:
+        VERILY_READ(&cmd.addr, 4);
+        VERILY_READ(&cmd.len, 4);
+        cmd.buf = (const uint8_t *)trace + last;
+        last += cmd.len;
+        VERILY_READ(&namelen, 4);
+        cmd.fname.assign(trace + last, namelen);
+        break;
+    case 5:
+        VERILY_READ(&cmd.addr, 4);
+        VERILY_READ(&cmd.len, 4);
+        cmd.buf = (const uint8_t *)trace + last;
+        break;
+    default:
+        printf("unknown command %c\n", cmd.opcode);
+        abort();
+    }
+#undef VERILY_READ
+}
+
+size_t
+TraceLoaderGem5::layer_end(size_t first, uint64_t &sig) const {
+    // FNV-1a over the commands, payloads are not hashed
+    sig = 0xcbf29ce484222325ULL;
+    auto mix = [&sig](uint64_t v) {
+        for (int b = 0; b < 8; b++, v >>= 8) {
+            sig ^= v & 0xff;
+            sig *= 0x100000001b3ULL;
+        }
+    };
+
+    trace_cmd cmd;
+    size_t n = index.size();
+    size_t i = first;
+    while (i < n) {
+        parse(i++, cmd);
+        mix(cmd.opcode);
+        if (cmd.opcode == 2 || cmd.opcode == 6)
+            mix(((uint64_t)cmd.addr << 32) | cmd.data);
+        else if (cmd.opcode == 3 || cmd.opcode == 4 || cmd.opcode == 5)
+            mix(cmd.addr);
+
+        if (cmd.opcode != 1 && cmd.opcode != 6)
+            continue;
+
+        // the status reads after the interrupt and the writes that
+        // clear it belong to the layer
+        std::vector<uint32_t> status;
+        for (; i < n; i++) {
+            parse(i, cmd);
+            if (cmd.opcode != 3)
+                break;
+            status.push_back(cmd.addr);
+            mix(cmd.opcode);
+            mix(cmd.addr);
+        }
+        for (; i < n; i++) {
+            parse(i, cmd);
+            if (cmd.opcode != 2 ||
+                std::find(status.begin(), status.end(), cmd.addr) ==
+                status.end())
+                break;
+            mix(cmd.opcode);
+            mix(((uint64_t)cmd.addr << 32) | cmd.data);
+        }
+        break;
+    }
+    return i;
+}
+
+void
+TraceLoaderGem5::decode(size_t i) {
+    trace_cmd cmd;
+    parse(i, cmd);
+
+    switch (cmd.opcode) {
+    case 1: {
+#ifdef PRINT_DEBUG
+        printf("CMD: wait\n");
+#endif
+        csb->ext_event(TRACE_WFI);
+        break;
+    }
+    case 2: {
+#ifdef PRINT_DEBUG
+        printf("CMD: write_reg %08x %08x\n", cmd.addr, cmd.data);
+#endif
+        csb->write(cmd.addr, cmd.data);
+        break;
+    }
+    case 3: {
+#ifdef PRINT_DEBUG
+        printf("CMD: read_reg %08x %08x %08x\n", cmd.addr, cmd.mask,
+               cmd.data);
+#endif
+        csb->read(cmd.addr, cmd.mask, cmd.data);
+        break;
+    }
+    case 4: {
+        axi_op op;
+        op.opcode = AXI_DUMPMEM;
+        op.addr = cmd.addr;
+        op.len = cmd.len;
+        op.buf = cmd.buf;
+        op.fname = cmd.fname;
+        opq.push(op);
+        csb->ext_event(TRACE_AXIEVENT);
+
+        printf("CMD: dump_mem %08x bytes from %08x -> %s\n",
+                cmd.len, cmd.addr, op.fname.c_str());
+        break;
+    }
+    case 5: {
+        axi_op op;
+        op.opcode = AXI_LOADMEM;
+        op.addr = cmd.addr;
+        op.len = cmd.len;
+        op.buf = cmd.buf;
+        opq.push(op);
+        csb->ext_event(TRACE_AXIEVENT);
+
+        printf("CMD: load_mem %08x bytes to %08x\n", cmd.len, cmd.addr);
+        break;
+    }
+    case 6: {
+#ifdef PRINT_DEBUG
+        printf("CMD: until %08x %08x\n", cmd.addr, cmd.data);
+#endif
+        csb->wait_until(cmd.addr, uint32_t(0xffffffff), cmd.data);
+        break;
+    }
+    case 7: {
+        printf("CMD: reset\n");
+        csb->ext_event(TRACE_RESET);
+        break;
+    }
+    }
 }
 
 void
@@ -200,35 +406,21 @@ TraceLoaderGem5::axievent(int* waiting_for_gem5_mem) {
     // we can modify this function to write to the DRAM
     case AXI_LOADMEM: {
         // here we are at the beginning of the trace, and hence
-        // we don't care much about timing
-        const uint8_t *buf = op.buf;
+        // we don't care much about timing: the whole block is written
+        // functionally, straight from the trace
         printf("AXI: loading (TRACE) memory at 0x%08x, length = %d\n",\
         op.addr, op.len);
-        while (op.len) {
-            // this op we can do it atomicly
-            // don't access in timing here
-            axi->write(op.addr, *buf, false);
-            buf++;
-            op.addr++;
-            op.len--;
-        }
+        axi->write_block(op.addr, op.buf, op.len);
         break;
     }
 
     case AXI_DUMPMEM: {
-        int fd;
-        const uint8_t *buf = op.buf;
-        int matched = 1;
-
         if (!*waiting_for_gem5_mem) {
-            // create the file to dump to
-            printf("AXI: dumping memory to %s, length = %d\n", op.fname, op.len);
-            fd = creat(op.fname, 0666);
-            if (!fd) {
-                perror("creat(dumpmem)");
-                break;
-            }
-            close(fd);
+            printf("AXI: dumping memory%s%s, length = %d\n",
+                   dump_files ? " to " : "",
+                   dump_files ? op.fname.c_str() : "", op.len);
+            dump.clear();
+            dump.reserve(op.len);
 
             // issue memory reading request
             axi->read_for_traceLoaderGem5(op.addr, op.len);
@@ -266,15 +458,8 @@ TraceLoaderGem5::axievent(int* waiting_for_gem5_mem) {
                     op.len -= (AXI_WIDTH / 8);
                 }
 
-                // continue writing the file created above
-                fd = open(op.fname, O_WRONLY | O_APPEND);
-                if (!fd) {
-                    perror("Open file failed.\n");
-                    abort();
-                }
-
-                write(fd, read_response_buffer + (old_op_addr - txn_start_addr), bytes_to_write);
-                close(fd);
+                const uint8_t *data = read_response_buffer + (old_op_addr - txn_start_addr);
+                dump.insert(dump.end(), data, data + bytes_to_write);
 
                 if (op.len <= 0) {
                     if (axi->getRequestsOnFlight() != 0) {
@@ -283,25 +468,20 @@ TraceLoaderGem5::axievent(int* waiting_for_gem5_mem) {
                     }
                     *waiting_for_gem5_mem = 0;
 
-                    // check answer
-                    uint8_t check_byte, bytes_got = 0;
-                    int byte_cnt = 0;
-                    fd = open(op.fname, O_RDONLY);
-                    while (1) {
-                        bytes_got = read(fd, &check_byte, 1);
-                        if (bytes_got == 0)
-                            break;
-                        if (check_byte != *buf && matched) {
-                            printf("Memory dump does not match golden answer at byte %d:exp 0x%02x, got 0x%02x, and maybe others too.\n", byte_cnt, *buf, check_byte);
-                            matched = 0;
-                            _test_passed = 0;
-                        }
-                        buf++;
-                        byte_cnt++;
-                    }
-                    close(fd);
-                    if (matched)
+                    // check answer, op.buf still points to its start
+                    dump_check res = check_dump(dump.data(), op.buf, dump.size());
+                    if (res.mismatches) {
+                        printf("Memory dump does not match golden answer: %lu of %lu bytes differ, "
+                               "first at byte %u, last at byte %u.\n",
+                               res.mismatches, dump.size(), res.first, res.last);
+                        _test_passed = 0;
+                    } else {
                         printf("AXI: memory dump matched reference.\n");
+                    }
+
+                    if (dump_files)
+                        DumpWriter::instance().post(op.fname, std::move(dump));
+                    dump = std::vector<uint8_t>();
                 }
             }
         }
@@ -315,6 +495,34 @@ TraceLoaderGem5::axievent(int* waiting_for_gem5_mem) {
         opq.pop();
 }
 
+TraceLoaderGem5::dump_check
+TraceLoaderGem5::check_dump(const uint8_t *got, const uint8_t *exp,
+                            size_t len) {
+    dump_check res = {0, 0, 0};
+    // memcmp is vectorised, only the blocks that differ are looked at
+    // a byte at a time
+    const size_t block = 64;
+    for (size_t base = 0; base < len; base += block) {
+        size_t n = std::min(block, len - base);
+        if (memcmp(got + base, exp + base, n) == 0)
+            continue;
+        for (size_t i = base; i < base + n; i++) {
+            if (got[i] == exp[i])
+                continue;
+            if (!res.mismatches)
+                res.first = i;
+            res.last = i;
+            res.mismatches++;
+        }
+    }
+    return res;
+}
+
+void
+TraceLoaderGem5::flush_dumps() {
+    DumpWriter::instance().flush();
+}
+
 int
 TraceLoaderGem5::test_passed() {
     return _test_passed;
@@ -325,7 +533,89 @@ TraceLoaderGem5::getBaseAddr() {
     return base_addr;
 }
 
-} // namespace gem5
-
+void
+TraceLoaderGem5::serialize(CheckpointOut &cp) const {
+    std::string filename = Serializable::currentSection() + ".bin";
+    std::string filepath = CheckpointIn::dir() + "/" + filename;
+    std::ofstream out(filepath, std::ios::binary);
+    if (trace)
+        out.write(trace, trace_and_rd_log_size);
+    // a dump in progress follows the trace
+    out.write((const char *)dump.data(), dump.size());
+    fatal_if(!out, "Could not write trace to %s\n", filepath);
+    uint64_t dump_size = dump.size();
+    SERIALIZE_SCALAR(dump_size);
+
+    SERIALIZE_SCALAR(filename);
+    SERIALIZE_SCALAR(trace_and_rd_log_size);
+    SERIALIZE_SCALAR(trace_size);
+    SERIALIZE_SCALAR(base_addr);
+    SERIALIZE_SCALAR(_test_passed);
+    SERIALIZE_CONTAINER(index);
+    uint64_t next = next_cmd;
+    paramOut(cp, "next_cmd", next);
+    uint64_t last_cmd = fence;
+    paramOut(cp, "fence", last_cmd);
+
+    // the payloads are kept as offsets into the trace
+    std::queue<axi_op> ops = opq;
+    unsigned num_ops = ops.size();
+    SERIALIZE_SCALAR(num_ops);
+    for (unsigned i = 0; i < num_ops; i++, ops.pop()) {
+        ScopedCheckpointSection sec(cp, csprintf("op%d", i));
+        const axi_op &op = ops.front();
+        paramOut(cp, "opcode", (int)op.opcode);
+        paramOut(cp, "addr", op.addr);
+        paramOut(cp, "len", op.len);
+        paramOut(cp, "buf", (uint64_t)(op.buf - (const uint8_t *)trace));
+        paramOut(cp, "fname", op.fname);
+    }
+}
 
+void
+TraceLoaderGem5::unserialize(CheckpointIn &cp) {
+    std::string filename;
+    UNSERIALIZE_SCALAR(filename);
+    UNSERIALIZE_SCALAR(trace_and_rd_log_size);
+    UNSERIALIZE_SCALAR(trace_size);
+    UNSERIALIZE_SCALAR(base_addr);
+    UNSERIALIZE_SCALAR(_test_passed);
+    UNSERIALIZE_CONTAINER(index);
+    uint64_t next;
+    paramIn(cp, "next_cmd", next);
+    next_cmd = next;
+    uint64_t last_cmd;
+    paramIn(cp, "fence", last_cmd);
+    fence = last_cmd;
+
+    std::string filepath = cp.getCptDir() + "/" + filename;
+    std::ifstream in(filepath, std::ios::binary);
+    restoredTrace.resize(trace_and_rd_log_size);
+    in.read(restoredTrace.data(), trace_and_rd_log_size);
+    uint64_t dump_size;
+    UNSERIALIZE_SCALAR(dump_size);
+    dump.resize(dump_size);
+    in.read((char *)dump.data(), dump_size);
+    fatal_if(!in, "Could not read trace from %s\n", filepath);
+    trace = trace_and_rd_log_size ? restoredTrace.data() : NULL;
+
+    opq = std::queue<axi_op>();
+    unsigned num_ops;
+    UNSERIALIZE_SCALAR(num_ops);
+    for (unsigned i = 0; i < num_ops; i++) {
+        ScopedCheckpointSection sec(cp, csprintf("op%d", i));
+        axi_op op;
+        int opcode;
+        uint64_t buf;
+        paramIn(cp, "opcode", opcode);
+        paramIn(cp, "addr", op.addr);
+        paramIn(cp, "len", op.len);
+        paramIn(cp, "buf", buf);
+        paramIn(cp, "fname", op.fname);
+        op.opcode = (axi_opc)opcode;
+        op.buf = (const uint8_t *)trace + buf;
+        opq.push(op);
+    }
+}
 
+} // namespace gem5
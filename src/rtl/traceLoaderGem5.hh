@@ -11,16 +11,17 @@
 #define __TRACE_LOADER__GEM5__
 
 //#include "accelerator.hh"
-#include <sys/types.h>
-#include <sys/stat.h>
-#include <fcntl.h>
+#include <string>
+#include <vector>
+
 #include "axiResponder.hh"
 #include "csbMaster.hh"
+#include "sim/serialize.hh"
 
 namespace gem5
 {
 
-class TraceLoaderGem5 {
+class TraceLoaderGem5 : public Serializable {
     enum axi_opc {
         AXI_LOADMEM,
         AXI_DUMPMEM
@@ -30,11 +31,32 @@ class TraceLoaderGem5 {
         axi_opc opcode;
         uint32_t addr;
         uint32_t len;
-        const uint8_t *buf;
-        const char *fname;
+        const uint8_t *buf;     // points into the trace
+        std::string fname;
     };
     std::queue<axi_op> opq;
 
+    // The trace is decoded lazily: load() only records where every
+    // command starts, and feed() hands them to the CSB master as it
+    // consumes them. Payloads are never copied, the trace buffer has
+    // to outlive the replay.
+    const char *trace;
+    std::vector<uint32_t> index;
+    size_t next_cmd;
+    // feed() does not go past this command
+    size_t fence;
+
+    // copy of the trace read back from a checkpoint, the original
+    // buffer is gone by then
+    std::vector<char> restoredTrace;
+
+    // data of the AXI_DUMPMEM at the front of opq received so far
+    std::vector<uint8_t> dump;
+    // also write the dumps to the files named in the trace
+    bool dump_files;
+
+    void decode(size_t i);
+
     CSBMaster *csb;
     AXIResponder *axi_dbb, *axi_cvsram;
 
@@ -59,14 +81,76 @@ public:
     void read_local(int &last, const char *buffer_trace,
                     void *buffer, unsigned int nbytes);
 
+    // commands kept queued in the CSB master
+    static const size_t feed_window = 64;
+
     void load(const char *fname) ;
     void load_read_var_log(const char* fname);
 
+    // decode commands until the CSB master has feed_window queued
+    void feed();
+
+    // all the commands have been handed to the CSB master
+    bool done() { return next_cmd == index.size(); }
+
+    // A command of the trace as stored in it. Payloads point into
+    // the trace.
+    struct trace_cmd {
+        unsigned char opcode;
+        uint32_t addr;
+        uint32_t data;
+        uint32_t mask;
+        uint32_t len;
+        const uint8_t *buf;
+        std::string fname;
+    };
+
+    // parse command i, nothing is handed to the CSB master
+    void parse(size_t i, trace_cmd &cmd) const;
+
+    size_t num_cmds() const { return index.size(); }
+    unsigned char opcode(size_t i) const { return trace[index[i]]; }
+
+    // Find where the layer starting at command first ends: after the
+    // wait for its interrupt, the status reads that follow and the
+    // writes that clear them. sig gets a hash of its commands.
+    size_t layer_end(size_t first, uint64_t &sig) const;
+    size_t position() const { return next_cmd; }
+
+    // Take the next command for a model that runs the trace by itself
+    // instead of the CSB master (see tlmNVDLA).
+    void pop(trace_cmd &cmd) { parse(next_cmd++, cmd); }
+
+    // stop feeding the CSB master at command i, to hand the rest of
+    // the trace to another model
+    void set_fence(size_t i) { fence = i; }
+
     void axievent(int* waiting_for_gem5_mem);
 
     int test_passed();
 
+    // write the AXI_DUMPMEM data to disk too, from a background thread
+    void set_dump_files(bool enable) { dump_files = enable; }
+
+    // wait until the dumps handed to the background thread are written
+    static void flush_dumps();
+
+    // Bytes of a dump that differ from its golden answer. The trace does
+    // not say the data type of a dump, so no error magnitude is given.
+    struct dump_check {
+        uint64_t mismatches;
+        uint32_t first;
+        uint32_t last;
+    };
+
+    static dump_check check_dump(const uint8_t *got, const uint8_t *exp,
+                                 size_t len);
+
     uint32_t getBaseAddr();
+
+    // the trace buffer goes to its own file next to the checkpoint
+    void serialize(CheckpointOut &cp) const override;
+    void unserialize(CheckpointIn &cp) override;
 };
 
 } // namespace gem5
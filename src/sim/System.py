@@ -93,6 +93,11 @@ class System(SimObject):
         "use to directly address the backstore from another host-OS process. "
         "Leave this empty to unset the MAP_SHARED flag.")
 
+    # The backing stores are checkpointed in chunks compressed and
+    # restored by a pool of host threads
+    checkpoint_threads = Param.Unsigned(0, "Host threads used to save "
+        "and restore the memory, 0 for one per host core")
+
     cache_line_size = Param.Unsigned(64, "Cache line size in bytes")
 
     byte_order = Param.ByteOrder(default_byte_order,
@@ -0,0 +1,237 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include "sim/calendar_queue.hh"
+
+#include <algorithm>
+#include <cassert>
+
+#include "base/logging.hh"
+#include "sim/eventq.hh"
+
+namespace gem5
+{
+
+CalendarQueue::CalendarQueue() :
+    buckets(MinBuckets, nullptr),
+    shift(9),
+    numBins(0),
+    minBin(nullptr),
+    resizes(0)
+{
+}
+
+void
+CalendarQueue::insertBin(Event *top)
+{
+    Event **link = &buckets[bucket(top->when())];
+    while (*link && **link < *top)
+        link = &(*link)->nextBin;
+
+    top->nextBin = *link;
+    *link = top;
+}
+
+void
+CalendarQueue::insert(Event *event)
+{
+    Event **link = &buckets[bucket(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    Event *curr = *link;
+    if (!curr || *event < *curr)
+        numBins++;
+
+    // same as the list, a new bin or the new top of curr
+    *link = Event::insertBefore(event, curr);
+
+    if (!minBin || *event <= *minBin)
+        minBin = event;
+
+    if (numBins > 2 * buckets.size()) {
+        std::vector<Event *> tops = collect();
+        rebuild(tops, 2 * buckets.size());
+    }
+}
+
+void
+CalendarQueue::remove(Event *event)
+{
+    Event **link = &buckets[bucket(event->when())];
+    while (*link && **link < *event)
+        link = &(*link)->nextBin;
+
+    Event *top = *link;
+    if (!top || *top != *event)
+        panic("event not found!");
+
+    bool last = event == top && !top->nextInBin;
+    bool was_min = top == minBin;
+    *link = Event::removeItem(event, top);
+
+    if (!last) {
+        if (was_min)
+            minBin = *link;
+        return;
+    }
+
+    numBins--;
+    if (was_min)
+        minBin = findMin(event->when());
+
+    if (numBins < buckets.size() / 2 && buckets.size() > MinBuckets) {
+        std::vector<Event *> tops = collect();
+        rebuild(tops, buckets.size() / 2);
+    }
+}
+
+Event *
+CalendarQueue::findMin(Tick from) const
+{
+    if (numBins == 0)
+        return nullptr;
+
+    // Walk the buckets from the one of from, a bin is the next one if
+    // it falls in the stretch of ticks the bucket covers at this turn
+    Tick turn = from >> shift;
+    const size_t mask = buckets.size() - 1;
+    for (size_t i = 0; i < buckets.size(); i++, turn++) {
+        Event *top = buckets[turn & mask];
+        if (top && (top->when() >> shift) == turn)
+            return top;
+    }
+
+    // All the bins are more than a full turn away
+    Event *min = nullptr;
+    for (auto top : buckets) {
+        if (top && (!min || *top < *min))
+            min = top;
+    }
+    return min;
+}
+
+std::vector<Event *>
+CalendarQueue::collect() const
+{
+    std::vector<Event *> tops;
+    tops.reserve(numBins);
+    for (auto top : buckets) {
+        for (; top; top = top->nextBin)
+            tops.push_back(top);
+    }
+    return tops;
+}
+
+void
+CalendarQueue::rebuild(std::vector<Event *> &tops, size_t num_buckets)
+{
+    // Average distance between the earliest ticks with events, leaving
+    // out the gaps more than twice as big, as they would stretch the
+    // buckets for the bins we are going to service next
+    const size_t samples = std::min<size_t>(tops.size(), 32);
+    std::partial_sort(tops.begin(), tops.begin() + samples, tops.end(),
+                      [](const Event *l, const Event *r) { return *l < *r; });
+
+    Tick total = 0;
+    unsigned gaps = 0;
+    for (size_t i = 1; i < samples; i++) {
+        Tick gap = tops[i]->when() - tops[i - 1]->when();
+        if (gap) {
+            total += gap;
+            gaps++;
+        }
+    }
+
+    if (gaps) {
+        Tick avg = total / gaps;
+        Tick kept_total = 0;
+        unsigned kept = 0;
+        for (size_t i = 1; i < samples; i++) {
+            Tick gap = tops[i]->when() - tops[i - 1]->when();
+            if (gap && gap <= 2 * avg) {
+                kept_total += gap;
+                kept++;
+            }
+        }
+
+        Tick width = 3 * (kept_total / kept);
+        shift = 0;
+        while (shift < 63 && ((Tick)1 << shift) < width)
+            shift++;
+    }
+
+    buckets.assign(num_buckets, nullptr);
+    for (auto top : tops)
+        insertBin(top);
+
+    resizes++;
+}
+
+std::vector<Event *>
+CalendarQueue::bins() const
+{
+    std::vector<Event *> tops = collect();
+    std::sort(tops.begin(), tops.end(),
+              [](const Event *l, const Event *r) { return *l < *r; });
+    return tops;
+}
+
+Event *
+CalendarQueue::release()
+{
+    std::vector<Event *> tops = bins();
+    for (size_t i = 0; i < tops.size(); i++)
+        tops[i]->nextBin = i + 1 < tops.size() ? tops[i + 1] : nullptr;
+
+    std::fill(buckets.begin(), buckets.end(), nullptr);
+    numBins = 0;
+    minBin = nullptr;
+
+    return tops.empty() ? nullptr : tops.front();
+}
+
+void
+CalendarQueue::adopt(Event *list)
+{
+    assert(numBins == 0);
+
+    std::vector<Event *> tops;
+    for (Event *top = list; top; top = top->nextBin)
+        tops.push_back(top);
+
+    size_t num_buckets = MinBuckets;
+    while (num_buckets < tops.size())
+        num_buckets *= 2;
+
+    numBins = tops.size();
+    rebuild(tops, num_buckets);
+    minBin = list;
+}
+
+} // namespace gem5
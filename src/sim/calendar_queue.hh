@@ -0,0 +1,129 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#ifndef __SIM_CALENDAR_QUEUE_HH__
+#define __SIM_CALENDAR_QUEUE_HH__
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "base/types.hh"
+
+namespace gem5
+{
+
+class Event;
+
+/**
+ * Calendar queue (R. Brown, CACM 1988) of event bins, used by
+ * EventQueue as an alternative to its sorted list of bins.
+ *
+ * A bin is the stack of events sharing when and priority, linked
+ * through nextInBin as in the list, and is referred to by its top
+ * event. Bins are hashed by when into buckets that each cover 2^shift
+ * ticks, one bucket after the other, wrapping around every
+ * buckets.size() << shift ticks. The bins of a bucket are kept sorted
+ * in a list linked through nextBin. With the width adjusted to the
+ * distance between bins, and the number of buckets to the number of
+ * bins, buckets hold one or two bins and inserting, removing and
+ * finding the next bin take constant amortised time.
+ */
+class CalendarQueue
+{
+  private:
+    /// Sorted list of the bins of each bucket
+    std::vector<Event *> buckets;
+
+    /// Ticks covered by a bucket, log2
+    unsigned shift;
+
+    /// Number of bins
+    size_t numBins;
+
+    /// Top event of the earliest bin
+    Event *minBin;
+
+    size_t
+    bucket(Tick when) const
+    {
+        return (when >> shift) & (buckets.size() - 1);
+    }
+
+    /// Insert a whole bin, its top event is not in the calendar yet
+    void insertBin(Event *top);
+
+    /// Earliest bin, knowing no bin comes before from
+    Event *findMin(Tick from) const;
+
+    /// Top events of all the bins, in no particular order
+    std::vector<Event *> collect() const;
+
+    /**
+     * Spread the bins in tops over num_buckets buckets, with a width
+     * of about three times the distance between the earliest bins.
+     */
+    void rebuild(std::vector<Event *> &tops, size_t num_buckets);
+
+  public:
+    static const size_t MinBuckets = 16;
+
+    CalendarQueue();
+
+    /// Top event of the earliest bin, nullptr when empty
+    Event *front() const { return minBin; }
+
+    size_t size() const { return numBins; }
+    size_t numBuckets() const { return buckets.size(); }
+    Tick bucketWidth() const { return (Tick)1 << shift; }
+
+    /// Push an event on its bin, creating the bin if needed
+    void insert(Event *event);
+
+    /// Take a scheduled event out of its bin
+    void remove(Event *event);
+
+    /// Top event of every bin, in order
+    std::vector<Event *> bins() const;
+
+    /**
+     * Empty the calendar, handing the bins out as the sorted list used
+     * by EventQueue. Returns the first bin.
+     */
+    Event *release();
+
+    /// Take the bins of a sorted list, the calendar must be empty
+    void adopt(Event *list);
+
+    /// Number of times the buckets were redistributed
+    uint64_t resizes;
+};
+
+} // namespace gem5
+
+#endif // __SIM_CALENDAR_QUEUE_HH__
@@ -41,6 +41,7 @@
 #include "base/trace.hh"
 #include "cpu/smt.hh"
 #include "debug/Checkpoint.hh"
+#include "sim/calendar_queue.hh"
 
 namespace gem5
 {
@@ -57,6 +58,7 @@ uint32_t numMainEventQueues = 0;
 std::vector<EventQueue *> mainEventQueue;
 __thread EventQueue *_curEventQueue = NULL;
 bool inParallelMode = false;
+bool calendarEventQueues = false;
 
 EventQueue *
 getEventQueue(uint32_t index)
@@ -70,6 +72,14 @@ getEventQueue(uint32_t index)
     return mainEventQueue[index];
 }
 
+void
+setCalendarEventQueues(bool enable)
+{
+    calendarEventQueues = enable;
+    for (auto eq : mainEventQueue)
+        eq->useCalendar(enable);
+}
+
 #ifndef NDEBUG
 Counter Event::instanceCounter = 0;
 #endif
@@ -111,6 +121,12 @@ Event::insertBefore(Event *event, Event *curr)
 void
 EventQueue::insert(Event *event)
 {
+    if (calendar) {
+        calendar->insert(event);
+        head = calendar->front();
+        return;
+    }
+
     // Deal with the head case
     if (!head || *event <= *head) {
         head = Event::insertBefore(event, head);
@@ -170,6 +186,12 @@ EventQueue::remove(Event *event)
 
     assert(event->queue == this);
 
+    if (calendar) {
+        calendar->remove(event);
+        head = calendar->front();
+        return;
+    }
+
     // deal with an event on the head's 'in bin' list (event has the same
     // time as the head)
     if (*head == *event) {
@@ -202,7 +224,10 @@ EventQueue::serviceOne()
     Event *next = head->nextInBin;
     event->flags.clear(Event::Scheduled);
 
-    if (next) {
+    if (calendar) {
+        calendar->remove(event);
+        head = calendar->front();
+    } else if (next) {
         // update the next bin pointer since it could be stale
         next->nextBin = head->nextBin;
 
@@ -295,15 +320,12 @@ EventQueue::dump() const
     if (empty())
         cprintf("<No Events>\n");
     else {
-        Event *nextBin = head;
-        while (nextBin) {
+        for (Event *nextBin : bins()) {
             Event *nextInBin = nextBin;
             while (nextInBin) {
                 nextInBin->dump();
                 nextInBin = nextInBin->nextInBin;
             }
-
-            nextBin = nextBin->nextBin;
         }
     }
 
@@ -318,8 +340,7 @@ EventQueue::debugVerify() const
     Tick time = 0;
     short priority = 0;
 
-    Event *nextBin = head;
-    while (nextBin) {
+    for (Event *nextBin : bins()) {
         Event *nextInBin = nextBin;
         while (nextInBin) {
             if (nextInBin->when() < time) {
@@ -345,16 +366,50 @@ EventQueue::debugVerify() const
 
             nextInBin = nextInBin->nextInBin;
         }
-
-        nextBin = nextBin->nextBin;
     }
 
     return true;
 }
 
+std::vector<Event *>
+EventQueue::bins() const
+{
+    if (calendar)
+        return calendar->bins();
+
+    std::vector<Event *> tops;
+    for (Event *nextBin = head; nextBin; nextBin = nextBin->nextBin)
+        tops.push_back(nextBin);
+    return tops;
+}
+
+void
+EventQueue::useCalendar(bool enable)
+{
+    if (enable == (calendar != nullptr))
+        return;
+
+    if (enable) {
+        calendar = new CalendarQueue;
+        calendar->adopt(head);
+    } else {
+        head = calendar->release();
+        delete calendar;
+        calendar = nullptr;
+    }
+}
+
 Event*
 EventQueue::replaceHead(Event* s)
 {
+    if (calendar) {
+        // swap the whole calendar, handing out the bins as a list
+        Event *t = calendar->release();
+        calendar->adopt(s);
+        head = calendar->front();
+        return t;
+    }
+
     Event* t = head;
     head = s;
     return t;
@@ -416,8 +471,17 @@ Event::dump() const
 }
 
 EventQueue::EventQueue(const std::string &n)
-    : objName(n), head(NULL), _curTick(0)
+    : objName(n), head(NULL), _curTick(0), calendar(nullptr)
 {
+    useCalendar(calendarEventQueues);
+}
+
+EventQueue::~EventQueue()
+{
+    while (!empty())
+        deschedule(getHead());
+
+    delete calendar;
 }
 
 void
@@ -440,6 +504,9 @@ EventQueue::handleAsyncInsertions()
     }
 
     async_queue_mutex.unlock();
+
+    for (auto &handler : quantumHandlers)
+        handler();
 }
 
 } // namespace gem5
@@ -43,6 +43,7 @@
 #include <list>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "base/debug.hh"
 #include "base/flags.hh"
@@ -57,6 +58,7 @@ namespace gem5
 
 class EventQueue;       // forward declaration
 class BaseGlobalEvent;
+class CalendarQueue;
 
 //! Simulation Quantum for multiple eventq simulation.
 //! The quantum value is the period length after which the queues
@@ -79,6 +81,13 @@ extern __thread EventQueue *_curEventQueue;
 //! Current mode of execution: parallel / serial
 extern bool inParallelMode;
 
+//! Whether new event queues keep their bins in a calendar queue
+extern bool calendarEventQueues;
+
+//! Switch every main event queue, and the ones created later, to the
+//! calendar queue or back to the sorted list of bins
+void setCalendarEventQueues(bool enable);
+
 //! Function for returning eventq queue for the provided
 //! index. The function allocates a new queue in case one
 //! does not exist for the index, provided that the index
@@ -251,6 +260,7 @@ class EventBase
 class Event : public EventBase, public Serializable
 {
     friend class EventQueue;
+    friend class CalendarQueue;
 
   private:
     // The event queue is now a linked list of linked lists.  The
@@ -628,12 +638,22 @@ class EventQueue
     Event *head;
     Tick _curTick;
 
+    /**
+     * Calendar of bins, nullptr when they are kept in the sorted list
+     * starting at head. With the calendar head is a cached copy of
+     * its front.
+     */
+    CalendarQueue *calendar;
+
     //! Mutex to protect async queue.
     UncontendedMutex async_queue_mutex;
 
     //! List of events added by other threads to this event queue.
     std::list<Event*> async_queue;
 
+    //! Functions called after the async queue has been merged.
+    std::vector<std::function<void()>> quantumHandlers;
+
     /**
      * Lock protecting event handling.
      *
@@ -661,6 +681,9 @@ class EventQueue
     void insert(Event *event);
     void remove(Event *event);
 
+    //! Top event of every bin, in order
+    std::vector<Event *> bins() const;
+
     //! Function for adding events to the async queue. The added events
     //! are added to main event queue later. Threads, other than the
     //! owning thread, should call this function instead of insert().
@@ -907,11 +930,32 @@ class EventQueue
 
     bool debugVerify() const;
 
+    /**
+     * Keep the bins in a calendar queue, which inserts and removes in
+     * constant amortised time, instead of the sorted list, which is
+     * linear in the number of bins. Events run in the same order with
+     * both. Can be switched with events already scheduled.
+     */
+    void useCalendar(bool enable);
+    bool usingCalendar() const { return calendar != nullptr; }
+
     /**
      * Function for moving events from the async_queue to the main queue.
      */
     void handleAsyncInsertions();
 
+    /**
+     * Register a function to be called from this queue's thread every
+     * time handleAsyncInsertions() runs, i.e. once per simulation
+     * quantum when running in parallel. Objects split across queues
+     * use it to pick up the messages the other side posted during the
+     * previous quantum. Must be called before the simulation starts.
+     */
+    void addQuantumHandler(const std::function<void()> &handler)
+    {
+        quantumHandlers.push_back(handler);
+    }
+
     /**
      *  Function to signal that the event loop should be woken up because
      *  an event has been scheduled by an agent outside the gem5 event
@@ -968,11 +1012,7 @@ class EventQueue
      */
     void checkpointReschedule(Event *event);
 
-    virtual ~EventQueue()
-    {
-        while (!empty())
-            deschedule(getHead());
-    }
+    virtual ~EventQueue();
 };
 
 inline void
@@ -0,0 +1,403 @@
+/*
+ * Copyright (c) 2026 agent
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are
+ * met: redistributions of source code must retain the above copyright
+ * notice, this list of conditions and the following disclaimer;
+ * redistributions in binary form must reproduce the above copyright
+ * notice, this list of conditions and the following disclaimer in the
+ * documentation and/or other materials provided with the distribution;
+ * neither the name of the copyright holders nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS
+ * "AS IS" AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT
+ * LIMITED TO, THE IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR
+ * A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT
+ * OWNER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL,
+ * SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT
+ * LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE,
+ * DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY
+ * THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT
+ * (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <regex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "sim/calendar_queue.hh"
+#include "sim/eventq.hh"
+
+using namespace gem5;
+
+namespace
+{
+
+/** Event writing its id to a log when it runs. */
+class LogEvent : public Event
+{
+  public:
+    LogEvent(int _id, std::vector<int> &_log, Priority p = Default_Pri)
+        : Event(p), id(_id), log(_log)
+    {}
+
+    void process() override { log.push_back(id); }
+    const char *description() const override { return "log"; }
+
+    const int id;
+    std::vector<int> &log;
+};
+
+/** The same events on a list queue and on a calendar queue. */
+struct QueuePair
+{
+    static const int NumEvents = 512;
+
+    std::vector<int> log[2];
+    std::vector<std::unique_ptr<LogEvent>> events[2];
+    EventQueue eq[2] = {EventQueue("list"), EventQueue("calendar")};
+
+    QueuePair()
+    {
+        eq[1].useCalendar(true);
+        for (int q = 0; q < 2; q++) {
+            for (int i = 0; i < NumEvents; i++) {
+                // a few priorities so that bins share ticks
+                Event::Priority pri = (i % 7) - 3;
+                events[q].emplace_back(new LogEvent(i, log[q], pri));
+            }
+        }
+    }
+
+    ~QueuePair()
+    {
+        for (int q = 0; q < 2; q++) {
+            while (!eq[q].empty())
+                eq[q].deschedule(eq[q].getHead());
+        }
+    }
+
+    void
+    schedule(int i, Tick when)
+    {
+        for (int q = 0; q < 2; q++)
+            eq[q].schedule(events[q][i].get(), when);
+    }
+
+    void
+    deschedule(int i)
+    {
+        for (int q = 0; q < 2; q++)
+            eq[q].deschedule(events[q][i].get());
+    }
+
+    void
+    reschedule(int i, Tick when)
+    {
+        for (int q = 0; q < 2; q++)
+            eq[q].reschedule(events[q][i].get(), when, true);
+    }
+
+    void
+    serviceOne()
+    {
+        for (int q = 0; q < 2; q++)
+            eq[q].serviceOne();
+    }
+};
+
+} // anonymous namespace
+
+/** Events in the same bin run last in, first out, as with the list. */
+TEST(EventQueueTest, CalendarBinOrder)
+{
+    QueuePair qp;
+
+    // 0, 7, 14 share priority, 1 and 8 another one
+    qp.schedule(0, 1000);
+    qp.schedule(7, 1000);
+    qp.schedule(1, 1000);
+    qp.schedule(14, 1000);
+    qp.schedule(8, 1000);
+    qp.schedule(2, 500);
+    qp.deschedule(7);
+
+    while (!qp.eq[0].empty())
+        qp.serviceOne();
+
+    ASSERT_TRUE(qp.eq[1].empty());
+    std::vector<int> expected = {2, 14, 0, 8, 1};
+    ASSERT_EQ(qp.log[0], expected);
+    ASSERT_EQ(qp.log[1], expected);
+}
+
+/** Random schedule, deschedule and reschedule mixes run the same. */
+TEST(EventQueueTest, CalendarSameOrderAsList)
+{
+    QueuePair qp;
+    std::mt19937_64 rng(1234);
+
+    for (int step = 0; step < 200000; step++) {
+        int i = rng() % QueuePair::NumEvents;
+        Tick now = qp.eq[0].getCurTick();
+        ASSERT_EQ(now, qp.eq[1].getCurTick());
+
+        // mostly close to now on clock edges, some far away
+        Tick delta = (rng() % 16) * 250;
+        if (rng() % 64 == 0)
+            delta = rng() % 100000000;
+        if (rng() % 1024 == 0)
+            delta = 1000000000000ULL;
+
+        bool scheduled = qp.events[0][i]->scheduled();
+        ASSERT_EQ(scheduled, qp.events[1][i]->scheduled());
+        switch (rng() % 4) {
+          case 0:
+            if (scheduled)
+                qp.deschedule(i);
+            else
+                qp.schedule(i, now + delta);
+            break;
+          case 1:
+            qp.reschedule(i, now + delta);
+            break;
+          default:
+            if (!qp.eq[0].empty())
+                qp.serviceOne();
+            break;
+        }
+
+        ASSERT_EQ(qp.eq[0].empty(), qp.eq[1].empty());
+        if (!qp.eq[0].empty()) {
+            ASSERT_EQ(qp.eq[0].getHead()->when(),
+                      qp.eq[1].getHead()->when());
+            ASSERT_EQ(static_cast<LogEvent *>(qp.eq[0].getHead())->id,
+                      static_cast<LogEvent *>(qp.eq[1].getHead())->id);
+        }
+        if (step % 10000 == 0) {
+            ASSERT_TRUE(qp.eq[1].debugVerify());
+        }
+    }
+
+    while (!qp.eq[0].empty())
+        qp.serviceOne();
+
+    ASSERT_EQ(qp.log[0], qp.log[1]);
+}
+
+/** Switching backends and swapping the head keep the scheduled events. */
+TEST(EventQueueTest, CalendarSwitchAndReplaceHead)
+{
+    QueuePair qp;
+
+    for (int i = 0; i < 64; i++)
+        qp.schedule(i, 1000 + (i % 5) * 500);
+
+    // back and forth with events in the queues
+    qp.eq[1].useCalendar(false);
+    qp.eq[0].useCalendar(true);
+    ASSERT_TRUE(qp.eq[0].debugVerify());
+    ASSERT_TRUE(qp.eq[1].debugVerify());
+
+    // run something else meanwhile, as the Ruby cache warm-up does
+    Event *saved[2];
+    for (int q = 0; q < 2; q++)
+        saved[q] = qp.eq[q].replaceHead(nullptr);
+    ASSERT_TRUE(qp.eq[0].empty());
+    qp.schedule(100, 1200);
+    qp.serviceOne();
+    for (int q = 0; q < 2; q++)
+        qp.eq[q].replaceHead(saved[q]);
+
+    while (!qp.eq[0].empty())
+        qp.serviceOne();
+
+    ASSERT_TRUE(qp.eq[1].empty());
+    ASSERT_EQ(qp.log[0].size(), 65);
+    ASSERT_EQ(qp.log[0], qp.log[1]);
+}
+
+/**
+ * Event queue benchmark. Replays the schedule, deschedule, reschedule
+ * and executed operations of a recorded run (set EVENTQ_TRACE to the
+ * output of --debug-flags=Event) on both backends. Without a trace, a
+ * system of clocked objects is simulated instead: thousands of
+ * components ticking at a few clock periods, some of them going to
+ * sleep and waking up, as caches, routers and NVDLA ticks do.
+ */
+namespace
+{
+
+struct TraceOp
+{
+    enum Kind { Schedule, Deschedule, Reschedule, Execute } kind;
+    unsigned event;
+    Tick when;
+};
+
+class ReplayEvent : public Event
+{
+  public:
+    void process() override {}
+};
+
+std::vector<TraceOp>
+loadTrace(const char *path, unsigned &num_events)
+{
+    static const std::regex line_re(
+        "^\\s*\\d+: .* (\\S+) (scheduled|descheduled|rescheduled|executed)"
+        " @ (\\d+)\\s*$");
+
+    std::vector<TraceOp> ops;
+    std::unordered_map<std::string, unsigned> ids;
+    std::ifstream in(path);
+    std::string line;
+    std::smatch m;
+    while (std::getline(in, line)) {
+        if (!std::regex_match(line, m, line_re))
+            continue;
+
+        auto it = ids.emplace(m[1].str(), ids.size()).first;
+        const std::string action = m[2].str();
+        TraceOp::Kind kind = action == "scheduled" ? TraceOp::Schedule :
+            action == "descheduled" ? TraceOp::Deschedule :
+            action == "rescheduled" ? TraceOp::Reschedule : TraceOp::Execute;
+        ops.push_back({kind, it->second, std::stoull(m[3].str())});
+    }
+
+    num_events = ids.size();
+    return ops;
+}
+
+/**
+ * Apply the trace, the queue tracks curTick through the executed
+ * events. Returns how many executed events were not the head of the
+ * queue, the trace has no priorities so same tick events may come in
+ * a different order.
+ */
+uint64_t
+replay(EventQueue &eq, const std::vector<TraceOp> &ops, unsigned num_events)
+{
+    std::vector<ReplayEvent> events(num_events);
+    uint64_t mismatches = 0;
+
+    for (const auto &op : ops) {
+        Event *event = &events[op.event];
+        switch (op.kind) {
+          case TraceOp::Schedule:
+            if (!event->scheduled() && op.when >= eq.getCurTick())
+                eq.schedule(event, op.when);
+            break;
+          case TraceOp::Deschedule:
+            if (event->scheduled())
+                eq.deschedule(event);
+            break;
+          case TraceOp::Reschedule:
+            if (op.when >= eq.getCurTick())
+                eq.reschedule(event, op.when, true);
+            break;
+          case TraceOp::Execute:
+            if (!event->scheduled())
+                break;
+            if (eq.getHead() == event) {
+                eq.serviceOne();
+            } else {
+                mismatches++;
+                eq.deschedule(event);
+            }
+            break;
+        }
+    }
+
+    while (!eq.empty())
+        eq.deschedule(eq.getHead());
+
+    return mismatches;
+}
+
+/** Clocked objects that tick every cycle while awake. */
+uint64_t
+runClocked(EventQueue &eq, unsigned num_objects, Tick end, uint64_t &hash)
+{
+    static const Tick periods[] = {250, 333, 500, 1000, 1250};
+    std::mt19937 rng(42);
+    std::vector<std::unique_ptr<EventFunctionWrapper>> events;
+    uint64_t serviced = 0;
+
+    for (unsigned i = 0; i < num_objects; i++) {
+        Tick period = periods[i % 5];
+        events.emplace_back(new EventFunctionWrapper(
+            [&, i, period]() {
+                serviced++;
+                hash = hash * 1000003 + i;
+                Tick next = eq.getCurTick() + period;
+                // now and then an object has nothing to do for a while
+                if (rng() % 32 == 0)
+                    next += period * (rng() % 200);
+                if (next < end)
+                    eq.schedule(events[i].get(), next);
+            }, "clocked", false, (Event::Priority)(i % 3)));
+        eq.schedule(events.back().get(), period);
+    }
+
+    while (!eq.empty())
+        eq.serviceOne();
+
+    return serviced;
+}
+
+} // anonymous namespace
+
+// Takes a while, run it with --gtest_also_run_disabled_tests
+TEST(EventQueueTest, DISABLED_CalendarBenchmark)
+{
+    const char *trace = std::getenv("EVENTQ_TRACE");
+    double secs[2];
+    uint64_t count[2];
+    uint64_t check[2];
+
+    std::vector<TraceOp> ops;
+    unsigned num_events = 0;
+    if (trace)
+        ops = loadTrace(trace, num_events);
+
+    for (int q = 0; q < 2; q++) {
+        EventQueue eq(q ? "calendar" : "list");
+        eq.useCalendar(q);
+
+        auto start = std::chrono::steady_clock::now();
+        if (!ops.empty()) {
+            check[q] = replay(eq, ops, num_events);
+            count[q] = ops.size();
+        } else {
+            check[q] = 0;
+            count[q] = runClocked(eq, 4000, 1000000, check[q]);
+        }
+        auto stop = std::chrono::steady_clock::now();
+        secs[q] = std::chrono::duration<double>(stop - start).count();
+    }
+
+    std::cout << (ops.empty() ? "clocked objects: " : "trace replay: ")
+              << count[0] << (ops.empty() ? " events" : " operations")
+              << ", list " << count[0] / secs[0] << "/s"
+              << ", calendar " << count[1] / secs[1] << "/s"
+              << ", speedup " << secs[0] / secs[1] << std::endl;
+
+    // same events in the same order, or the same mismatches
+    ASSERT_EQ(count[0], count[1]);
+    ASSERT_EQ(check[0], check[1]);
+}
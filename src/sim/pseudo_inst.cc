@@ -630,7 +630,7 @@ waitaccel(ThreadContext *tc, Addr addr, uint64_t elements)
     DPRINTF(PseudoInst,
             "PseudoInst::waitaccel(%#x, %d)\n", addr, elements);
 
-    return tc->getCpuPtr()->waitAccel(addr,elements);
+    return tc->getCpuPtr()->waitAccel(tc, addr, elements);
 
 
 }
@@ -646,7 +646,7 @@ waitaccelid(ThreadContext *tc, int accel_id)
     DPRINTF(PseudoInst,
             "PseudoInst::waitaccelid(%d)\n", accel_id);
 
-    return tc->getCpuPtr()->waitAccelID(accel_id);
+    return tc->getCpuPtr()->waitAccelID(tc, accel_id);
 }
 
 } // namespace pseudo_inst
@@ -204,7 +204,7 @@ System::System(const Params &p)
       kvmVM(p.kvm_vm),
 #endif
       physmem(name() + ".physmem", p.memories, p.mmap_using_noreserve,
-              p.shared_backstore),
+              p.shared_backstore, p.checkpoint_threads),
       ShadowRomRanges(p.shadow_rom_ranges.begin(),
                       p.shadow_rom_ranges.end()),
       memoryMode(p.mem_mode),